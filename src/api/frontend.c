@@ -39,7 +39,9 @@
 #include "main/cheat.h"
 #include "main/eventloop.h"
 #include "main/main.h"
+#include "main/movie.h"
 #include "main/rom.h"
+#include "main/rom_cache.h"
 #include "main/savestates.h"
 #include "main/util.h"
 #include "main/version.h"
@@ -119,6 +121,7 @@ EXPORT m64p_error CALL CoreShutdown(void)
 
     /* close down some core sub-systems */
     romdatabase_close();
+    rom_cache_close();
     ConfigShutdown();
     workqueue_shutdown();
     savestates_deinit();
@@ -190,10 +193,24 @@ EXPORT m64p_error CALL CoreDoCommand(m64p_command Command, int ParamInt, void *P
                 cheat_init(&g_cheat_ctx);
             }
             return rval;
+        case M64CMD_ROM_OPEN_FILE:
+            if (g_EmulatorRunning || l_DiskOpen || l_ROMOpen)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            rval = open_rom_file((const char *) ParamPtr);
+            if (rval == M64ERR_SUCCESS)
+            {
+                l_ROMOpen = 1;
+                ScreenshotRomOpen();
+                cheat_init(&g_cheat_ctx);
+            }
+            return rval;
         case M64CMD_ROM_CLOSE:
             if (g_EmulatorRunning || !l_ROMOpen)
                 return M64ERR_INVALID_STATE;
             l_ROMOpen = 0;
+            movie_disarm();
             cheat_delete_all(&g_cheat_ctx);
             cheat_uninit(&g_cheat_ctx);
             return close_rom();
@@ -292,7 +309,7 @@ EXPORT m64p_error CALL CoreDoCommand(m64p_command Command, int ParamInt, void *P
         case M64CMD_STATE_SAVE:
             if (!g_EmulatorRunning)
                 return M64ERR_INVALID_STATE;
-            if (ParamPtr != NULL && (ParamInt < 1 || ParamInt > 3))
+            if (ParamPtr != NULL && (ParamInt < 1 || ParamInt > 4))
                 return M64ERR_INPUT_INVALID;
             main_state_save(ParamInt, (char *) ParamPtr);
             return M64ERR_SUCCESS;
@@ -370,6 +387,133 @@ EXPORT m64p_error CALL CoreDoCommand(m64p_command Command, int ParamInt, void *P
                 return M64ERR_INCOMPATIBLE;
         case M64CMD_NETPLAY_CLOSE:
             return netplay_stop();
+        case M64CMD_GET_RDRAM_DIRTY_PAGES:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt < (int) sizeof(uint32_t))
+                return M64ERR_INPUT_INVALID;
+            return main_get_rdram_dirty_pages((uint32_t*) ParamPtr, ParamInt);
+        case M64CMD_GET_AUDIO_RING_STATS:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt != (int) sizeof(m64p_audio_ring_stats))
+                return M64ERR_INPUT_INVALID;
+            return main_get_audio_ring_stats((m64p_audio_ring_stats*) ParamPtr);
+        case M64CMD_GET_FRAME_PACING_STATS:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt != (int) sizeof(m64p_frame_pacing_stats))
+                return M64ERR_INPUT_INVALID;
+            return main_get_frame_pacing_stats((m64p_frame_pacing_stats*) ParamPtr);
+        case M64CMD_GET_HOUSEKEEPING_STATS:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt < (int) sizeof(m64p_housekeeping_stats))
+                return M64ERR_INPUT_INVALID;
+            return main_get_housekeeping_stats((m64p_housekeeping_stats*) ParamPtr, ParamInt);
+        case M64CMD_REWIND_STEP:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamInt < 1)
+                return M64ERR_INPUT_INVALID;
+            return main_rewind_step(ParamInt);
+        case M64CMD_GET_REWIND_STATS:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt != (int) sizeof(m64p_rewind_stats))
+                return M64ERR_INPUT_INVALID;
+            return main_get_rewind_stats((m64p_rewind_stats*) ParamPtr);
+        case M64CMD_FORK_SNAPSHOT:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            return main_fork_snapshot(*(m64p_fork_callback*)&ParamPtr);
+        case M64CMD_FORK_INSTANCE:
+            if (g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            return main_fork_instance((int*) ParamPtr);
+        case M64CMD_GET_RUN_STATS:
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt != (int) sizeof(m64p_run_stats))
+                return M64ERR_INPUT_INVALID;
+            return main_get_run_stats((m64p_run_stats*) ParamPtr);
+        case M64CMD_GET_TIMING_STATS:
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt < (int) sizeof(m64p_timing_stats))
+                return M64ERR_INPUT_INVALID;
+            return main_get_timing_stats((m64p_timing_stats*) ParamPtr, ParamInt);
+        case M64CMD_MOVIE_RECORD:
+            if (g_EmulatorRunning || !l_ROMOpen)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            return main_movie_record((const char*) ParamPtr);
+        case M64CMD_MOVIE_PLAY:
+            if (g_EmulatorRunning || !l_ROMOpen)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            return main_movie_play((const char*) ParamPtr);
+        case M64CMD_PROFILER_REPORT:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            return main_profiler_report((const char*) ParamPtr);
+        case M64CMD_EXPORT_INSTR_COUNTERS:
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            return main_export_instr_counters((const char*) ParamPtr, (m64p_export_format) ParamInt);
+        case M64CMD_GET_INTERRUPT_STATS:
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt != (int) sizeof(m64p_interrupt_stats))
+                return M64ERR_INPUT_INVALID;
+            return main_get_interrupt_stats((m64p_interrupt_stats*) ParamPtr);
+        case M64CMD_GET_MEMORY_FOOTPRINT:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt < (int) sizeof(m64p_memory_footprint))
+                return M64ERR_INPUT_INVALID;
+            return main_get_memory_footprint((m64p_memory_footprint*) ParamPtr, ParamInt);
+        case M64CMD_RELEASE_CACHES:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            return main_release_caches();
+        case M64CMD_STATE_READ_SECTION:
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt != (int) sizeof(m64p_state_section))
+                return M64ERR_INPUT_INVALID;
+            if (((m64p_state_section*) ParamPtr)->path == NULL)
+                return M64ERR_INPUT_ASSERT;
+            return main_state_read_section((m64p_state_section*) ParamPtr);
+        case M64CMD_STATE_SAVE_MEMORY:
+        case M64CMD_STATE_LOAD_MEMORY:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (ParamInt < (int) savestates_memory_size())
+                return M64ERR_INPUT_INVALID;
+            if (Command == M64CMD_STATE_SAVE_MEMORY)
+                return main_state_save_memory(ParamPtr, ParamInt);
+            return main_state_load_memory(ParamPtr, ParamInt);
         default:
             return M64ERR_INPUT_INVALID;
     }
@@ -61,6 +61,7 @@ typedef void (*m64p_frame_callback)(unsigned int FrameIndex);
 typedef void (*m64p_input_callback)(void);
 typedef void (*m64p_audio_callback)(void);
 typedef void (*m64p_vi_callback)(void);
+typedef void (*m64p_fork_callback)(int ChildPid);
 
 typedef enum {
   M64TYPE_INT = 1,
@@ -116,6 +117,20 @@ typedef enum {
   M64EMU_PAUSED
 } m64p_emu_state;
 
+typedef enum {
+  M64MOVIE_NONE = 0,
+  M64MOVIE_RECORDING,
+  M64MOVIE_PLAYING,
+  M64MOVIE_RECORDED,   /* the last recording was completed */
+  M64MOVIE_MATCHED,    /* the last replay reached the end of the movie with the recorded state */
+  M64MOVIE_DESYNC      /* the last replay diverged from the recording */
+} m64p_movie_state;
+
+typedef enum {
+  M64EXPORT_JSON = 1,
+  M64EXPORT_CSV
+} m64p_export_format;
+
 typedef enum {
   M64VIDEO_NONE = 1,
   M64VIDEO_WINDOWED,
@@ -139,6 +154,10 @@ typedef enum {
   M64CORE_STATE_LOADCOMPLETE,
   M64CORE_STATE_SAVECOMPLETE,
   M64CORE_SCREENSHOT_CAPTURED,
+  M64CORE_STATE_MEMORY_SIZE,
+  M64CORE_VI_LIMIT,
+  M64CORE_MOVIE_STATE,
+  M64CORE_TIMING_COUNTERS
 } m64p_core_param;
 
 typedef enum {
@@ -171,7 +190,28 @@ typedef enum {
   M64CMD_PIF_OPEN,
   M64CMD_ROM_SET_SETTINGS,
   M64CMD_DISK_OPEN,
-  M64CMD_DISK_CLOSE
+  M64CMD_DISK_CLOSE,
+  M64CMD_GET_RDRAM_DIRTY_PAGES,
+  M64CMD_GET_AUDIO_RING_STATS,
+  M64CMD_GET_FRAME_PACING_STATS,
+  M64CMD_GET_HOUSEKEEPING_STATS,
+  M64CMD_STATE_SAVE_MEMORY,
+  M64CMD_STATE_LOAD_MEMORY,
+  M64CMD_REWIND_STEP,
+  M64CMD_GET_REWIND_STATS,
+  M64CMD_FORK_SNAPSHOT,
+  M64CMD_STATE_READ_SECTION,
+  M64CMD_ROM_OPEN_FILE,
+  M64CMD_FORK_INSTANCE,
+  M64CMD_GET_RUN_STATS,
+  M64CMD_MOVIE_RECORD,
+  M64CMD_MOVIE_PLAY,
+  M64CMD_GET_TIMING_STATS,
+  M64CMD_PROFILER_REPORT,
+  M64CMD_EXPORT_INSTR_COUNTERS,
+  M64CMD_GET_INTERRUPT_STATS,
+  M64CMD_GET_MEMORY_FOOTPRINT,
+  M64CMD_RELEASE_CACHES
 } m64p_command;
 
 typedef struct {
@@ -179,6 +219,103 @@ typedef struct {
   int      value;
 } m64p_cheat_code;
 
+typedef struct {
+  uint32_t capacity;   /* size of the ring in bytes */
+  uint32_t fill;       /* bytes queued and not yet handed to the audio plugin */
+  uint32_t pushes;     /* AI DMAs queued */
+  uint32_t batches;    /* consumer wakeups which handed samples to the audio plugin */
+  uint32_t overruns;   /* AI DMAs dropped because the ring was full */
+  uint32_t underruns;  /* batches handed over after the previous one should have finished playing */
+} m64p_audio_ring_stats;
+
+typedef struct {
+  int64_t  error_p50_ns;  /* median of frame release time minus deadline */
+  int64_t  error_p99_ns;  /* 99th percentile of frame release time minus deadline */
+  int64_t  error_max_ns;  /* worst frame release time minus deadline */
+  uint32_t samples;       /* number of recent frames the percentiles are computed on */
+  uint32_t late_frames;   /* frames which reached the limiter after their deadline */
+  uint32_t resyncs;       /* schedule resets because emulation was too far behind or ahead */
+  uint32_t period_ns;     /* current frame period, including the speed factor */
+} m64p_frame_pacing_stats;
+
+typedef struct {
+  uint64_t buffer_size;      /* size of the rewind history in bytes */
+  uint64_t buffer_used;      /* bytes used by the stored deltas */
+  uint32_t snapshots;        /* snapshots which can be restored */
+  uint32_t interval;         /* VIs between two snapshots */
+  uint64_t captures;
+  uint64_t restores;
+  uint64_t evictions;        /* oldest snapshots dropped to make room */
+  uint64_t last_delta_size;  /* size in bytes of the last stored delta */
+  uint64_t capture_avg_ns;   /* average time spent taking a snapshot */
+  uint64_t capture_max_ns;
+  uint64_t restore_last_ns;  /* time spent in the last restore */
+  uint64_t restore_max_ns;
+} m64p_rewind_stats;
+
+typedef struct {
+  uint64_t vis;              /* VIs emulated by the current or last run */
+  uint64_t compiled_blocks;  /* blocks compiled by the cached interpreter or the recompilers */
+  uint64_t run_ns;           /* wall time spent in the emulation loop */
+  uint64_t gfx_ns;           /* time spent in the section timers, valid if timed is set */
+  uint64_t audio_ns;
+  uint64_t compiler_ns;
+  uint64_t idle_ns;          /* time spent in the speed limiter */
+  uint32_t timed;            /* 1 if the timing counters (M64CORE_TIMING_COUNTERS) were enabled */
+  uint32_t emumode;          /* R4300 emulator used: 0 pure interpreter, 1 cached interpreter, 2 dynarec */
+} m64p_run_stats;
+
+typedef struct {
+  const char *path;   /* savestate container file */
+  char        tag[4]; /* section tag, e.g. "RDRM" for RDRAM */
+  void       *buffer; /* NULL to query the section size */
+  uint32_t    size;   /* in: size of buffer, out: size of the section */
+} m64p_state_section;
+
+typedef struct {
+  char     name[16];      /* NUL terminated, empty for unused entries */
+  uint32_t rate;          /* 0: every VI, 1: at most every interval_ms, 2: on demand */
+  uint32_t interval_ms;
+  uint64_t runs;          /* VIs on which the task ran */
+  uint64_t skips;         /* VIs on which the task was not due */
+  uint64_t total_ns;      /* time spent running the task */
+  uint64_t max_ns;        /* longest single run */
+} m64p_housekeeping_stats;
+
+typedef struct {
+  char     name[16];      /* NUL terminated, empty for unused entries */
+  int32_t  parent;        /* index of the section it was last entered from, -1 for the root */
+  uint32_t reserved;
+  uint64_t calls;
+  uint64_t inclusive_ns;  /* time spent in the section, nested sections included */
+  uint64_t exclusive_ns;  /* time spent in the section itself */
+} m64p_timing_stats;
+
+typedef struct {
+  char     name[16];            /* NUL terminated, e.g. "VI_INT" */
+  uint32_t scheduled;           /* events added to the interrupt queue */
+  uint32_t dispatched;          /* events handled */
+  uint64_t latency_cycles;      /* sum of the guest cycles between the event count and its dispatch */
+  uint32_t max_latency_cycles;
+  uint32_t reserved;
+} m64p_interrupt_type_stats;
+
+typedef struct {
+  uint32_t vis;                 /* completed VIs covered, at most the last 60 */
+  uint32_t count_per_op;        /* guest cycles added per instruction, */
+  uint32_t count_per_op_denom_pot; /* divided by 2^count_per_op_denom_pot */
+  uint32_t checks;              /* interrupt line checks */
+  uint32_t check_raised;        /* of which scheduled a CHECK_INT event */
+  uint32_t queue_length[17];    /* events scheduled, by length of the queue once added */
+  m64p_interrupt_type_stats types[16]; /* indexed like the core interrupt handlers */
+} m64p_interrupt_stats;
+
+typedef struct {
+  char     name[16];            /* NUL terminated, empty for unused entries */
+  uint64_t allocated;           /* bytes reserved for the subsystem */
+  uint64_t resident;            /* of which in physical memory, UINT64_MAX if unknown */
+} m64p_memory_footprint;
+
 typedef struct {
   /* Frontend-defined callback data. */
   void* cb_data;
@@ -21,21 +21,261 @@
 
 #include "file_storage.h"
 
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
 #include "backends/api/storage_backend.h"
 #include "device/dd/dd_controller.h"
 #include "main/util.h"
+#include "main/fork_snapshot.h"
 #include "main/netplay.h"
+#include "osal/files.h"
+
+/* Background writer of save files. Devices only mark dirty ranges on the
+ * emulation thread, consecutive writes to a storage being coalesced until
+ * the next flush. */
+static struct
+{
+    SDL_Thread* thread;
+    SDL_mutex* lock;        /* dirty ranges and counters */
+    SDL_mutex* io_lock;     /* list of storages, held while writing them back */
+    SDL_cond* wake;
+    int stop;
+    unsigned int interval_ms;
+    struct file_storage* storages;
+
+    uint64_t writes;        /* save requests from the devices */
+    uint64_t coalesced;     /* requests merged with a pending one */
+    uint64_t flushes;       /* file writes or syncs issued */
+} l_flusher;
+
+static void report_storage_error(const struct file_storage* fstorage, file_status_t err)
+{
+    switch(err)
+    {
+    case file_open_error:
+        DebugMessage(M64MSG_WARNING, "couldn't open storage file '%s' for writing", fstorage->filename);
+        break;
+    case file_write_error:
+        DebugMessage(M64MSG_WARNING, "failed to write storage file '%s'", fstorage->filename);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Write back the dirty range of a storage, io_lock held */
+static void flush_file_storage(struct file_storage* fstorage)
+{
+    size_t start, end;
+    int full;
+    file_status_t err;
+
+    SDL_LockMutex(l_flusher.lock);
+    start = fstorage->dirty_start;
+    end = fstorage->dirty_end;
+    full = fstorage->first_access;
+    fstorage->dirty_start = fstorage->dirty_end = 0;
+    if (start != end) {
+        fstorage->first_access = 0;
+        ++l_flusher.flushes;
+    }
+    SDL_UnlockMutex(l_flusher.lock);
+
+    if (start == end)
+        return;
+
+    /* data may change while being written, which marks it dirty again */
+    if (fstorage->map_size != 0) {
+        err = (osal_file_sync(fstorage->data, start, end - start) == 0) ? file_ok : file_write_error;
+    }
+    else if (full) {
+        err = write_to_file(fstorage->filename, fstorage->data, fstorage->size);
+    }
+    else {
+        err = write_chunk_to_file(fstorage->filename, fstorage->data + start, end - start, start);
+    }
+
+    report_storage_error(fstorage, err);
+}
+
+static int flusher_thread(void* data)
+{
+    struct file_storage* fstorage;
+
+    (void)data;
+
+    SDL_LockMutex(l_flusher.lock);
+    while (!l_flusher.stop)
+    {
+        SDL_CondWaitTimeout(l_flusher.wake, l_flusher.lock, l_flusher.interval_ms);
+        SDL_UnlockMutex(l_flusher.lock);
+
+        SDL_LockMutex(l_flusher.io_lock);
+        for (fstorage = l_flusher.storages; fstorage != NULL; fstorage = fstorage->next)
+            flush_file_storage(fstorage);
+        SDL_UnlockMutex(l_flusher.io_lock);
+
+        SDL_LockMutex(l_flusher.lock);
+    }
+    SDL_UnlockMutex(l_flusher.lock);
+
+    return 0;
+}
+
+static void register_file_storage(struct file_storage* fstorage)
+{
+    SDL_LockMutex(l_flusher.io_lock);
+    fstorage->next = l_flusher.storages;
+    l_flusher.storages = fstorage;
+    fstorage->flushed = 1;
+    SDL_UnlockMutex(l_flusher.io_lock);
+}
+
+/* Write back pending changes and remove the storage from the flusher */
+static void unregister_file_storage(struct file_storage* fstorage)
+{
+    struct file_storage** link;
+
+    SDL_LockMutex(l_flusher.io_lock);
+    for (link = &l_flusher.storages; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == fstorage) {
+            *link = fstorage->next;
+            break;
+        }
+    }
+    flush_file_storage(fstorage);
+    fstorage->flushed = 0;
+    SDL_UnlockMutex(l_flusher.io_lock);
+}
+
+static void mark_file_storage_dirty(struct file_storage* fstorage, size_t start, size_t size)
+{
+    SDL_LockMutex(l_flusher.lock);
+    ++l_flusher.writes;
+    if (fstorage->dirty_start == fstorage->dirty_end) {
+        fstorage->dirty_start = start;
+        fstorage->dirty_end = start + size;
+    }
+    else {
+        ++l_flusher.coalesced;
+        if (start < fstorage->dirty_start)
+            fstorage->dirty_start = start;
+        if (start + size > fstorage->dirty_end)
+            fstorage->dirty_end = start + size;
+    }
+    SDL_UnlockMutex(l_flusher.lock);
+}
+
+int file_storage_flusher_start(unsigned int interval_ms)
+{
+    if (interval_ms == 0)
+        return -1;
+
+    memset(&l_flusher, 0, sizeof(l_flusher));
+    l_flusher.interval_ms = interval_ms;
+    l_flusher.lock = SDL_CreateMutex();
+    l_flusher.io_lock = SDL_CreateMutex();
+    l_flusher.wake = SDL_CreateCond();
+    if (l_flusher.lock == NULL || l_flusher.io_lock == NULL || l_flusher.wake == NULL)
+        goto fail;
+
+#if SDL_VERSION_ATLEAST(2,0,0)
+    l_flusher.thread = SDL_CreateThread(flusher_thread, "m64pflush", NULL);
+#else
+    l_flusher.thread = SDL_CreateThread(flusher_thread, NULL);
+#endif
+    if (l_flusher.thread == NULL)
+        goto fail;
+
+    return 0;
+
+fail:
+    DebugMessage(M64MSG_WARNING, "Could not start save file flusher, writing save files synchronously");
+    file_storage_flusher_stop();
+    return -1;
+}
+
+void file_storage_flusher_stop(void)
+{
+    if (l_flusher.thread != NULL)
+    {
+        SDL_LockMutex(l_flusher.lock);
+        l_flusher.stop = 1;
+        SDL_CondSignal(l_flusher.wake);
+        SDL_UnlockMutex(l_flusher.lock);
+        SDL_WaitThread(l_flusher.thread, NULL);
+
+        if (l_flusher.writes != 0)
+            DebugMessage(M64MSG_INFO, "Save files: %llu writes, %llu coalesced, %llu flushes",
+                         (unsigned long long)l_flusher.writes,
+                         (unsigned long long)l_flusher.coalesced,
+                         (unsigned long long)l_flusher.flushes);
+    }
+
+    if (l_flusher.wake != NULL)
+        SDL_DestroyCond(l_flusher.wake);
+    if (l_flusher.io_lock != NULL)
+        SDL_DestroyMutex(l_flusher.io_lock);
+    if (l_flusher.lock != NULL)
+        SDL_DestroyMutex(l_flusher.lock);
+    memset(&l_flusher, 0, sizeof(l_flusher));
+}
+
+void file_storage_fork_child(void)
+{
+    struct file_storage* fstorage;
+
+    /* only the emulation thread exists in the child and it is the one
+     * modifying the list, so no lock is needed (or safe) here */
+    for (fstorage = l_flusher.storages; fstorage != NULL; fstorage = fstorage->next)
+    {
+        if (fstorage->map_size != 0 && osal_file_detach(fstorage->data, fstorage->map_size) != 0)
+            DebugMessage(M64MSG_WARNING, "Could not detach storage file '%s' from the parent process", fstorage->filename);
+        fstorage->flushed = 0;
+    }
+
+    /* the flusher thread did not survive the fork and may have held its locks */
+    memset(&l_flusher, 0, sizeof(l_flusher));
+}
 
 int open_file_storage(struct file_storage* fstorage, size_t size, const char* filename)
 {
+    int ret;
+
     /* ! Take ownership of filename ! */
     fstorage->filename = filename;
     fstorage->size = size;
     fstorage->first_access = 1;
+    fstorage->flushed = 0;
+    fstorage->map_size = 0;
+    fstorage->dirty_start = fstorage->dirty_end = 0;
+    fstorage->next = NULL;
+
+    /* write existing files in place, through a shared mapping */
+    if (l_flusher.thread != NULL && !netplay_is_init())
+    {
+        size_t map_size = 0;
+        uint8_t* map = osal_file_map_shared(fstorage->filename, &map_size);
+
+        if (map != NULL && map_size == size) {
+            fstorage->data = map;
+            fstorage->map_size = map_size;
+            fstorage->first_access = 0;
+            register_file_storage(fstorage);
+            return file_ok;
+        }
+
+        if (map != NULL)
+            osal_file_unmap(map, map_size);
+    }
 
     /* allocate memory for holding data */
     fstorage->data = malloc(fstorage->size);
@@ -46,7 +286,10 @@ int open_file_storage(struct file_storage* fstorage, size_t size, const char* fi
     /* try to load storage file content */
     if (!netplay_is_init())
     {
-        return read_from_file(fstorage->filename, fstorage->data, fstorage->size);
+        ret = read_from_file(fstorage->filename, fstorage->data, fstorage->size);
+        if (l_flusher.thread != NULL)
+            register_file_storage(fstorage);
+        return ret;
     }
     else
     {
@@ -60,6 +303,10 @@ int open_rom_file_storage(struct file_storage* fstorage, const char* filename)
     fstorage->size = 0;
     fstorage->filename = NULL;
     fstorage->first_access = 1;
+    fstorage->flushed = 0;
+    fstorage->map_size = 0;
+    fstorage->dirty_start = fstorage->dirty_end = 0;
+    fstorage->next = NULL;
 
     file_status_t err = load_file(filename, (void**)&fstorage->data, &fstorage->size);
 
@@ -73,7 +320,13 @@ int open_rom_file_storage(struct file_storage* fstorage, const char* filename)
 
 void close_file_storage(struct file_storage* fstorage)
 {
-    free((void*)fstorage->data);
+    if (fstorage->flushed)
+        unregister_file_storage(fstorage);
+
+    if (fstorage->map_size != 0)
+        osal_file_unmap(fstorage->data, fstorage->map_size);
+    else
+        free((void*)fstorage->data);
     free((void*)fstorage->filename);
 }
 
@@ -95,10 +348,19 @@ static void file_storage_save(void* storage, size_t start, size_t size)
     if (netplay_is_init() && netplay_get_controller(0) == -1)
         return;
 
+    /* forked snapshots share their save files with the parent */
+    if (fork_snapshot_is_child())
+        return;
+
     struct file_storage* fstorage = (struct file_storage*)storage;
 
     file_status_t err;
 
+    if (fstorage->flushed) {
+        mark_file_storage_dirty(fstorage, start, size);
+        return;
+    }
+
     /* On first save access ignore start/size and write full storage content,
      * otherwise write only updated chunk */
     if (fstorage->first_access) {
@@ -109,23 +371,16 @@ static void file_storage_save(void* storage, size_t start, size_t size)
         err = write_chunk_to_file(fstorage->filename, fstorage->data + start, size, start);
     }
 
-    switch(err)
-    {
-    case file_open_error:
-        DebugMessage(M64MSG_WARNING, "couldn't open storage file '%s' for writing", fstorage->filename);
-        break;
-    case file_write_error:
-        DebugMessage(M64MSG_WARNING, "failed to write storage file '%s'", fstorage->filename);
-        break;
-    default:
-        break;
-    }
+    report_storage_error(fstorage, err);
 }
 
 static void file_storage_parent_save(void* storage, size_t start, size_t size)
 {
-    struct file_storage* fstorage = (struct file_storage*)((struct file_storage*)storage)->filename;
-    file_storage_save(fstorage, start, size);
+    struct file_storage* substorage = (struct file_storage*)storage;
+    struct file_storage* fstorage = (struct file_storage*)substorage->filename;
+
+    /* start is relative to the part of the parent held by the substorage */
+    file_storage_save(fstorage, (size_t)(substorage->data - fstorage->data) + start, size);
 }
 
 static void dummy_save(void* storage, size_t start, size_t size)
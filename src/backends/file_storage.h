@@ -31,6 +31,13 @@ struct file_storage
     size_t size;
     const char* filename;
     int first_access;
+
+    /* background flushing */
+    int flushed;            /* changes are written back by the flusher thread */
+    size_t map_size;        /* size of the shared file mapping holding data, 0 if data is malloc'd */
+    size_t dirty_start;     /* range waiting to be written back */
+    size_t dirty_end;
+    struct file_storage* next;
 };
 
 
@@ -38,6 +45,15 @@ int open_file_storage(struct file_storage* storage, size_t size, const char* fil
 int open_rom_file_storage(struct file_storage* storage, const char* filename);
 void close_file_storage(struct file_storage* storage);
 
+/* Write back changes of the storages opened afterwards from a background
+ * thread every interval_ms, existing files being mapped in memory.
+ * Returns 0 on success, -1 if changes are written synchronously. */
+int file_storage_flusher_start(unsigned int interval_ms);
+/* Stop the flusher, once all flushed storages are closed */
+void file_storage_flusher_stop(void);
+/* Keep changes of a forked process away from the files of its parent */
+void file_storage_fork_child(void);
+
 extern const struct storage_backend_interface g_ifile_storage;
 extern const struct storage_backend_interface g_ifile_storage_ro;
 extern const struct storage_backend_interface g_isubfile_storage;
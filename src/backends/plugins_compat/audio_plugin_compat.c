@@ -22,6 +22,7 @@
 #include <stdint.h>
 
 #include "backends/api/audio_out_backend.h"
+#include "backends/plugins_compat/plugins_compat.h"
 #include "device/rcp/ai/ai_controller.h"
 #include "device/rcp/ri/ri_controller.h"
 #include "device/rcp/vi/vi_controller.h"
@@ -63,3 +64,32 @@ const struct audio_out_backend_interface g_iaudio_out_backend_plugin_compat =
     audio_plugin_set_frequency,
     audio_plugin_push_samples
 };
+
+/* When the audio plugin is driven by the audio ring consumer thread, it is
+ * given its own copy of the AI registers and sees the ring storage as RDRAM,
+ * so that it never looks at emulated state from another thread.
+ */
+int g_audio_plugin_ring_enabled = 0;
+uint32_t g_audio_plugin_ring_regs[AI_REGS_COUNT];
+uint8_t g_audio_plugin_ring_buffer[AUDIO_PLUGIN_RING_SIZE];
+
+static void audio_plugin_ring_set_frequency(void* aout, unsigned int frequency)
+{
+    g_audio_plugin_ring_regs[AI_DACRATE_REG] = vi_clock_from_tv_standard(ROM_PARAMS.systemtype) / frequency - 1;
+
+    audio.aiDacrateChanged(ROM_PARAMS.systemtype);
+}
+
+static void audio_plugin_ring_push_samples(void* aout, const void* buffer, size_t size)
+{
+    g_audio_plugin_ring_regs[AI_DRAM_ADDR_REG] = (uint32_t)((const uint8_t*)buffer - g_audio_plugin_ring_buffer);
+    g_audio_plugin_ring_regs[AI_LEN_REG] = (uint32_t)size;
+
+    audio.aiLenChanged();
+}
+
+const struct audio_out_backend_interface g_iaudio_out_backend_plugin_ring_compat =
+{
+    audio_plugin_ring_set_frequency,
+    audio_plugin_ring_push_samples
+};
@@ -27,6 +27,7 @@
 #include "plugin/plugin.h"
 
 #include "main/main.h"
+#include "main/movie.h"
 #include "main/netplay.h"
 
 #include <stdint.h>
@@ -85,6 +86,9 @@ static m64p_error input_plugin_get_input(void* opaque, uint32_t* input_)
         cin_compat->last_pak_type = Controls[cin_compat->control_id].Plugin; //disable pak switching for netplay
     }
 
+    /* record the polled state, or replace it with the movie's */
+    movie_update_input(cin_compat->control_id, &keys.Value);
+
     /* return an error if controller is not plugged */
     if (!Controls[cin_compat->control_id].Present) {
         return M64ERR_SYSTEM_FAIL;
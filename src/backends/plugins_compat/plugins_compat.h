@@ -34,6 +34,17 @@
 extern const struct audio_out_backend_interface
     g_iaudio_out_backend_plugin_compat;
 
+/* Audio plugin fed from the audio ring consumer thread */
+
+#define AUDIO_PLUGIN_RING_SIZE 0x40000
+
+extern int g_audio_plugin_ring_enabled;
+extern uint32_t g_audio_plugin_ring_regs[];
+extern uint8_t g_audio_plugin_ring_buffer[AUDIO_PLUGIN_RING_SIZE];
+
+extern const struct audio_out_backend_interface
+    g_iaudio_out_backend_plugin_ring_compat;
+
 /* Controller Input backend interface */
 
 struct controller_input_compat
@@ -21,6 +21,7 @@
 
 #include "device.h"
 
+#include "main/profile.h"
 #include "memory/memory.h"
 #include "pif/pif.h"
 #include "r4300/r4300_core.h"
@@ -46,6 +47,24 @@ static void write_open_bus(void* opaque, uint32_t address, uint32_t value, uint3
 {
 }
 
+static void read_timed_mmio(void* opaque, uint32_t address, uint32_t* value)
+{
+    const struct timed_mmio* mmio = (const struct timed_mmio*)opaque;
+
+    timed_section_start((enum timed_section)mmio->section);
+    mem_read32(&mmio->handler, address, value);
+    timed_section_end((enum timed_section)mmio->section);
+}
+
+static void write_timed_mmio(void* opaque, uint32_t address, uint32_t value, uint32_t mask)
+{
+    const struct timed_mmio* mmio = (const struct timed_mmio*)opaque;
+
+    timed_section_start((enum timed_section)mmio->section);
+    mem_write32(&mmio->handler, address, value, mask);
+    timed_section_end((enum timed_section)mmio->section);
+}
+
 static void get_pi_dma_handler(struct cart* cart, struct dd_controller* dd, uint32_t address, void** opaque, const struct pi_dma_handler** handler)
 {
 #define RW(o, x) \
@@ -87,6 +106,8 @@ void init_device(struct device* dev,
     int no_compiled_jump,
     int randomize_interrupt,
     uint32_t start_address,
+    /* rsp */
+    int async_rsp_tasks,
     /* ai */
     void* aout, const struct audio_out_backend_interface* iaout, float dma_modifier,
     /* si */
@@ -184,7 +205,7 @@ void init_device(struct device* dev,
     init_r4300(&dev->r4300, &dev->mem, &dev->mi, &dev->rdram, interrupt_handlers,
             emumode, count_per_op, count_per_op_denom_pot, no_compiled_jump, randomize_interrupt, start_address);
     init_rdp(&dev->dp, &dev->sp, &dev->mi, &dev->mem, &dev->rdram, &dev->r4300);
-    init_rsp(&dev->sp, mem_base_u32(base, MM_RSP_MEM), &dev->mi, &dev->dp, &dev->ri);
+    init_rsp(&dev->sp, mem_base_u32(base, MM_RSP_MEM), &dev->mi, &dev->dp, &dev->ri, async_rsp_tasks);
     init_ai(&dev->ai, &dev->mi, &dev->ri, &dev->vi, aout, iaout, dma_modifier);
     init_mi(&dev->mi, &dev->r4300);
     init_pi(&dev->pi,
@@ -281,3 +302,56 @@ void soft_reset_device(struct device* dev)
     add_interrupt_event(&dev->r4300.cp0, HW2_INT, 0);
     add_interrupt_event(&dev->r4300.cp0, NMI_INT, 50000000);
 }
+
+void device_timed_mmio(struct device* dev, int enable)
+{
+#define A(x,m) (x), (x) | (m)
+    static const struct
+    {
+        uint32_t begin;
+        uint32_t end;
+        enum timed_section section;
+    } ranges[TIMED_MMIO_COUNT] = {
+        { A(MM_RDRAM_REGS, 0xfffff), TIMED_SECTION_MMIO_RDRAM },
+        { A(MM_RSP_REGS, 0xffff), TIMED_SECTION_MMIO_SP },
+        { A(MM_RSP_REGS2, 0xffff), TIMED_SECTION_MMIO_SP },
+        { A(MM_DPC_REGS, 0xffff), TIMED_SECTION_MMIO_DP },
+        { A(MM_DPS_REGS, 0xffff), TIMED_SECTION_MMIO_DP },
+        { A(MM_MI_REGS, 0xffff), TIMED_SECTION_MMIO_MI },
+        { A(MM_VI_REGS, 0xffff), TIMED_SECTION_MMIO_VI },
+        { A(MM_AI_REGS, 0xffff), TIMED_SECTION_MMIO_AI },
+        { A(MM_PI_REGS, 0xffff), TIMED_SECTION_MMIO_PI },
+        { A(MM_RI_REGS, 0xffff), TIMED_SECTION_MMIO_RI },
+        { A(MM_SI_REGS, 0xffff), TIMED_SECTION_MMIO_SI },
+        { A(MM_DOM2_ADDR1, 0xffffff), TIMED_SECTION_MMIO_DD },
+        { A(MM_DOM2_ADDR2, 0x1ffff), TIMED_SECTION_MMIO_CART },
+        { A(MM_PIF_MEM, 0xffff), TIMED_SECTION_MMIO_PIF },
+    };
+#undef A
+    size_t i;
+    uint32_t page;
+
+    for (i = 0; i < ARRAY_SIZE(ranges); ++i) {
+        struct timed_mmio* mmio = &dev->timed_mmio[i];
+        struct mem_handler* first = &dev->mem.handlers[ranges[i].begin >> 16];
+        struct mem_handler handler;
+        int wrapped = (first->read32 == read_timed_mmio);
+
+        if ((enable != 0) == wrapped) {
+            continue;
+        }
+
+        if (enable) {
+            mmio->handler = *first;
+            mmio->section = (int)ranges[i].section;
+            handler = (struct mem_handler){ mmio, read_timed_mmio, write_timed_mmio };
+        }
+        else {
+            handler = mmio->handler;
+        }
+
+        for (page = ranges[i].begin >> 16; page <= (ranges[i].end >> 16); ++page) {
+            dev->mem.handlers[page] = handler;
+        }
+    }
+}
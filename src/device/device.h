@@ -84,6 +84,15 @@ enum { GAME_CONTROLLERS_COUNT = 4 };
 #define MM_PIF_MEM          UINT32_C(0x1fc00000)
 #define MM_CART_DOM3        UINT32_C(0x1fd00000) /* dom2 addr2 */
 
+enum { TIMED_MMIO_COUNT = 14 };
+
+/* MMIO handler wrapped by device_timed_mmio */
+struct timed_mmio
+{
+    struct mem_handler handler;
+    int section;
+};
+
 /* Device structure is a container for the n64 submodules
  * It contains all state related to the emulated system. */
 struct device
@@ -112,6 +121,8 @@ struct device
     struct cart cart;
 
     struct dd_controller dd;
+
+    struct timed_mmio timed_mmio[TIMED_MMIO_COUNT];
 };
 
 /* Setup device "static" properties.  */
@@ -125,6 +136,8 @@ void init_device(struct device* dev,
     int no_compiled_jump,
     int randomize_interrupt,
     uint32_t start_address,
+    /* rsp */
+    int async_rsp_tasks,
     /* ai */
     void* aout, const struct audio_out_backend_interface* iaout, float dma_modifier,
     /* si */
@@ -173,4 +186,9 @@ void hard_reset_device(struct device* dev);
  */
 void soft_reset_device(struct device* dev);
 
+/* Route register accesses through handlers charging their time to the
+ * matching TIMED_SECTION_MMIO_* section, or restore the plain handlers.
+ */
+void device_timed_mmio(struct device* dev, int enable);
+
 #endif
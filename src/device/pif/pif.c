@@ -35,6 +35,7 @@
 #include "device/rcp/si/si_controller.h"
 #include "plugin/plugin.h"
 #include "main/netplay.h"
+#include "main/profile.h"
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
@@ -371,6 +372,8 @@ void update_pif_ram(struct pif* pif)
 {
     size_t k;
 
+    timed_section_start(TIMED_SECTION_INPUT);
+
     /* perform PIF/Channel communications */
     for (k = 0; k < PIF_CHANNELS_COUNT; ++k) {
         process_channel(&pif->channels[k]);
@@ -383,6 +386,8 @@ void update_pif_ram(struct pif* pif)
 
     netplay_update_input(pif);
 
+    timed_section_end(TIMED_SECTION_INPUT);
+
 #ifdef DEBUG_PIF
     DebugMessage(M64MSG_INFO, "PIF post read");
     print_pif(pif);
@@ -34,6 +34,10 @@
 #include "api/m64p_types.h"
 #include "device/r4300/r4300_core.h"
 #include "device/r4300/idec.h"
+#if defined(COUNT_INSTR)
+#include "device/r4300/instr_counters.h"
+#endif
+#include "main/footprint.h"
 #include "main/main.h"
 #include "osal/preproc.h"
 
@@ -50,6 +54,12 @@
 #define UPDATE_DEBUGGER() do { } while(0)
 #endif
 
+#if defined(COUNT_INSTR)
+#define COUNT_INSTR_AT_PC() instr_counters_add((enum r4300_opcode)(*r4300_pc_struct(r4300))->opcode, (*r4300_pc_struct(r4300))->addr)
+#else
+#define COUNT_INSTR_AT_PC() do { } while(0)
+#endif
+
 #define DECLARE_R4300 struct r4300_core* r4300 = &g_dev.r4300;
 #define PCADDR *r4300_pc(r4300)
 #ifdef NEW_DYNAREC
@@ -83,6 +93,7 @@ void cached_interp_##name(void) \
         (*r4300_pc_struct(r4300))++; \
         r4300->delay_slot=1; \
         UPDATE_DEBUGGER(); \
+        COUNT_INSTR_AT_PC(); \
         (*r4300_pc_struct(r4300))->ops(); \
         cp0_update_count(r4300); \
         r4300->delay_slot=0; \
@@ -116,6 +127,7 @@ void cached_interp_##name##_OUT(void) \
         (*r4300_pc_struct(r4300))++; \
         r4300->delay_slot=1; \
         UPDATE_DEBUGGER(); \
+        COUNT_INSTR_AT_PC(); \
         (*r4300_pc_struct(r4300))->ops(); \
         cp0_update_count(r4300); \
         r4300->delay_slot=0; \
@@ -250,6 +262,7 @@ void cached_interp_NOTCOMPILED(void)
 The preceeding update_debugger SHOULD be unnecessary since it should have been
 called before NOTCOMPILED would have been executed
 */
+    COUNT_INSTR_AT_PC();
     (*r4300_pc_struct(r4300))->ops();
 }
 
@@ -787,6 +800,9 @@ void cached_interp_init_block(struct r4300_core* r4300, uint32_t address)
     {
         b->block[i].addr = b->start + 4*i;
         b->block[i].ops = cached_interp_NOTCOMPILED;
+#if defined(COUNT_INSTR)
+        b->block[i].opcode = R4300_OPCODES_COUNT;
+#endif
     }
 
     /* here we're marking the block as a valid code even if it's not compiled
@@ -860,6 +876,9 @@ void cached_interp_recompile_block(struct r4300_core* r4300, const uint32_t* iw,
 
         /* decode instruction */
         opcode = r4300_decode(inst, r4300, r4300_get_idec(iw[i]), iw[i], iw[i+1], block);
+#if defined(COUNT_INSTR)
+        inst->opcode = opcode;
+#endif
 
         /* decode ending conditions */
         if (i >= length2) { finished = 2; }
@@ -881,12 +900,18 @@ void cached_interp_recompile_block(struct r4300_core* r4300, const uint32_t* iw,
         inst = block->block + i;
         inst->addr = block->start + i*4;
         inst->ops = cached_interp_FIN_BLOCK;
+#if defined(COUNT_INSTR)
+        inst->opcode = R4300_OPCODES_COUNT;
+#endif
         ++i;
         if (i <= length2) // useful when last opcode is a jump
         {
             inst = block->block + i;
             inst->addr = block->start + i*4;
             inst->ops = cached_interp_FIN_BLOCK;
+#if defined(COUNT_INSTR)
+            inst->opcode = R4300_OPCODES_COUNT;
+#endif
             i++;
         }
     }
@@ -943,6 +968,52 @@ void free_blocks(struct cached_interp* cinterp)
     }
 }
 
+/* Free every block but the one being executed, the others are set up
+ * again by the next jump to them */
+void release_cached_code_hacktarux(struct r4300_core* r4300)
+{
+    struct cached_interp* cinterp = &r4300->cached_interp;
+    const struct precomp_block* keep = cinterp->actual;
+    size_t keep_paddr = 0;
+    size_t i;
+
+    /* a TLB mapped block is recompiled along with its physical page */
+    if (keep != NULL && (keep->end < UINT32_C(0x80000000) || keep->start >= UINT32_C(0xc0000000)))
+    {
+        keep_paddr = r4300->cp0.tlb.LUT_r[keep->start >> 12] >> 12;
+    }
+
+    for (i = 0; i < 0x100000; ++i)
+    {
+        if (cinterp->blocks[i] && cinterp->blocks[i] != keep && (keep_paddr == 0 || i != keep_paddr))
+        {
+            cinterp->free_block(cinterp->blocks[i]);
+            free(cinterp->blocks[i]);
+            cinterp->blocks[i] = NULL;
+            cinterp->invalid_code[i] = 1;
+        }
+    }
+}
+
+void blocks_footprint(const struct cached_interp* cinterp, m64p_memory_footprint* blocks, m64p_memory_footprint* code)
+{
+    size_t i;
+
+    footprint_add(blocks, cinterp->blocks, sizeof(cinterp->blocks));
+
+    for (i = 0; i < 0x100000; ++i)
+    {
+        const struct precomp_block* b = cinterp->blocks[i];
+        if (b == NULL)
+            continue;
+
+        footprint_add_heap(blocks, sizeof(*b));
+        footprint_add(blocks, b->block, get_block_memsize(b));
+        if (code != NULL)
+            footprint_add(code, b->code, b->max_code_length);
+    }
+}
+
 void invalidate_cached_code_hacktarux(struct r4300_core* r4300, uint32_t address, size_t size)
 {
     size_t i;
@@ -995,6 +1066,9 @@ void run_cached_interpreter(struct r4300_core* r4300)
 #endif
 #ifdef DBG
         if (g_DebuggerActive) update_debugger((*r4300_pc_struct(r4300))->addr);
+#endif
+#if defined(COUNT_INSTR)
+        instr_counters_add((enum r4300_opcode)(*r4300_pc_struct(r4300))->opcode, (*r4300_pc_struct(r4300))->addr);
 #endif
         (*r4300_pc_struct(r4300))->ops();
     }
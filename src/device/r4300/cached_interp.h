@@ -25,6 +25,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "api/m64p_types.h"
 #include "idec.h"
 
 struct r4300_core;
@@ -45,8 +46,10 @@ void cached_interp_recompile_block(struct r4300_core* r4300, const uint32_t* iw,
 
 void init_blocks(struct cached_interp* cinterp);
 void free_blocks(struct cached_interp* cinterp);
+void blocks_footprint(const struct cached_interp* cinterp, m64p_memory_footprint* blocks, m64p_memory_footprint* code);
 
 void invalidate_cached_code_hacktarux(struct r4300_core* r4300, uint32_t address, size_t size);
+void release_cached_code_hacktarux(struct r4300_core* r4300);
 
 void run_cached_interpreter(struct r4300_core* r4300);
 
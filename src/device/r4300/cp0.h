@@ -175,6 +175,28 @@ struct interrupt_handler
 
 enum { CP0_INTERRUPT_HANDLERS_COUNT = 16 };
 
+enum { INTERRUPT_STATS_WINDOW = 60 };
+
+/* interrupt activity during one VI, indexed like the interrupt handlers */
+struct interrupt_vi_stats
+{
+    uint32_t scheduled[CP0_INTERRUPT_HANDLERS_COUNT];   /* events added to the queue */
+    uint32_t dispatched[CP0_INTERRUPT_HANDLERS_COUNT];  /* events handled by gen_interrupt */
+    uint64_t latency[CP0_INTERRUPT_HANDLERS_COUNT];     /* cycles between the event count and its dispatch */
+    uint32_t max_latency[CP0_INTERRUPT_HANDLERS_COUNT];
+    uint32_t checks;                                    /* r4300_check_interrupt calls */
+    uint32_t check_raised;                              /* of which queued a CHECK_INT event */
+    uint32_t queue_length[INTERRUPT_NODES_POOL_CAPACITY + 1]; /* events queued, by queue length once added */
+};
+
+/* rolling window of the last completed VIs, and the current one */
+struct interrupt_stats
+{
+    struct interrupt_vi_stats vis[INTERRUPT_STATS_WINDOW + 1];
+    unsigned int current;   /* VI being recorded */
+    unsigned int completed; /* completed VIs in the window */
+};
+
 enum {
     INTR_UNSAFE_R4300 = 0x01,
     INTR_UNSAFE_RSP = 0x02,
@@ -212,6 +234,8 @@ struct cp0
     unsigned int count_per_op_denom_pot;
 
     struct tlb tlb;
+
+    struct interrupt_stats stats;
 };
 
 #ifndef NEW_DYNAREC
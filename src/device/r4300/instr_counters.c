@@ -22,81 +22,150 @@
 #include "instr_counters.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "api/callbacks.h"
-#include "api/m64p_types.h"
+#include "osal/files.h"
 
-/* various constants */
-static char instr_name[][10] =
+/* global variables */
+uint64_t instr_count[R4300_OPCODES_COUNT];
+uint64_t instr_page_count[0x100000];
+
+struct instr_total
 {
-    "reserved", "NI",     "J",      "JAL",    "BEQ",    "BNE",     "BLEZ",    "BGTZ",
-    "ADDI",     "ADDIU",  "SLTI",   "SLTIU",  "ANDI",   "ORI",     "XORI",    "LUI",
-    "BEQL",     "BNEL",   "BLEZL",  "BGTZL",  "DADDI",  "DADDIU",  "LDL",     "LDR",
-    "LB",       "LH",     "LW",     "LWL",    "LBU",    "LHU",     "LWU",     "LWR",
-    "SB",       "SH",     "SW",     "SWL",    "SWR",    "SDL",     "SDR",     "LWC1",
-    "LDC1",     "LD",     "LL",     "SWC1",   "SDC1",   "SD",      "SC",      "BLTZ",
-    "BGEZ",     "BLTZL",  "BGEZL",  "BLTZAL", "BGEZAL", "BLTZALL", "BGEZALL", "SLL",
-    "SRL",      "SRA",    "SLLV",   "SRLV",   "SRAV",   "JR",      "JALR",    "SYSCALL",
-    "MFHI",     "MTHI",   "MFLO",   "MTLO",   "DSLLV",  "DSRLV",   "DSRAV",   "MULT",
-    "MULTU",    "DIV",    "DIVU",   "DMULT",  "DMULTU", "DDIV",    "DDIVU",   "ADD",
-    "ADDU",     "SUB",    "SUBU",   "AND",    "OR",     "XOR",     "NOR",     "SLT",
-    "SLTU",     "DADD",   "DADDU",  "DSUB",   "DSUBU",  "DSLL",    "DSRL",    "DSRA",
-    "TEQ",      "DSLL32", "DSRL32", "DSRA32", "BC1F",   "BC1T",    "BC1FL",   "BC1TL",
-    "TLBWI",    "TLBP",   "TLBR",   "TLBWR",  "ERET",   "MFC0",    "MTC0",    "MFC1",
-    "DMFC1",    "CFC1",   "MTC1",   "DMTC1",  "CTC1",   "f.CVT",   "f.CMP",   "f.ADD",
-    "f.SUB",    "f.MUL",  "f.DIV",  "f.SQRT", "f.ABS",  "f.MOV",   "f.NEG",   "f.ROUND",
-    "f.TRUNC",  "f.CEIL", "f.FLOOR"
+    uint32_t index;
+    uint64_t count;
 };
 
-static unsigned int instr_type[131] =
+static int compare_totals(const void* a, const void* b)
 {
-    9, 10,  6,  6,  7,  7,  7,  7,  3,  3,  4,  4,  3,  4,  4,  0,
-    7,  7,  7,  7,  4,  4,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,  1,  1,  1,  1,  7,
-    7,  7,  7,  7,  7,  7,  7,  3,  3,  3,  3,  3,  3,  6,  6, 10,
-    2,  2,  2,  2,  4,  4,  4,  3,  3,  3,  3,  4,  4,  4,  4,  3,
-    3,  3,  3,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,
-    8,  4,  4,  4,  7,  7,  7,  7, 10, 10, 10, 10,  8,  2,  2,  2,
-    2,  2,  2,  2,  2,  2,  5,  5,  5,  5,  5,  5,  5,  2,  5,  5,
-    5,  5,  5
-};
+    uint64_t ca = ((const struct instr_total*)a)->count;
+    uint64_t cb = ((const struct instr_total*)b)->count;
+    return (ca < cb) - (ca > cb);
+}
 
-static char instr_typename[][20] =
+/* Copies the non zero counters sorted by decreasing count, returns their
+ * number or -1 if out of memory */
+static int sorted_totals(const uint64_t* counters, size_t size, struct instr_total** totals)
 {
-    "Load", "Store", "Data move/convert",
-    "32-bit math", "64-bit math", "Float Math",
-    "Jump", "Branch", "Exceptions",
-    "Reserved", "Other"
-};
+    size_t i;
+    int n = 0;
+
+    *totals = malloc((size + 1) * sizeof(**totals));
+    if (*totals == NULL)
+        return -1;
+
+    for (i = 0; i < size; ++i)
+    {
+        if (counters[i] != 0)
+        {
+            (*totals)[n].index = (uint32_t)i;
+            (*totals)[n].count = counters[i];
+            ++n;
+        }
+    }
+
+    qsort(*totals, n, sizeof(**totals), compare_totals);
+    return n;
+}
 
-/* global variable */
-unsigned int instr_count[132];
+/* global functions */
+void instr_counters_reset(void)
+{
+    memset(instr_count, 0, sizeof(instr_count));
+    memset(instr_page_count, 0, sizeof(instr_page_count));
+}
 
-/* global function */
 void instr_counters_print(void)
 {
-    size_t i;
-    unsigned int iTypeCount[11] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-    unsigned int iTotal = 0;
-    char line[128], param[24];
-    DebugMessage(M64MSG_INFO, "Instruction counters:");
-    line[0] = 0;
-    for (i = 0; i < 131; i++)
+    struct instr_total* totals;
+    uint64_t total = 0;
+    int i, n;
+
+    for (i = 0; i < R4300_OPCODES_COUNT; ++i)
+        total += instr_count[i];
+
+    n = sorted_totals(instr_count, R4300_OPCODES_COUNT, &totals);
+    DebugMessage(M64MSG_INFO, "Instruction counters (total instructions = %llu):", (unsigned long long)total);
+    for (i = 0; i < n && i < 40; ++i)
     {
-        sprintf(param, "%8s: %08i  ", instr_name[i], instr_count[i]);
-        strcat(line, param);
-        if (i % 5 == 4)
+        DebugMessage(M64MSG_INFO, "%12s: %5.2f%% (%llu)", g_r4300_opcodes[totals[i].index],
+                     (double)totals[i].count * 100.0 / total, (unsigned long long)totals[i].count);
+    }
+    free(totals);
+
+    n = sorted_totals(instr_page_count, 0x100000, &totals);
+    DebugMessage(M64MSG_INFO, "Hottest blocks:");
+    for (i = 0; i < n && i < 10; ++i)
+    {
+        DebugMessage(M64MSG_INFO, "    %08x: %5.2f%% (%llu)", totals[i].index << 12,
+                     (double)totals[i].count * 100.0 / total, (unsigned long long)totals[i].count);
+    }
+    free(totals);
+}
+
+m64p_error instr_counters_export(const char* path, m64p_export_format format)
+{
+    struct instr_total *opcodes, *pages;
+    int i, nopcodes, npages;
+    uint64_t total = 0;
+    FILE* file;
+
+    if (format != M64EXPORT_JSON && format != M64EXPORT_CSV)
+        return M64ERR_INPUT_INVALID;
+
+    /* sort a copy, the counters keep changing while the emulator runs */
+    nopcodes = sorted_totals(instr_count, R4300_OPCODES_COUNT, &opcodes);
+    npages = sorted_totals(instr_page_count, 0x100000, &pages);
+    if (nopcodes < 0 || npages < 0)
+    {
+        free(opcodes);
+        free(pages);
+        return M64ERR_NO_MEMORY;
+    }
+
+    file = osal_file_open(path, "w");
+    if (file == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Couldn't create instruction counters file %s", path);
+        free(opcodes);
+        free(pages);
+        return M64ERR_FILES;
+    }
+
+    for (i = 0; i < nopcodes; ++i)
+        total += opcodes[i].count;
+
+    if (format == M64EXPORT_JSON)
+    {
+        fprintf(file, "{\n  \"total\": %llu,\n  \"opcodes\": [", (unsigned long long)total);
+        for (i = 0; i < nopcodes; ++i)
         {
-            DebugMessage(M64MSG_INFO, "%s", line);
-            line[0] = 0;
+            fprintf(file, "%s\n    {\"opcode\": \"%s\", \"count\": %llu}", (i > 0) ? "," : "",
+                    g_r4300_opcodes[opcodes[i].index], (unsigned long long)opcodes[i].count);
         }
-        iTypeCount[instr_type[i]] += instr_count[i];
-        iTotal += instr_count[i];
+        fprintf(file, "\n  ],\n  \"blocks\": [");
+        for (i = 0; i < npages; ++i)
+        {
+            fprintf(file, "%s\n    {\"address\": \"0x%08x\", \"size\": 4096, \"count\": %llu}", (i > 0) ? "," : "",
+                    pages[i].index << 12, (unsigned long long)pages[i].count);
+        }
+        fprintf(file, "\n  ]\n}\n");
     }
-    DebugMessage(M64MSG_INFO, "Instruction type summary (total instructions = %i)", iTotal);
-    for (i = 0; i < 11; i++)
+    else
     {
-        DebugMessage(M64MSG_INFO, "%20s: %04.1f%% (%i)", instr_typename[i], (float) iTypeCount[i] * 100.0 / iTotal, iTypeCount[i]);
+        fprintf(file, "kind,name,count\n");
+        for (i = 0; i < nopcodes; ++i)
+            fprintf(file, "opcode,%s,%llu\n", g_r4300_opcodes[opcodes[i].index], (unsigned long long)opcodes[i].count);
+        for (i = 0; i < npages; ++i)
+            fprintf(file, "block,0x%08x,%llu\n", pages[i].index << 12, (unsigned long long)pages[i].count);
     }
+
+    fclose(file);
+    free(opcodes);
+    free(pages);
+
+    DebugMessage(M64MSG_INFO, "Instruction counters written to %s", path);
+    return M64ERR_SUCCESS;
 }
@@ -22,8 +22,31 @@
 #ifndef M64P_DEVICE_R4300_INSTR_COUNTERS_H
 #define M64P_DEVICE_R4300_INSTR_COUNTERS_H
 
-extern unsigned int instr_count[132];
+#include <stdint.h>
 
+#include "api/m64p_types.h"
+#include "device/r4300/idec.h"
+#include "osal/preproc.h"
+
+/* executed instructions per opcode */
+extern uint64_t instr_count[R4300_OPCODES_COUNT];
+
+/* executed instructions per 4KB page of r4300 addresses, which is the block
+ * compiled at once by the cached interpreter and the old recompiler */
+extern uint64_t instr_page_count[0x100000];
+
+static osal_inline void instr_counters_add(enum r4300_opcode opcode, uint32_t address)
+{
+    /* R4300_OPCODES_COUNT marks the not compiled and end of block entries */
+    if (opcode < R4300_OPCODES_COUNT)
+    {
+        ++instr_count[opcode];
+        ++instr_page_count[address >> 12];
+    }
+}
+
+void instr_counters_reset(void);
 void instr_counters_print(void);
+m64p_error instr_counters_export(const char* path, m64p_export_format format);
 
 #endif /* M64P_DEVICE_R4300_INSTR_COUNTERS_H */
@@ -44,6 +44,9 @@
 #include "device/rcp/ai/ai_controller.h"
 #include "device/rcp/vi/vi_controller.h"
 #include "main/main.h"
+#include "main/profile.h"
+#include "main/trace.h"
+#include "main/rewind.h"
 #include "main/savestates.h"
 
 
@@ -88,6 +91,124 @@ static void clear_pool(struct pool* p)
     p->index = 0;
 }
 
+/***************************************************************************
+ * Interrupt Statistics
+ **************************************************************************/
+
+/* event types in the order of the interrupt handlers, the hard reset is not
+ * an event */
+static const int l_interrupt_types[CP0_INTERRUPT_HANDLERS_COUNT] =
+{
+    VI_INT, COMPARE_INT, CHECK_INT, SI_INT, PI_INT, SPECIAL_INT,
+    AI_INT, SP_INT, DP_INT, HW2_INT, NMI_INT, 0,
+    RSP_DMA_EVT, DD_MC_INT, DD_BM_INT, DD_DV_INT
+};
+
+static const char* const l_interrupt_names[CP0_INTERRUPT_HANDLERS_COUNT] =
+{
+    "VI_INT", "COMPARE_INT", "CHECK_INT", "SI_INT", "PI_INT", "SPECIAL_INT",
+    "AI_INT", "SP_INT", "DP_INT", "HW2_INT", "NMI_INT", "HARD_RESET",
+    "RSP_DMA_EVT", "DD_MC_INT", "DD_BM_INT", "DD_DV_INT"
+};
+
+static size_t interrupt_index(int type)
+{
+    size_t i;
+
+    for (i = 0; i < CP0_INTERRUPT_HANDLERS_COUNT; ++i) {
+        if (l_interrupt_types[i] == type) {
+            return i;
+        }
+    }
+
+    return CP0_INTERRUPT_HANDLERS_COUNT;
+}
+
+static void stats_event_queued(struct cp0* cp0, int type)
+{
+    struct interrupt_vi_stats* vi = &cp0->stats.vis[cp0->stats.current];
+    size_t index = interrupt_index(type);
+
+    if (index < CP0_INTERRUPT_HANDLERS_COUNT) {
+        ++vi->scheduled[index];
+    }
+    ++vi->queue_length[cp0->q.pool.index];
+}
+
+static void stats_event_dispatched(struct cp0* cp0, const struct interrupt_event* event)
+{
+    struct interrupt_vi_stats* vi = &cp0->stats.vis[cp0->stats.current];
+    size_t index = interrupt_index(event->type);
+    int32_t late = (int32_t)(r4300_cp0_regs(cp0)[CP0_COUNT_REG] - event->count);
+
+    if (index >= CP0_INTERRUPT_HANDLERS_COUNT) {
+        return;
+    }
+
+    if (late < 0) {
+        late = 0;
+    }
+
+    ++vi->dispatched[index];
+    vi->latency[index] += (uint32_t)late;
+    if ((uint32_t)late > vi->max_latency[index]) {
+        vi->max_latency[index] = (uint32_t)late;
+    }
+}
+
+static void stats_next_vi(struct cp0* cp0)
+{
+    struct interrupt_stats* stats = &cp0->stats;
+
+    stats->current = (stats->current + 1) % (INTERRUPT_STATS_WINDOW + 1);
+    memset(&stats->vis[stats->current], 0, sizeof(stats->vis[0]));
+
+    if (stats->completed < INTERRUPT_STATS_WINDOW) {
+        ++stats->completed;
+    }
+}
+
+unsigned int get_interrupt_stats(const struct cp0* cp0, struct interrupt_vi_stats* total)
+{
+    const struct interrupt_stats* stats = &cp0->stats;
+    unsigned int i, k, slot = stats->current;
+
+    memset(total, 0, sizeof(*total));
+
+    for (i = 0; i < stats->completed; ++i)
+    {
+        const struct interrupt_vi_stats* vi;
+
+        slot = (slot + INTERRUPT_STATS_WINDOW) % (INTERRUPT_STATS_WINDOW + 1);
+        vi = &stats->vis[slot];
+
+        for (k = 0; k < CP0_INTERRUPT_HANDLERS_COUNT; ++k)
+        {
+            total->scheduled[k] += vi->scheduled[k];
+            total->dispatched[k] += vi->dispatched[k];
+            total->latency[k] += vi->latency[k];
+            if (vi->max_latency[k] > total->max_latency[k]) {
+                total->max_latency[k] = vi->max_latency[k];
+            }
+        }
+        for (k = 0; k <= INTERRUPT_NODES_POOL_CAPACITY; ++k) {
+            total->queue_length[k] += vi->queue_length[k];
+        }
+        total->checks += vi->checks;
+        total->check_raised += vi->check_raised;
+    }
+
+    return stats->completed;
+}
+
+const char* get_interrupt_name(size_t index)
+{
+    return (index < CP0_INTERRUPT_HANDLERS_COUNT)
+        ? l_interrupt_names[index]
+        : "";
+}
+
+
 /***************************************************************************
  * Interrupt Queue
  **************************************************************************/
@@ -186,6 +307,8 @@ void add_interrupt_event_count(struct cp0* cp0, int type, unsigned int count)
     }
     *cp0_next_interrupt = cp0->q.first->data.count;
     *cp0_cycle_count = cp0_regs[CP0_COUNT_REG] - cp0->q.first->data.count;
+
+    stats_event_queued(cp0, type);
 }
 
 void remove_interrupt_event(struct cp0* cp0)
@@ -327,6 +450,7 @@ void load_eventqueue_infos(struct cp0* cp0, const char *buf)
 
 void init_interrupt(struct cp0* cp0)
 {
+    memset(&cp0->stats, 0, sizeof(cp0->stats));
     clear_queue(&cp0->q);
     add_interrupt_event_count(cp0, SPECIAL_INT, 0x80000000);
     add_interrupt_event_count(cp0, COMPARE_INT, 0);
@@ -339,6 +463,8 @@ void r4300_check_interrupt(struct r4300_core* r4300, uint32_t cause_ip, int set_
     unsigned int* cp0_next_interrupt = r4300_cp0_next_interrupt(&r4300->cp0);
     int* cp0_cycle_count = r4300_cp0_cycle_count(&r4300->cp0);
 
+    ++r4300->cp0.stats.vis[r4300->cp0.stats.current].checks;
+
     if (set_cause) {
         cp0_regs[CP0_CAUSE_REG] = (cp0_regs[CP0_CAUSE_REG] | cause_ip) & ~CP0_CAUSE_EXCCODE_MASK;
     }
@@ -374,6 +500,9 @@ void r4300_check_interrupt(struct r4300_core* r4300, uint32_t cause_ip, int set_
             r4300->cp0.q.first = event;
 
         }
+
+        ++r4300->cp0.stats.vis[r4300->cp0.stats.current].check_raised;
+        stats_event_queued(&r4300->cp0, CHECK_INT);
     }
 }
 
@@ -523,13 +652,17 @@ void reset_hard_handler(void* opaque)
 }
 
 
+/* in the order of the interrupt handlers, see init_device */
 static void call_interrupt_handler(const struct cp0* cp0, size_t index)
 {
     assert(index < CP0_INTERRUPT_HANDLERS_COUNT);
 
     const struct interrupt_handler* handler = &cp0->interrupt_handlers[index];
 
+    trace_instant(l_interrupt_names[index], (cp0->q.first != NULL) ? cp0->q.first->data.count : 0);
+    timed_section_start(TIMED_SECTION_INTERRUPT);
     handler->callback(handler->opaque);
+    timed_section_end(TIMED_SECTION_INTERRUPT);
 }
 
 void gen_interrupt(struct r4300_core* r4300)
@@ -552,7 +685,15 @@ void gen_interrupt(struct r4300_core* r4300)
     {
         if (savestates_get_job() == savestates_job_load)
         {
+            timed_section_start(TIMED_SECTION_SAVESTATE);
             savestates_load();
+            timed_section_end(TIMED_SECTION_SAVESTATE);
+            return;
+        }
+
+        if (rewind_get_job() == rewind_job_restore)
+        {
+            rewind_restore();
             return;
         }
 
@@ -581,10 +722,13 @@ void gen_interrupt(struct r4300_core* r4300)
         return;
     }
 
+    stats_event_dispatched(&r4300->cp0, &r4300->cp0.q.first->data);
+
     switch (r4300->cp0.q.first->data.type)
     {
         case VI_INT:
             call_interrupt_handler(&r4300->cp0, 0);
+            stats_next_vi(&r4300->cp0);
             break;
 
         case COMPARE_INT:
@@ -667,7 +811,15 @@ void gen_interrupt(struct r4300_core* r4300)
     {
         if (savestates_get_job() == savestates_job_save)
         {
+            timed_section_start(TIMED_SECTION_SAVESTATE);
             savestates_save();
+            timed_section_end(TIMED_SECTION_SAVESTATE);
+            return;
+        }
+
+        if (rewind_get_job() == rewind_job_capture)
+        {
+            rewind_capture();
             return;
         }
     }
@@ -22,11 +22,13 @@
 #ifndef M64P_DEVICE_R4300_INTERRUPT_H
 #define M64P_DEVICE_R4300_INTERRUPT_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 struct r4300_core;
 struct cp0;
 struct interrupt_queue;
+struct interrupt_vi_stats;
 
 void init_interrupt(struct cp0* cp0);
 
@@ -44,6 +46,9 @@ int get_next_event_type(const struct interrupt_queue* q);
 unsigned int add_random_interrupt_time(struct r4300_core* r4300);
 void remove_interrupt_event(struct cp0* cp0);
 
+unsigned int get_interrupt_stats(const struct cp0* cp0, struct interrupt_vi_stats* total);
+const char* get_interrupt_name(size_t index);
+
 int save_eventqueue_infos(const struct cp0* cp0, char *buf);
 void load_eventqueue_infos(struct cp0* cp0, const char *buf);
 
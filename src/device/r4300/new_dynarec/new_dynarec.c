@@ -32,7 +32,9 @@
 #include "new_dynarec.h"
 #include "api/m64p_types.h"
 #include "api/callbacks.h"
+#include "main/footprint.h"
 #include "main/main.h"
+#include "main/profile.h"
 #include "main/rom.h"
 #include "device/memory/memory.h"
 #include "device/r4300/cached_interp.h"
@@ -41,8 +43,13 @@
 #include "device/r4300/interrupt.h"
 #include "device/r4300/tlb.h"
 #include "device/r4300/fpu.h"
+#if defined(COUNT_INSTR)
+#include "device/r4300/idec.h"
+#include "device/r4300/instr_counters.h"
+#endif
 #include "device/rcp/mi/mi_controller.h"
 #include "device/rcp/rsp/rsp_core.h"
+#include "device/rdram/rdram.h"
 
 #if !defined(WIN32)
 #include <sys/mman.h>
@@ -295,6 +302,7 @@ static struct ll_entry *jump_in[4096];
 static struct ll_entry *jump_dirty[4096];
 static struct ll_entry *jump_out[4096];
 static unsigned char restore_candidate[512];
+static int in_cc_interrupt;
 
 #if COUNT_NOTCOMPILEDS
 static int notcompiledCount = 0;
@@ -2868,6 +2876,10 @@ void invalidate_block(u_int block)
     do_clear_cache();
   #endif
 
+  // Report the write to the RDRAM dirty page tracking
+  if(block>=0x80000&&block<0x80800)
+    rdram_mark_dirty_page(&g_dev.rdram,(block&0x7FF)<<12);
+
   // Don't trap writes
   g_dev.r4300.cached_interp.invalid_code[block]=1;
   // If there is a valid TLB entry for this page, remove write protect
@@ -2875,6 +2887,8 @@ void invalidate_block(u_int block)
     assert(g_dev.r4300.cp0.tlb.LUT_r[block]==g_dev.r4300.cp0.tlb.LUT_w[block]);
     g_dev.r4300.new_dynarec_hot_state.memory_map[block]=((uintptr_t)g_dev.rdram.dram+(uintptr_t)((g_dev.r4300.cp0.tlb.LUT_w[block]&0xFFFFF000)-0x80000000)-(block<<12))>>2;
     u_int real_block=g_dev.r4300.cp0.tlb.LUT_w[block]>>12;
+    if(real_block>=0x80000&&real_block<0x80800)
+      rdram_mark_dirty_page(&g_dev.rdram,(real_block&0x7FF)<<12);
     g_dev.r4300.cached_interp.invalid_code[real_block]=1;
     if(real_block>=0x80000&&real_block<0x80800) g_dev.r4300.new_dynarec_hot_state.memory_map[real_block]=((uintptr_t)g_dev.rdram.dram-(uintptr_t)0x80000000)>>2;
   }
@@ -2940,6 +2954,49 @@ void invalidate_cached_code_new_dynarec(struct r4300_core* r4300, uint32_t addre
     }
 }
 
+// Trap writes to the RDRAM pages set in the bitmap so that
+// invalidate_block reports them to the dirty page tracking.
+void new_dynarec_trap_rdram_writes(const uint32_t* pages, size_t count)
+{
+  u_int page;
+  if(count>2048) count=2048;
+  for(page=0;page<count;page++) {
+    if(pages[page>>5]&(1u<<(page&31))) {
+      g_dev.r4300.cached_interp.invalid_code[0x80000+page]=0;
+      g_dev.r4300.new_dynarec_hot_state.memory_map[0x80000+page]|=WRITE_PROTECT;
+    }
+  }
+}
+
+// Host addresses are returned in the executable mapping of the cache
+size_t new_dynarec_get_entries(struct new_dynarec_entry* entries, size_t max,
+                               uintptr_t* cache_begin, uintptr_t* cache_end)
+{
+  struct ll_entry *head;
+  size_t count=0;
+  u_int page;
+  *cache_begin=(uintptr_t)base_addr_rx;
+  *cache_end=(uintptr_t)base_addr_rx+(1<<TARGET_SIZE_2);
+  for(page=0;page<4096;page++) {
+    for(head=jump_in[page];head!=NULL;head=head->next) {
+      if(count<max) {
+        entries[count].host=(uintptr_t)head->addr-(uintptr_t)base_addr+(uintptr_t)base_addr_rx;
+        entries[count].vaddr=head->vaddr;
+      }
+      count++;
+    }
+    // Dirty entries point to the verification stub, the block follows
+    for(head=jump_dirty[page];head!=NULL;head=head->next) {
+      if(count<max) {
+        entries[count].host=(uintptr_t)head->clean_addr-(uintptr_t)base_addr+(uintptr_t)base_addr_rx;
+        entries[count].vaddr=head->vaddr;
+      }
+      count++;
+    }
+  }
+  return count;
+}
+
 // If a code block was found to be unmodified (bit was set in
 // restore_candidate) and it remains unmodified (bit is clear
 // in invalid_code) then move the entries for that 4K page from
@@ -3037,7 +3094,50 @@ void dynarec_gen_interrupt(void)
         *candidate = 0;
     }
 
+    in_cc_interrupt = 1;
     gen_interrupt(r4300);
+    in_cc_interrupt = 0;
+}
+
+// Flush the translation cache and give its memory back to the system.
+// Only done from cc_interrupt, which resumes at pcaddr once the
+// registers have been written back, so no compiled code is returned to.
+int new_dynarec_release_code(void)
+{
+  struct new_dynarec_hot_state* state = &g_dev.r4300.new_dynarec_hot_state;
+  int n;
+
+  if(!in_cc_interrupt) return 0;
+
+  invalidate_all_pages();
+  for(n=0;n<4096;n++) ll_clear(jump_in+n);
+  for(n=0;n<4096;n++) ll_clear(jump_out+n);
+  for(n=0;n<4096;n++) ll_clear(jump_dirty+n);
+  assert(copy_size==0);
+  for(n=0;n<65536;n++)
+    hash_table[n][0]=hash_table[n][1]=NULL;
+  memset(state->mini_ht,-1,sizeof(state->mini_ht));
+  memset(restore_candidate,0,sizeof(restore_candidate));
+  out=(u_char *)base_addr;
+  expirep=16384;
+  literalcount=0;
+
+  footprint_discard(base_addr,1<<TARGET_SIZE_2);
+  arch_init();
+  #if NEW_DYNAREC >= NEW_DYNAREC_ARM
+  cache_flush((char *)base_addr_rx,(char *)base_addr_rx+(1<<TARGET_SIZE_2));
+  #endif
+
+  generic_jump_to(&g_dev.r4300, state->pcaddr);
+  return 1;
+}
+
+void new_dynarec_footprint(m64p_memory_footprint* code_cache, m64p_memory_footprint* tables)
+{
+  footprint_add(code_cache,base_addr,1<<TARGET_SIZE_2);
+  footprint_add_heap(code_cache,copy_size);
+  footprint_add(tables,g_dev.r4300.new_dynarec_hot_state.memory_map,sizeof(g_dev.r4300.new_dynarec_hot_state.memory_map));
+  footprint_add(tables,hash_table,sizeof(hash_table));
 }
 
 /**** Register allocation ****/
@@ -6936,6 +7036,22 @@ static void syscall_assemble(int i,struct regstat *i_regs)
   emit_jmp((intptr_t)jump_syscall);
 }
 
+#if defined(COUNT_INSTR) && !defined(RECOMP_DBG)
+// Count the instruction on entry, with the delay slot of branches as it is
+// assembled together with the branch
+static void count_instr(int i)
+{
+#if NEW_DYNAREC == NEW_DYNAREC_X86 || NEW_DYNAREC == NEW_DYNAREC_X64
+  int j,n=1;
+  if(itype[i]==UJUMP||itype[i]==RJUMP||itype[i]==CJUMP||itype[i]==SJUMP||itype[i]==FJUMP) n=2;
+  for(j=i;j<i+n&&j<slen;j++) {
+    emit_incmem64((intptr_t)&instr_count[r4300_get_idec(source[j])->opcode]);
+    emit_incmem64((intptr_t)&instr_page_count[(start+j*4)>>12]);
+  }
+#endif
+}
+#endif
+
 static void ds_assemble(int i,struct regstat *i_regs)
 {
   is_delayslot=1;
@@ -8625,6 +8741,9 @@ static void pagespan_ds(void)
 void new_dynarec_init(void)
 {
   DebugMessage(M64MSG_INFO, "Init new dynarec");
+#if defined(COUNT_INSTR) && NEW_DYNAREC != NEW_DYNAREC_X86 && NEW_DYNAREC != NEW_DYNAREC_X64
+  DebugMessage(M64MSG_WARNING, "Instruction counters are not implemented for this dynarec");
+#endif
 
 #if defined(RECOMPILER_DEBUG) && !defined(RECOMP_DBG)
   recomp_dbg_init();
@@ -8806,6 +8925,9 @@ int new_recompile_block(int addr)
     exit(1);
   }
 
+  g_dev.r4300.compiled_blocks++;
+  timed_section_start(TIMED_SECTION_COMPILER);
+
   /* Pass 1: disassemble */
   /* Pass 2: register dependencies, branch targets */
   /* Pass 3: register allocation */
@@ -11532,6 +11654,9 @@ int new_recompile_block(int addr)
       // branch target entry point
       instr_addr[i]=(uintptr_t)out;
       assem_debug("<->");
+      #if defined(COUNT_INSTR) && !defined(RECOMP_DBG)
+      count_instr(i);
+      #endif
       // load regs
       if(regs[i].regmap_entry[HOST_CCREG]==CCREG&&regs[i].regmap[HOST_CCREG]!=CCREG)
         wb_register(CCREG,regs[i].regmap_entry,regs[i].wasdirty,regs[i].was32);
@@ -11880,5 +12005,6 @@ int new_recompile_block(int addr)
     }
     expirep=(expirep+1)&65535;
   }
+  timed_section_end(TIMED_SECTION_COMPILER);
   return 0;
 }
@@ -27,6 +27,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "api/m64p_types.h"
+
 #define NEW_DYNAREC_X86 1
 #define NEW_DYNAREC_X64 2
 #define NEW_DYNAREC_ARM 3
@@ -86,10 +88,26 @@ struct new_dynarec_hot_state
 #endif
 };
 
+/* entry point of a compiled block, see new_dynarec_get_entries */
+struct new_dynarec_entry
+{
+    uintptr_t host;
+    uint32_t vaddr;
+};
+
 extern unsigned int stop_after_jal;
 extern unsigned int using_tlb;
 
 void invalidate_cached_code_new_dynarec(struct r4300_core* r4300, uint32_t address, size_t size);
+void new_dynarec_trap_rdram_writes(const uint32_t* pages, size_t count);
+/* Copies up to max entry points of the blocks in the translation cache and
+ * the host address range of the cache, returns the number of entry points. */
+size_t new_dynarec_get_entries(struct new_dynarec_entry* entries, size_t max,
+                               uintptr_t* cache_begin, uintptr_t* cache_end);
+/* Drops the whole translation cache, returns 0 if not at a point where
+ * the execution can resume without it (see dynarec_gen_interrupt). */
+int new_dynarec_release_code(void);
+void new_dynarec_footprint(m64p_memory_footprint* code_cache, m64p_memory_footprint* tables);
 void new_dynarec_init(void);
 void new_dyna_start(void);
 void new_dynarec_cleanup(void);
@@ -59,6 +59,8 @@
 #define invalidate_cached_code_new_dynarec      recomp_dbg_invalidate_cached_code_new_dynarec
 #define new_dynarec_cleanup                     recomp_dbg_new_dynarec_cleanup
 #define new_dynarec_init                        recomp_dbg_new_dynarec_init
+#define new_dynarec_release_code                recomp_dbg_new_dynarec_release_code
+#define new_dynarec_footprint                   recomp_dbg_new_dynarec_footprint
 #define new_recompile_block                     recomp_dbg_new_recompile_block
 #define ERET_new                                recomp_dbg_ERET_new
 #define dynarec_gen_interrupt                   recomp_dbg_dynarec_gen_interrupt
@@ -2487,6 +2487,28 @@ static void emit_writebyte_indexed_tlb(int rt, int addr, int rs, int map)
     }
   }
 }
+#if defined(COUNT_INSTR)
+// Increment a 64-bit counter without changing any register or the flags
+static void emit_incmem64(intptr_t addr)
+{
+  assert((intptr_t)addr-(intptr_t)out>=-2147483648LL&&(intptr_t)addr-(intptr_t)out<2147483647LL);
+  assem_debug("incq %llx",addr);
+  output_byte(0x50); // push %rax
+  output_rex(1,0,0,0);
+  output_byte(0x8B); // mov addr,%rax
+  output_modrm(0,5,0);
+  output_w32(addr-(intptr_t)out-4); // Note: rip-relative in 64-bit mode
+  output_rex(1,0,0,0);
+  output_byte(0x8D); // lea 1(%rax),%rax
+  output_modrm(1,0,0);
+  output_byte(1);
+  output_rex(1,0,0,0);
+  output_byte(0x89); // mov %rax,addr
+  output_modrm(0,5,0);
+  output_w32(addr-(intptr_t)out-4); // Note: rip-relative in 64-bit mode
+  output_byte(0x58); // pop %rax
+}
+#endif
 static void emit_writeword_imm(int imm, intptr_t addr)
 {
   assert((intptr_t)addr-(intptr_t)out>=-2147483648LL&&(intptr_t)addr-(intptr_t)out<2147483647LL);
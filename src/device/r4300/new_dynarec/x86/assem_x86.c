@@ -2246,6 +2246,23 @@ static void emit_writebyte_indexed_tlb(int rt, int addr, int rs, int map)
     emit_xchg(EAX,rt);
   }
 }
+#if defined(COUNT_INSTR)
+// Increment a 64-bit counter without changing any register or the flags
+static void emit_incmem64(int addr)
+{
+  assem_debug("incq %x",addr);
+  output_byte(0x9C); // pushf
+  output_byte(0x83); // addl $1,addr
+  output_modrm(0,5,0);
+  output_w32(addr);
+  output_byte(1);
+  output_byte(0x83); // adcl $0,addr+4
+  output_modrm(0,5,2);
+  output_w32(addr+4);
+  output_byte(0);
+  output_byte(0x9D); // popf
+}
+#endif
 static void emit_writeword_imm(int imm, int addr)
 {
   assem_debug("movl $%x,%x",imm,addr);
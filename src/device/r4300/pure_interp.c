@@ -32,6 +32,11 @@
 #include "device/r4300/r4300_core.h"
 #include "osal/preproc.h"
 
+#if defined(COUNT_INSTR)
+#include "device/r4300/idec.h"
+#include "device/r4300/instr_counters.h"
+#endif
+
 #ifdef DBG
 #include "debugger/dbg_debugger.h"
 #endif
@@ -169,6 +174,10 @@ void InterpretOpcode(struct r4300_core* r4300)
 		return;
 	uint32_t op = *op_address;
 
+#if defined(COUNT_INSTR)
+	instr_counters_add(r4300_get_idec(op)->opcode, *r4300_pc(r4300));
+#endif
+
 	switch ((op >> 26) & 0x3F) {
 	case 0: /* SPECIAL prefix */
 		switch (op & 0x3F) {
@@ -34,7 +34,9 @@
 #ifdef DBG
 #include "debugger/dbg_debugger.h"
 #endif
+#include "main/footprint.h"
 #include "main/main.h"
+#include "main/memtrace.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -64,6 +66,7 @@ void init_r4300(struct r4300_core* r4300, struct memory* mem, struct mi_controll
     r4300->rdram = rdram;
     r4300->randomize_interrupt = randomize_interrupt;
     r4300->start_address = start_address;
+    r4300->compiled_blocks = 0;
     srand((unsigned int) time(NULL));
 }
 
@@ -138,7 +141,7 @@ void run_r4300(struct r4300_core* r4300)
 
     /* clear instruction counters */
 #if defined(COUNT_INSTR)
-    memset(instr_count, 0, 131*sizeof(instr_count[0]));
+    instr_counters_reset();
 #endif
 
     if (r4300->emumode == EMUMODE_PURE_INTERPRETER)
@@ -205,8 +208,7 @@ void run_r4300(struct r4300_core* r4300)
 
     /* print instruction counts */
 #if defined(COUNT_INSTR)
-    if (r4300->emumode == EMUMODE_DYNAREC)
-        instr_counters_print();
+    instr_counters_print();
 #endif
 #ifdef OSAL_SSE
     //Restore FTZ/DAZ mode
@@ -297,12 +299,25 @@ uint32_t *fast_mem_access(struct r4300_core* r4300, uint32_t address)
     return mem_base_u32(r4300->mem->base, address);
 }
 
+static unsigned int mask_size(uint64_t mask)
+{
+    unsigned int size = 0;
+
+    for (; mask != 0; mask >>= 8) {
+        size += ((mask & 0xff) != 0);
+    }
+
+    return size;
+}
+
 /* Read aligned word from memory.
  * address may not be word-aligned for byte or hword accesses.
  * Alignment is taken care of when calling mem handler.
  */
 int r4300_read_aligned_word(struct r4300_core* r4300, uint32_t address, uint32_t* value)
 {
+    uint32_t vaddr = address;
+
     if ((address & UINT32_C(0xc0000000)) != UINT32_C(0x80000000)) {
         address = virtual_to_physical_address(r4300, address, 0);
         if (address == 0) {
@@ -314,12 +329,17 @@ int r4300_read_aligned_word(struct r4300_core* r4300, uint32_t address, uint32_t
 
     mem_read32(mem_get_handler(r4300->mem, address), address & ~UINT32_C(3), value);
 
+    if (g_memtrace_enabled) {
+        memtrace_record(MEMTRACE_READ, *r4300_pc(r4300), vaddr & ~UINT32_C(3), address, 4, *value);
+    }
+
     return 1;
 }
 
 /* Read aligned dword from memory */
 int r4300_read_aligned_dword(struct r4300_core* r4300, uint32_t address, uint64_t* value)
 {
+    uint32_t vaddr = address;
     uint32_t w[2];
 
     /* XXX: unaligned dword accesses should trigger a address error,
@@ -344,6 +364,10 @@ int r4300_read_aligned_dword(struct r4300_core* r4300, uint32_t address, uint64_
 
     *value = ((uint64_t)w[0] << 32) | w[1];
 
+    if (g_memtrace_enabled) {
+        memtrace_record(MEMTRACE_READ, *r4300_pc(r4300), vaddr, address, 8, *value);
+    }
+
     return 1;
 }
 
@@ -353,6 +377,8 @@ int r4300_read_aligned_dword(struct r4300_core* r4300, uint32_t address, uint64_
  */
 int r4300_write_aligned_word(struct r4300_core* r4300, uint32_t address, uint32_t value, uint32_t mask)
 {
+    uint32_t vaddr = address;
+
     if ((address & UINT32_C(0xc0000000)) != UINT32_C(0x80000000)) {
 
         invalidate_r4300_cached_code(r4300, address, 4);
@@ -366,6 +392,10 @@ int r4300_write_aligned_word(struct r4300_core* r4300, uint32_t address, uint32_
     invalidate_r4300_cached_code(r4300, address, 4);
     invalidate_r4300_cached_code(r4300, address ^ UINT32_C(0x20000000), 4);
 
+    if (g_memtrace_enabled) {
+        memtrace_record(MEMTRACE_WRITE, *r4300_pc(r4300), vaddr, address & UINT32_C(0x1fffffff), mask_size(mask), value & mask);
+    }
+
     address &= UINT32_C(0x1ffffffc);
 
     mem_write32(mem_get_handler(r4300->mem, address), address & ~UINT32_C(3), value, mask);
@@ -376,6 +406,8 @@ int r4300_write_aligned_word(struct r4300_core* r4300, uint32_t address, uint32_
 /* Write aligned dword to memory */
 int r4300_write_aligned_dword(struct r4300_core* r4300, uint32_t address, uint64_t value, uint64_t mask)
 {
+    uint32_t vaddr = address;
+
     /* XXX: unaligned dword accesses should trigger a address error,
      * but inaccurate timing of the core can lead to unaligned address on reset
      * so just emit a warning and keep going */
@@ -396,6 +428,10 @@ int r4300_write_aligned_dword(struct r4300_core* r4300, uint32_t address, uint64
     invalidate_r4300_cached_code(r4300, address, 8);
     invalidate_r4300_cached_code(r4300, address ^ UINT32_C(0x20000000), 8);
 
+    if (g_memtrace_enabled) {
+        memtrace_record(MEMTRACE_WRITE, *r4300_pc(r4300), vaddr, address & UINT32_C(0x1fffffff), mask_size(mask), value & mask);
+    }
+
     address &= UINT32_C(0x1ffffffc);
 
     const struct mem_handler* handler = mem_get_handler(r4300->mem, address);
@@ -422,6 +458,70 @@ void invalidate_r4300_cached_code(struct r4300_core* r4300, uint32_t address, si
     }
 }
 
+void trap_r4300_rdram_writes(struct r4300_core* r4300, const uint32_t* pages, size_t count)
+{
+#ifdef NEW_DYNAREC
+    if (r4300->emumode == EMUMODE_DYNAREC)
+    {
+        new_dynarec_trap_rdram_writes(pages, count);
+    }
+#else
+    (void)pages;
+    (void)count;
+
+    if (r4300->recomp.fast_memory)
+    {
+        r4300->recomp.fast_memory = 0;
+        invalidate_r4300_cached_code(r4300, 0, 0);
+    }
+#endif
+}
+
+int release_r4300_cached_code(struct r4300_core* r4300)
+{
+    switch (r4300->emumode)
+    {
+    case EMUMODE_PURE_INTERPRETER:
+        return 1;
+
+#ifdef NEW_DYNAREC
+    case EMUMODE_DYNAREC:
+        return new_dynarec_release_code();
+#endif
+
+    default:
+        /* the jump out of a delay slot may come back to a previous block */
+        if (r4300->delay_slot)
+            return 0;
+
+        release_cached_code_hacktarux(r4300);
+        return 1;
+    }
+}
+
+void r4300_footprint(struct r4300_core* r4300, m64p_memory_footprint* entries)
+{
+    m64p_memory_footprint* code = NULL;
+
+    footprint_add(&entries[FOOTPRINT_TLB], r4300->cp0.tlb.LUT_r, sizeof(r4300->cp0.tlb.LUT_r));
+    footprint_add(&entries[FOOTPRINT_TLB], r4300->cp0.tlb.LUT_w, sizeof(r4300->cp0.tlb.LUT_w));
+    footprint_add(&entries[FOOTPRINT_INVALID_CODE], r4300->cached_interp.invalid_code, sizeof(r4300->cached_interp.invalid_code));
+
+#ifdef NEW_DYNAREC
+    if (r4300->emumode == EMUMODE_DYNAREC)
+    {
+        new_dynarec_footprint(&entries[FOOTPRINT_CODE_CACHE], &entries[FOOTPRINT_MEMORY_MAP]);
+    }
+#elif defined(DYNAREC)
+    if (r4300->emumode == EMUMODE_DYNAREC)
+    {
+        code = &entries[FOOTPRINT_CODE_CACHE];
+    }
+#endif
+
+    blocks_footprint(&r4300->cached_interp, &entries[FOOTPRINT_PRECOMP_BLOCKS], code);
+}
+
 
 void generic_jump_to(struct r4300_core* r4300, uint32_t address)
 {
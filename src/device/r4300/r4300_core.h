@@ -29,6 +29,8 @@
 #include <stdio.h>
 #endif
 
+#include "api/m64p_types.h"
+
 #include "cp0.h"
 #include "cp1.h"
 #include "cp2.h"
@@ -200,6 +202,9 @@ struct r4300_core
     uint32_t randomize_interrupt;
 
     uint32_t start_address;
+
+    /* blocks compiled by the cached interpreter or the recompilers */
+    uint64_t compiled_blocks;
 };
 
 #define R4300_KSEG0 UINT32_C(0x80000000)
@@ -247,6 +252,25 @@ int r4300_write_aligned_dword(struct r4300_core* r4300, uint32_t address, uint64
  */
 void invalidate_r4300_cached_code(struct r4300_core* r4300, uint32_t address, size_t size);
 
+/* Make sure that r4300 writes to the 4KB RDRAM pages set in the pages bitmap
+ * are reported to the rdram dirty page tracking, either by disabling
+ * direct RDRAM accesses or by trapping writes to these pages.
+ */
+void trap_r4300_rdram_writes(struct r4300_core* r4300, const uint32_t* pages, size_t count);
+
+/* Drop the cached code of the r4300 emulator, which is regenerated as it
+ * gets executed again. Must be called from the emulation thread, between
+ * two instructions (e.g. from an interrupt handler).
+ *
+ * Returns 0 if the current emulator cannot drop its code at this point,
+ * in which case the caller should retry on a later interrupt.
+ */
+int release_r4300_cached_code(struct r4300_core* r4300);
+
+/* Account the r4300 emulator buffers to the footprint entries
+ * (see main/footprint.h) */
+void r4300_footprint(struct r4300_core* r4300, m64p_memory_footprint* entries);
+
 /* Jump to the given address. This works for all r4300 emulator, but is slower.
  * Use this for common code which can be executed from any r4300 emulator. */
 void generic_jump_to(struct r4300_core* r4300, unsigned int address);
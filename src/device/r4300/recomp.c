@@ -43,9 +43,7 @@
 #include "device/r4300/recomp_types.h"
 #include "device/r4300/tlb.h"
 #include "main/main.h"
-#if defined(PROFILE)
 #include "main/profile.h"
-#endif
 
 #if defined(__x86_64__)
   #include "x86_64/regcache.h"
@@ -69,6 +67,9 @@ void genfin_block(struct r4300_core* r4300);
 #ifdef COMPARE_CORE
 void gendebug(struct r4300_core* r4300);
 #endif
+#if defined(COUNT_INSTR)
+void gencount_instr(struct r4300_core* r4300, enum r4300_opcode opcode);
+#endif
 
 void gen_RESERVED(struct r4300_core* r4300);
 
@@ -455,12 +456,12 @@ static void (*const recomp_funcs[R4300_OPCODES_COUNT])(struct r4300_core* r4300)
 void dynarec_init_block(struct r4300_core* r4300, uint32_t address)
 {
     int i, length, already_exist = 1;
-#if defined(PROFILE)
     timed_section_start(TIMED_SECTION_COMPILER);
-#endif
 
     struct precomp_block** block = &r4300->cached_interp.blocks[address >> 12];
 
+    ++r4300->compiled_blocks;
+
     /* allocate block */
     if (*block == NULL) {
         *block = malloc(sizeof(struct precomp_block));
@@ -545,6 +546,9 @@ void dynarec_init_block(struct r4300_core* r4300, uint32_t address)
             gendebug(r4300);
 #endif
             r4300->recomp.dst->ops = dynarec_notcompiled;
+#if defined(COUNT_INSTR)
+            r4300->recomp.dst->opcode = R4300_OPCODES_COUNT;
+#endif
             gennotcompiled(r4300);
         }
 #if defined(PROFILE_R4300)
@@ -600,9 +604,7 @@ void dynarec_init_block(struct r4300_core* r4300, uint32_t address)
             dynarec_init_block(r4300, alt_addr);
         }
     }
-#if defined(PROFILE)
     timed_section_end(TIMED_SECTION_COMPILER);
-#endif
 }
 
 void dynarec_free_block(struct precomp_block* block)
@@ -627,9 +629,7 @@ void dynarec_recompile_block(struct r4300_core* r4300, const uint32_t* iw, struc
     int block_start_in_tlb = ((block->start & UINT32_C(0xc0000000)) != UINT32_C(0x80000000));
     int block_not_in_tlb = (block->start >= UINT32_C(0xc0000000) || block->end < UINT32_C(0x80000000));
 
-#if defined(PROFILE)
     timed_section_start(TIMED_SECTION_COMPILER);
-#endif
 
     length = get_block_length(block);
     length2 = length - 2 + (length >> 2);
@@ -681,6 +681,10 @@ void dynarec_recompile_block(struct r4300_core* r4300, const uint32_t* iw, struc
 
         /* decode instruction */
         opcode = r4300_decode(r4300->recomp.dst, r4300, r4300_get_idec(iw[i]), iw[i], iw[i+1], block);
+#if defined(COUNT_INSTR)
+        r4300->recomp.dst->opcode = opcode;
+        gencount_instr(r4300, opcode);
+#endif
         recomp_funcs[opcode](r4300);
 
         if (r4300->recomp.delay_slot_compiled)
@@ -757,9 +761,7 @@ void dynarec_recompile_block(struct r4300_core* r4300, const uint32_t* iw, struc
     r4300->recomp.pfProfile = NULL;
 #endif
 
-#if defined(PROFILE)
     timed_section_end(TIMED_SECTION_COMPILER);
-#endif
 }
 
 /**********************************************************************
@@ -776,6 +778,10 @@ void recompile_opcode(struct r4300_core* r4300)
 
     uint32_t iw = r4300->recomp.src;
     enum r4300_opcode opcode = r4300_decode(r4300->recomp.dst, r4300, r4300_get_idec(iw), iw, 1, r4300->recomp.dst_block);
+#if defined(COUNT_INSTR)
+    r4300->recomp.dst->opcode = opcode;
+    gencount_instr(r4300, opcode);
+#endif
 
     switch(opcode)
     {
@@ -68,6 +68,9 @@ struct precomp_instr
         } cf;
     } f;
     uint32_t addr; /* word-aligned instruction address in r4300 address space */
+#if defined(COUNT_INSTR)
+    uint16_t opcode; /* decoded enum r4300_opcode, for the instruction counters */
+#endif
 
     /* these fields are recomp specific */
     unsigned int local_addr; /* byte offset to start of corresponding x86_64 instructions, from start of code block */
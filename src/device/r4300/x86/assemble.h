@@ -382,6 +382,22 @@ static osal_inline void inc_m32(unsigned int *m32)
     put32((unsigned int)(m32));
 }
 
+static osal_inline void add_m32_imm8(unsigned int *m32, unsigned char imm8)
+{
+    put8(0x83);
+    put8(0x05);
+    put32((unsigned int)(m32));
+    put8(imm8);
+}
+
+static osal_inline void adc_m32_imm8(unsigned int *m32, unsigned char imm8)
+{
+    put8(0x83);
+    put8(0x15);
+    put32((unsigned int)(m32));
+    put8(imm8);
+}
+
 static osal_inline void cmp_m32_imm32(unsigned int *m32, unsigned int imm32)
 {
     put8(0x81);
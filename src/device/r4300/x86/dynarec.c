@@ -39,6 +39,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined(COUNT_INSTR)
+#include "device/r4300/instr_counters.h"
+#endif
+
 
 /* These are constants with addresses so that FLDCW can read them */
 static const uint16_t trunc_mode = 0xf3f;
@@ -217,6 +221,20 @@ void gendebug(struct r4300_core* r4300)
 }
 #endif
 
+#if defined(COUNT_INSTR)
+static void geninc_m64(uint64_t *m64)
+{
+    add_m32_imm8((unsigned int*)m64, 1);
+    adc_m32_imm8((unsigned int*)m64 + 1, 0);
+}
+
+void gencount_instr(struct r4300_core* r4300, enum r4300_opcode opcode)
+{
+    geninc_m64(&instr_count[opcode]);
+    geninc_m64(&instr_page_count[r4300->recomp.dst->addr >> 12]);
+}
+#endif
+
 void genni(struct r4300_core* r4300)
 {
     gencallinterp(r4300, (unsigned int)cached_interp_NI, 0);
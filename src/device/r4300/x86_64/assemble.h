@@ -559,6 +559,16 @@ static osal_inline void inc_m32rel(unsigned int *m32)
     put32(offset);
 }
 
+static osal_inline void inc_m64rel(uint64_t *m64)
+{
+    int offset = rel_r15_offset(m64, "inc_m64rel");
+
+    put8(0x49);
+    put8(0xFF);
+    put8(0x87);
+    put32(offset);
+}
+
 static osal_inline void cmp_m32rel_imm32(unsigned int *m32, unsigned int imm32)
 {
     int offset = rel_r15_offset(m32, "cmp_m32rel_imm32");
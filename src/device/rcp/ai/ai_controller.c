@@ -24,12 +24,15 @@
 #include <string.h>
 
 #include "backends/api/audio_out_backend.h"
+#include "device/device.h"
 #include "device/memory/memory.h"
 #include "device/r4300/r4300_core.h"
 #include "device/rcp/mi/mi_controller.h"
 #include "device/rcp/ri/ri_controller.h"
 #include "device/rcp/vi/vi_controller.h"
 #include "device/rdram/rdram.h"
+#include "main/memtrace.h"
+#include "main/profile.h"
 
 
 #define AI_STATUS_BUSY UINT32_C(0x40000000)
@@ -93,6 +96,8 @@ static void do_dma(struct ai_controller* ai, struct ai_dma* dma)
     else
         ai->delayed_carry = 0;
 
+    memtrace_dma(MEMTRACE_DMA_AI, dma->address, MM_AI_REGS, dma->length);
+
     /* schedule end of dma event */
     cp0_update_count(ai->mi->r4300);
     add_interrupt_event(&ai->mi->r4300->cp0, AI_INT, dma->duration);
@@ -116,7 +121,9 @@ static void fifo_push(struct ai_controller* ai)
         ai->fifo[0].duration = duration;
         ai->regs[AI_STATUS_REG] |= AI_STATUS_BUSY;
 
+        timed_section_start(TIMED_SECTION_DMA_AI);
         do_dma(ai, &ai->fifo[0]);
+        timed_section_end(TIMED_SECTION_DMA_AI);
     }
 }
 
@@ -129,7 +136,9 @@ static void fifo_pop(struct ai_controller* ai)
         ai->fifo[0].duration = ai->fifo[1].duration;
         ai->regs[AI_STATUS_REG] &= ~AI_STATUS_FULL;
 
+        timed_section_start(TIMED_SECTION_DMA_AI);
         do_dma(ai, &ai->fifo[0]);
+        timed_section_end(TIMED_SECTION_DMA_AI);
     }
     else
     {
@@ -34,6 +34,8 @@
 #include "device/rcp/mi/mi_controller.h"
 #include "device/rcp/rdp/rdp_core.h"
 #include "device/rcp/ri/ri_controller.h"
+#include "main/memtrace.h"
+#include "main/profile.h"
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
@@ -53,6 +55,9 @@ static void dma_pi_read(struct pi_controller* pi)
     if (!validate_pi_request(pi))
         return;
 
+    /* RSP task may still be using RDRAM */
+    wait_rsp_task(pi->dp->sp);
+
     uint32_t cart_addr = pi->regs[PI_CART_ADDR_REG] & ~UINT32_C(1);
     uint32_t dram_addr = pi->regs[PI_DRAM_ADDR_REG] & 0xfffffe;
     uint32_t length = (pi->regs[PI_RD_LEN_REG] & UINT32_C(0x00ffffff)) + 1;
@@ -75,6 +80,8 @@ static void dma_pi_read(struct pi_controller* pi)
         length += 1;
     unsigned int cycles = handler->dma_read(opaque, dram, dram_addr, cart_addr, length);
 
+    memtrace_dma(MEMTRACE_DMA_PI, dram_addr, cart_addr, length);
+
     /* Mark DMA as busy */
     pi->regs[PI_STATUS_REG] |= PI_STATUS_DMA_BUSY;
     /* Update PI_DRAM_ADDR_REG and PI_CART_ADDR_REG */
@@ -91,6 +98,9 @@ static void dma_pi_write(struct pi_controller* pi)
     if (!validate_pi_request(pi))
         return;
 
+    /* RSP task may still be using RDRAM */
+    wait_rsp_task(pi->dp->sp);
+
     uint32_t cart_addr = pi->regs[PI_CART_ADDR_REG] & ~UINT32_C(1);
     uint32_t dram_addr = pi->regs[PI_DRAM_ADDR_REG] & 0xfffffe;
     uint32_t length = (pi->regs[PI_WR_LEN_REG] & UINT32_C(0x00ffffff)) + 1;
@@ -113,7 +123,10 @@ static void dma_pi_write(struct pi_controller* pi)
         length -= dram_addr & 0x7;
     unsigned int cycles = handler->dma_write(opaque, dram, dram_addr, cart_addr, length);
 
+    memtrace_dma(MEMTRACE_DMA_PI, cart_addr, dram_addr, length);
+
     post_framebuffer_write(&pi->dp->fb, dram_addr, length);
+    rdram_mark_dirty_range(pi->ri->rdram, dram_addr, length);
 
     /* Mark DMA as busy */
     pi->regs[PI_STATUS_REG] |= PI_STATUS_DMA_BUSY;
@@ -179,12 +192,16 @@ void write_pi_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mask
 
     case PI_RD_LEN_REG:
         masked_write(&pi->regs[PI_RD_LEN_REG], value, mask);
+        timed_section_start(TIMED_SECTION_DMA_PI);
         dma_pi_read(pi);
+        timed_section_end(TIMED_SECTION_DMA_PI);
         return;
 
     case PI_WR_LEN_REG:
         masked_write(&pi->regs[PI_WR_LEN_REG], value, mask);
+        timed_section_start(TIMED_SECTION_DMA_PI);
         dma_pi_write(pi);
+        timed_section_end(TIMED_SECTION_DMA_PI);
         return;
 
     case PI_STATUS_REG:
@@ -26,6 +26,7 @@
 #include "device/memory/memory.h"
 #include "device/rcp/mi/mi_controller.h"
 #include "device/rcp/rsp/rsp_core.h"
+#include "main/profile.h"
 #include "plugin/plugin.h"
 
 static void update_dpc_status(struct rdp_core* dp, uint32_t w)
@@ -42,7 +43,11 @@ static void update_dpc_status(struct rdp_core* dp, uint32_t w)
         if (dp->do_on_unfreeze & DELAY_DP_INT)
             signal_rcp_interrupt(dp->mi, MI_INTR_DP);
         if (dp->do_on_unfreeze & DELAY_UPDATESCREEN)
+        {
+            timed_section_start(TIMED_SECTION_VIDEO);
             gfx.updateScreen();
+            timed_section_end(TIMED_SECTION_VIDEO);
+        }
         dp->do_on_unfreeze = 0;
     }
     if (w & DPC_SET_FREEZE) dp->dpc_regs[DPC_STATUS_REG] |= DPC_STATUS_FREEZE;
@@ -86,6 +91,8 @@ void read_dpc_regs(void* opaque, uint32_t address, uint32_t* value)
     struct rdp_core* dp = (struct rdp_core*)opaque;
     uint32_t reg = dpc_reg(address);
 
+    wait_rsp_task(dp->sp);
+
     *value = dp->dpc_regs[reg];
 }
 
@@ -94,6 +101,8 @@ void write_dpc_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mas
     struct rdp_core* dp = (struct rdp_core*)opaque;
     uint32_t reg = dpc_reg(address);
 
+    wait_rsp_task(dp->sp);
+
     switch(reg)
     {
     case DPC_STATUS_REG:
@@ -143,6 +152,8 @@ void rdp_interrupt_event(void* opaque)
 {
     struct rdp_core* dp = (struct rdp_core*)opaque;
 
+    wait_rsp_task(dp->sp);
+
     raise_rcp_interrupt(dp->mi, MI_INTR_DP);
 }
 
@@ -23,6 +23,7 @@
 
 #include <string.h>
 
+#include "device/device.h"
 #include "device/memory/memory.h"
 #include "device/r4300/r4300_core.h"
 #include "device/rcp/mi/mi_controller.h"
@@ -30,9 +31,9 @@
 #include "device/rcp/ri/ri_controller.h"
 #include "device/rdram/rdram.h"
 #include "main/main.h"
-#if defined(PROFILE)
+#include "main/memtrace.h"
+#include "main/rsp_thread.h"
 #include "main/profile.h"
-#endif
 #include "plugin/plugin.h"
 #include "api/callbacks.h"
 
@@ -52,6 +53,13 @@ static void do_sp_dma(struct rsp_core* sp, const struct sp_dma* dma)
     unsigned char *spmem = (unsigned char*)sp->mem + (dma->memaddr & 0x1000);
     unsigned char *dram = (unsigned char*)sp->ri->rdram->dram;
 
+    if (dma->dir == SP_DMA_READ) {
+        memtrace_dma(MEMTRACE_DMA_SP, MM_RSP_MEM | (dma->memaddr & 0x1ff8), dramaddr, count * length);
+    }
+    else {
+        memtrace_dma(MEMTRACE_DMA_SP, dramaddr, MM_RSP_MEM | (dma->memaddr & 0x1ff8), count * length);
+    }
+
     if (dma->dir == SP_DMA_READ)
     {
         for(j=0; j<count; j++) {
@@ -62,6 +70,7 @@ static void do_sp_dma(struct rsp_core* sp, const struct sp_dma* dma)
             }
 
             post_framebuffer_write(&sp->dp->fb, dramaddr - length, length);
+            rdram_mark_dirty_range(sp->ri->rdram, dramaddr - length, length);
             dramaddr+=skip;
         }
     }
@@ -110,7 +119,9 @@ static void fifo_push(struct rsp_core* sp, uint32_t dir)
         sp->regs[SP_DMA_BUSY_REG] = 1;
         sp->regs[SP_STATUS_REG] |= SP_STATUS_DMA_BUSY;
 
+        timed_section_start(TIMED_SECTION_DMA_SP);
         do_sp_dma(sp, &sp->fifo[0]);
+        timed_section_end(TIMED_SECTION_DMA_SP);
     }
 }
 
@@ -125,7 +136,9 @@ static void fifo_pop(struct rsp_core* sp)
         sp->regs[SP_DMA_FULL_REG] = 0;
         sp->regs[SP_STATUS_REG] &= ~SP_STATUS_DMA_FULL;
 
+        timed_section_start(TIMED_SECTION_DMA_SP);
         do_sp_dma(sp, &sp->fifo[0]);
+        timed_section_end(TIMED_SECTION_DMA_SP);
     }
     else
     {
@@ -206,16 +219,21 @@ void init_rsp(struct rsp_core* sp,
               uint32_t* sp_mem,
               struct mi_controller* mi,
               struct rdp_core* dp,
-              struct ri_controller* ri)
+              struct ri_controller* ri,
+              int async_tasks)
 {
     sp->mem = sp_mem;
     sp->mi = mi;
     sp->dp = dp;
     sp->ri = ri;
+    sp->async_tasks = async_tasks;
+    sp->async_task_pending = 0;
 }
 
 void poweron_rsp(struct rsp_core* sp)
 {
+    wait_rsp_task(sp);
+
     memset(sp->mem, 0, SP_MEM_SIZE);
     memset(sp->regs, 0, SP_REGS_COUNT*sizeof(uint32_t));
     memset(sp->regs2, 0, SP_REGS2_COUNT*sizeof(uint32_t));
@@ -232,6 +250,8 @@ void read_rsp_mem(void* opaque, uint32_t address, uint32_t* value)
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t addr = rsp_mem_address(address);
 
+    wait_rsp_task(sp);
+
     *value = sp->mem[addr];
 }
 
@@ -240,6 +260,8 @@ void write_rsp_mem(void* opaque, uint32_t address, uint32_t value, uint32_t mask
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t addr = rsp_mem_address(address);
 
+    wait_rsp_task(sp);
+
     masked_write(&sp->mem[addr], value, mask);
 }
 
@@ -249,6 +271,8 @@ void read_rsp_regs(void* opaque, uint32_t address, uint32_t* value)
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg(address);
 
+    wait_rsp_task(sp);
+
     *value = sp->regs[reg];
 
     if (reg == SP_SEMAPHORE_REG)
@@ -262,6 +286,8 @@ void write_rsp_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mas
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg(address);
 
+    wait_rsp_task(sp);
+
     switch(reg)
     {
     case SP_STATUS_REG:
@@ -293,6 +319,8 @@ void read_rsp_regs2(void* opaque, uint32_t address, uint32_t* value)
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg2(address);
 
+    wait_rsp_task(sp);
+
     *value = sp->regs2[reg];
 }
 
@@ -301,9 +329,83 @@ void write_rsp_regs2(void* opaque, uint32_t address, uint32_t value, uint32_t ma
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg2(address);
 
+    wait_rsp_task(sp);
+
     masked_write(&sp->regs2[reg], value, mask);
 }
 
+static void merge_mi_intr_reg(struct rsp_core* sp)
+{
+    /* only apply MI_INTR_REG bits changed by the RSP plugin */
+    uint32_t changed = sp->mi_intr_reg ^ sp->mi_intr_reg_in;
+
+    sp->mi->regs[MI_INTR_REG] = (sp->mi->regs[MI_INTR_REG] & ~changed)
+                              | (sp->mi_intr_reg & changed);
+}
+
+static void run_rsp_cycles(struct rsp_core* sp)
+{
+    sp->mi_intr_reg = sp->mi_intr_reg_in = sp->mi->regs[MI_INTR_REG];
+    rsp.doRspCycles(0xffffffff);
+    merge_mi_intr_reg(sp);
+}
+
+/* Returns non-zero if the task requires a SP interrupt */
+static int end_sp_task(struct rsp_core* sp)
+{
+    int sp_int = 0;
+
+    sp->rsp_task_locked = 0;
+    sp->mi->r4300->cp0.interrupt_unsafe_state &= ~INTR_UNSAFE_RSP;
+    if ((sp->regs[SP_STATUS_REG] & (SP_STATUS_HALT | SP_STATUS_BROKE)) == 0)
+    {
+        sp->rsp_task_locked = 1;
+        sp->mi->r4300->cp0.interrupt_unsafe_state |= INTR_UNSAFE_RSP;
+        sp->mi->regs[MI_INTR_REG] |= MI_INTR_SP;
+    }
+    if (sp->mi->regs[MI_INTR_REG] & MI_INTR_SP)
+    {
+        sp->mi->regs[MI_INTR_REG] &= ~MI_INTR_SP;
+        sp_int = 1;
+    }
+
+    sp->regs[SP_STATUS_REG] &=
+        ~(SP_STATUS_TASKDONE | SP_STATUS_BROKE | SP_STATUS_HALT);
+
+    return sp_int;
+}
+
+static void start_async_sp_task(struct rsp_core* sp, uint32_t save_pc, uint32_t sp_delay_time)
+{
+    sp->mi_intr_reg = sp->mi_intr_reg_in = sp->mi->regs[MI_INTR_REG];
+    sp->async_save_pc = save_pc;
+    sp->async_task_pending = 1;
+
+    /* don't let savestates capture a running task */
+    sp->mi->r4300->cp0.interrupt_unsafe_state |= INTR_UNSAFE_RSP;
+
+    /* SP_INT is scheduled when the synchronous task would have scheduled it,
+     * so the task is waited for at the latest there.
+     * It is dropped when the task ends up not requiring it. */
+    cp0_update_count(sp->mi->r4300);
+    add_interrupt_event(&sp->mi->r4300->cp0, SP_INT, sp_delay_time);
+
+    rsp_thread_start_task();
+}
+
+static int finish_async_sp_task(struct rsp_core* sp)
+{
+    sp->async_task_pending = 0;
+    timed_section_start(TIMED_SECTION_RSP);
+    rsp_thread_wait_task();
+    timed_section_end(TIMED_SECTION_RSP);
+
+    merge_mi_intr_reg(sp);
+    sp->regs2[SP_PC_REG] |= sp->async_save_pc;
+
+    return end_sp_task(sp);
+}
+
 void do_SP_Task(struct rsp_core* sp)
 {
     uint32_t save_pc = sp->regs2[SP_PC_REG] & ~0xfff;
@@ -316,13 +418,9 @@ void do_SP_Task(struct rsp_core* sp)
 
         //gfx.processDList();
         sp->regs2[SP_PC_REG] &= 0xfff;
-#if defined(PROFILE)
         timed_section_start(TIMED_SECTION_GFX);
-#endif
-        rsp.doRspCycles(0xffffffff);
-#if defined(PROFILE)
+        run_rsp_cycles(sp);
         timed_section_end(TIMED_SECTION_GFX);
-#endif
         sp->regs2[SP_PC_REG] |= save_pc;
         new_frame();
 
@@ -344,13 +442,14 @@ void do_SP_Task(struct rsp_core* sp)
     {
         //audio.processAList();
         sp->regs2[SP_PC_REG] &= 0xfff;
-#if defined(PROFILE)
+        if (sp->async_tasks)
+        {
+            start_async_sp_task(sp, save_pc, 4000);
+            return;
+        }
         timed_section_start(TIMED_SECTION_AUDIO);
-#endif
-        rsp.doRspCycles(0xffffffff);
-#if defined(PROFILE)
+        run_rsp_cycles(sp);
         timed_section_end(TIMED_SECTION_AUDIO);
-#endif
         sp->regs2[SP_PC_REG] |= save_pc;
 
         sp_delay_time = 4000;
@@ -358,35 +457,47 @@ void do_SP_Task(struct rsp_core* sp)
     else
     {
         sp->regs2[SP_PC_REG] &= 0xfff;
-        rsp.doRspCycles(0xffffffff);
+        if (sp->async_tasks)
+        {
+            start_async_sp_task(sp, save_pc, 0);
+            return;
+        }
+        timed_section_start(TIMED_SECTION_RSP);
+        run_rsp_cycles(sp);
+        timed_section_end(TIMED_SECTION_RSP);
         sp->regs2[SP_PC_REG] |= save_pc;
 
         sp_delay_time = 0;
     }
 
-    sp->rsp_task_locked = 0;
-    sp->mi->r4300->cp0.interrupt_unsafe_state &= ~INTR_UNSAFE_RSP;
-    if ((sp->regs[SP_STATUS_REG] & (SP_STATUS_HALT | SP_STATUS_BROKE)) == 0)
-    {
-        sp->rsp_task_locked = 1;
-        sp->mi->r4300->cp0.interrupt_unsafe_state |= INTR_UNSAFE_RSP;
-        sp->mi->regs[MI_INTR_REG] |= MI_INTR_SP;
-    }
-    if (sp->mi->regs[MI_INTR_REG] & MI_INTR_SP)
+    if (end_sp_task(sp))
     {
         cp0_update_count(sp->mi->r4300);
         add_interrupt_event(&sp->mi->r4300->cp0, SP_INT, sp_delay_time);
-        sp->mi->regs[MI_INTR_REG] &= ~MI_INTR_SP;
     }
+}
 
-    sp->regs[SP_STATUS_REG] &=
-        ~(SP_STATUS_TASKDONE | SP_STATUS_BROKE | SP_STATUS_HALT);
+void wait_rsp_task(struct rsp_core* sp)
+{
+    if (!sp->async_task_pending)
+        return;
+
+    if (!finish_async_sp_task(sp))
+    {
+        remove_event(&sp->mi->r4300->cp0.q, SP_INT);
+    }
 }
 
 void rsp_interrupt_event(void* opaque)
 {
     struct rsp_core* sp = (struct rsp_core*)opaque;
 
+    /* SP_INT was only scheduled to wait for the asynchronous task */
+    if (sp->async_task_pending && !finish_async_sp_task(sp))
+    {
+        return;
+    }
+
     if (!sp->rsp_task_locked)
     {
         sp->regs[SP_STATUS_REG] |=
@@ -402,5 +513,8 @@ void rsp_interrupt_event(void* opaque)
 void rsp_end_of_dma_event(void* opaque)
 {
     struct rsp_core* sp = (struct rsp_core*)opaque;
+
+    wait_rsp_task(sp);
+
     fifo_pop(sp);
 }
@@ -98,6 +98,15 @@ struct rsp_core
     uint32_t regs2[SP_REGS2_COUNT];
     uint32_t rsp_task_locked;
 
+    /* MI_INTR_REG as seen by the RSP plugin, merged back after each task */
+    uint32_t mi_intr_reg;
+    uint32_t mi_intr_reg_in;
+
+    /* run tasks other than display lists on the RSP thread */
+    int async_tasks;
+    int async_task_pending;
+    uint32_t async_save_pc;
+
     struct mi_controller* mi;
     struct rdp_core* dp;
     struct ri_controller* ri;
@@ -123,7 +132,8 @@ void init_rsp(struct rsp_core* sp,
               uint32_t* sp_mem,
               struct mi_controller* mi,
               struct rdp_core* dp,
-              struct ri_controller* ri);
+              struct ri_controller* ri,
+              int async_tasks);
 
 void poweron_rsp(struct rsp_core* sp);
 
@@ -138,6 +148,11 @@ void write_rsp_regs2(void* opaque, uint32_t address, uint32_t value, uint32_t ma
 
 void do_SP_Task(struct rsp_core* sp);
 
+/* Wait for the completion of an asynchronous RSP task (if any).
+ * Must be called before accessing any state the RSP plugin may modify.
+ */
+void wait_rsp_task(struct rsp_core* sp);
+
 void rsp_interrupt_event(void* opaque);
 void rsp_end_of_dma_event(void* opaque);
 
@@ -25,12 +25,15 @@
 
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
+#include "device/device.h"
 #include "device/memory/memory.h"
 #include "device/pif/pif.h"
 #include "device/r4300/r4300_core.h"
 #include "device/rcp/mi/mi_controller.h"
 #include "device/rcp/ri/ri_controller.h"
 #include "device/rdram/rdram.h"
+#include "main/memtrace.h"
+#include "main/profile.h"
 #include "osal/preproc.h"
 
 static int validate_dma(struct si_controller* si, uint32_t reg)
@@ -60,14 +63,17 @@ static void copy_pif_rdram(struct si_controller* si)
     uint32_t* dram = (uint32_t*)(&si->ri->rdram->dram[rdram_dram_address(dram_addr)]);
 
     if (si->dma_dir == SI_DMA_WRITE) {
+        memtrace_dma(MEMTRACE_DMA_SI, dram_addr, MM_PIF_MEM + PIF_ROM_SIZE, PIF_RAM_SIZE);
         for(i = 0; i < (PIF_RAM_SIZE / 4); ++i) {
             pif_ram[i] = fromhl(dram[i]);
         }
     }
     else if (si->dma_dir == SI_DMA_READ) {
+        memtrace_dma(MEMTRACE_DMA_SI, MM_PIF_MEM + PIF_ROM_SIZE, dram_addr, PIF_RAM_SIZE);
         for(i = 0; i < (PIF_RAM_SIZE / 4); ++i) {
             dram[i] = tohl(pif_ram[i]);
         }
+        rdram_mark_dirty_range(si->ri->rdram, dram_addr, PIF_RAM_SIZE);
     }
 }
 
@@ -139,12 +145,16 @@ void write_si_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mask
 
     case SI_PIF_ADDR_RD64B_REG:
         masked_write(&si->regs[SI_PIF_ADDR_RD64B_REG], value, mask);
+        timed_section_start(TIMED_SECTION_DMA_SI);
         dma_si_read(si);
+        timed_section_end(TIMED_SECTION_DMA_SI);
         break;
 
     case SI_PIF_ADDR_WR64B_REG:
         masked_write(&si->regs[SI_PIF_ADDR_WR64B_REG], value, mask);
+        timed_section_start(TIMED_SECTION_DMA_SI);
         dma_si_write(si);
+        timed_section_end(TIMED_SECTION_DMA_SI);
         break;
 
     case SI_STATUS_REG:
@@ -117,7 +117,8 @@ static void map_corrupt_rdram(struct rdram* rdram, int corrupt)
 
     apply_mem_mapping(rdram->r4300->mem, &mapping);
 #ifndef NEW_DYNAREC
-    rdram->r4300->recomp.fast_memory = (corrupt) ? 0 : 1;
+    /* dirty page tracking needs every store to go through write_rdram_dram */
+    rdram->r4300->recomp.fast_memory = (corrupt || rdram->dirty_tracking) ? 0 : 1;
     invalidate_r4300_cached_code(rdram->r4300, 0, 0);
 #endif
 }
@@ -140,6 +141,10 @@ void poweron_rdram(struct rdram* rdram)
     memset(rdram->regs, 0, RDRAM_MAX_MODULES_COUNT*RDRAM_REGS_COUNT*sizeof(uint32_t));
     memset(rdram->dram, 0, rdram->dram_size);
 
+    /* whole RDRAM content changed */
+    rdram->dirty_tracking = 0;
+    rdram_mark_dirty_range(rdram, 0, rdram->dram_size);
+
     DebugMessage(M64MSG_INFO, "Initializing %u RDRAM modules for a total of %u MB",
         (uint32_t) modules, (uint32_t) rdram->dram_size / (1024*1024));
 
@@ -249,5 +254,63 @@ void write_rdram_dram(void* opaque, uint32_t address, uint32_t value, uint32_t m
     if (address < rdram->dram_size)
     {
         masked_write(&rdram->dram[addr], value, mask);
+        rdram_mark_dirty_page(rdram, address);
     }
 }
+
+
+void rdram_mark_dirty_range(struct rdram* rdram, uint32_t address, size_t length)
+{
+    uint32_t page;
+    uint32_t last;
+
+    if (length == 0) {
+        return;
+    }
+
+    address &= 0x7fffff;
+    if (length > RDRAM_DIRTY_PAGES_COUNT << RDRAM_DIRTY_PAGE_SHIFT) {
+        length = RDRAM_DIRTY_PAGES_COUNT << RDRAM_DIRTY_PAGE_SHIFT;
+    }
+
+    page = address >> RDRAM_DIRTY_PAGE_SHIFT;
+    last = (uint32_t)((address + length - 1) >> RDRAM_DIRTY_PAGE_SHIFT);
+    if (last >= RDRAM_DIRTY_PAGES_COUNT) {
+        last = RDRAM_DIRTY_PAGES_COUNT - 1;
+    }
+
+    for (; page <= last; ++page) {
+        rdram->dirty_pages[page >> 5] |= UINT32_C(1) << (page & 31);
+    }
+}
+
+size_t rdram_fetch_dirty_pages(struct rdram* rdram, uint32_t* bitmap, size_t words)
+{
+    size_t i;
+    size_t count = ((rdram->dram_size >> RDRAM_DIRTY_PAGE_SHIFT) + 31) / 32;
+    uint32_t rearm[RDRAM_DIRTY_PAGES_COUNT / 32];
+
+    if (words > count) {
+        memset(bitmap + count, 0, (words - count) * sizeof(*bitmap));
+        words = count;
+    }
+
+    /* pages which have not been fetched stay dirty */
+    memset(rearm, 0, sizeof(rearm));
+    for (i = 0; i < words; ++i) {
+        bitmap[i] = rdram->dirty_pages[i];
+        rearm[i] = rdram->dirty_pages[i];
+        rdram->dirty_pages[i] = 0;
+    }
+
+    /* first fetch arms write traps on every page,
+     * afterwards only fetched dirty pages lost their trap */
+    if (!rdram->dirty_tracking) {
+        rdram->dirty_tracking = 1;
+        memset(rearm, 0xff, sizeof(rearm));
+    }
+
+    trap_r4300_rdram_writes(rdram->r4300, rearm, rdram->dram_size >> RDRAM_DIRTY_PAGE_SHIFT);
+
+    return count;
+}
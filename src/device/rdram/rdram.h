@@ -47,6 +47,10 @@ enum rdram_registers
 /* IPL3 rdram initialization accepts up to 8 RDRAM modules */
 enum { RDRAM_MAX_MODULES_COUNT = 8 };
 
+/* RDRAM writes are tracked with a 4KB page granularity (8MB / 4KB pages) */
+enum { RDRAM_DIRTY_PAGE_SHIFT = 12 };
+enum { RDRAM_DIRTY_PAGES_COUNT = 0x800 };
+
 struct rdram
 {
     uint32_t regs[RDRAM_MAX_MODULES_COUNT][RDRAM_REGS_COUNT];
@@ -54,6 +58,10 @@ struct rdram
     uint32_t* dram;
     size_t dram_size;
 
+    /* one bit per 4KB page written since last rdram_fetch_dirty_pages */
+    uint32_t dirty_pages[RDRAM_DIRTY_PAGES_COUNT / 32];
+    int dirty_tracking;
+
     struct r4300_core* r4300;
 };
 
@@ -67,6 +75,12 @@ static osal_inline uint32_t rdram_dram_address(uint32_t address)
     return (address & 0xffffff) >> 2;
 }
 
+static osal_inline void rdram_mark_dirty_page(struct rdram* rdram, uint32_t address)
+{
+    uint32_t page = (address & 0x7fffff) >> RDRAM_DIRTY_PAGE_SHIFT;
+    rdram->dirty_pages[page >> 5] |= UINT32_C(1) << (page & 31);
+}
+
 void init_rdram(struct rdram* rdram,
                 uint32_t* dram,
                 size_t dram_size,
@@ -80,4 +94,12 @@ void write_rdram_regs(void* opaque, uint32_t address, uint32_t value, uint32_t m
 void read_rdram_dram(void* opaque, uint32_t address, uint32_t* value);
 void write_rdram_dram(void* opaque, uint32_t address, uint32_t value, uint32_t mask);
 
+void rdram_mark_dirty_range(struct rdram* rdram, uint32_t address, size_t length);
+
+/* Copy the dirty page bitmap (one bit per 4KB page, LSB first) into bitmap
+ * and clear it, then arm the write traps needed to catch the next writes.
+ * Must be called from the emulation thread (or while emulation is paused).
+ * Returns the number of 32-bit words covering the current RDRAM size. */
+size_t rdram_fetch_dirty_pages(struct rdram* rdram, uint32_t* bitmap, size_t words);
+
 #endif
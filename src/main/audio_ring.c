@@ -0,0 +1,281 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - audio_ring.c                                            *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "audio_ring.h"
+
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+
+struct audio_ring {
+    uint8_t* buffer;
+    uint32_t mask;
+
+    /* free running byte positions, only head is written by the producer
+     * and only tail by the consumer */
+    SDL_atomic_t head;
+    SDL_atomic_t tail;
+
+    /* pending frequency change and the head position it applies at */
+    SDL_atomic_t frequency;
+    SDL_atomic_t frequency_pos;
+
+    SDL_atomic_t pushes;
+    SDL_atomic_t batches;
+    SDL_atomic_t overruns;
+    SDL_atomic_t underruns;
+
+    SDL_sem* data_avail;
+    SDL_sem* space_avail;
+    SDL_Thread* thread;
+    SDL_atomic_t quit;
+
+    /* consumer side state */
+    unsigned int current_frequency;
+    Uint32 play_deadline;
+
+    void* aout;
+    const struct audio_out_backend_interface* iaout;
+};
+
+static struct audio_ring audio_ring;
+
+static void forward_samples(uint32_t tail, uint32_t end)
+{
+    uint32_t size = end - tail;
+    uint32_t offset = tail & audio_ring.mask;
+    uint32_t chunk = audio_ring.mask + 1 - offset;
+
+    if (chunk > size)
+        chunk = size;
+
+    audio_ring.iaout->push_samples(audio_ring.aout, audio_ring.buffer + offset, chunk);
+    if (chunk < size)
+        audio_ring.iaout->push_samples(audio_ring.aout, audio_ring.buffer, size - chunk);
+
+    SDL_AtomicSet(&audio_ring.tail, (int)end);
+    SDL_SemPost(audio_ring.space_avail);
+}
+
+static void account_batch(uint32_t size)
+{
+    Uint32 now = SDL_GetTicks();
+
+    if (SDL_AtomicAdd(&audio_ring.batches, 1) != 0 && (Sint32)(now - audio_ring.play_deadline) > 0)
+        SDL_AtomicAdd(&audio_ring.underruns, 1);
+
+    if ((Sint32)(now - audio_ring.play_deadline) > 0)
+        audio_ring.play_deadline = now;
+
+    /* 16-bit stereo frames */
+    if (audio_ring.current_frequency != 0)
+        audio_ring.play_deadline += (Uint32)(((uint64_t)size * 1000) / (4 * audio_ring.current_frequency));
+}
+
+/* Hand every queued sample and pending frequency change to the backend */
+static void drain_ring(void)
+{
+    uint32_t tail = (uint32_t)SDL_AtomicGet(&audio_ring.tail);
+    uint32_t forwarded = 0;
+
+    for (;;) {
+        uint32_t head = (uint32_t)SDL_AtomicGet(&audio_ring.head);
+        int frequency = SDL_AtomicGet(&audio_ring.frequency);
+
+        if (frequency != 0) {
+            uint32_t pos = (uint32_t)SDL_AtomicGet(&audio_ring.frequency_pos);
+
+            /* samples pushed before the change are played at the old frequency */
+            if (pos - tail <= head - tail) {
+                if (pos != tail) {
+                    forward_samples(tail, pos);
+                    forwarded += pos - tail;
+                    tail = pos;
+                }
+
+                if (SDL_AtomicCAS(&audio_ring.frequency, frequency, 0)) {
+                    audio_ring.current_frequency = (unsigned int)frequency;
+                    audio_ring.iaout->set_frequency(audio_ring.aout, (unsigned int)frequency);
+                }
+                continue;
+            }
+        }
+
+        if (head == tail)
+            break;
+
+        forward_samples(tail, head);
+        forwarded += head - tail;
+        tail = head;
+    }
+
+    if (forwarded != 0)
+        account_batch(forwarded);
+}
+
+static int audio_ring_thread(void* data)
+{
+    for (;;) {
+        SDL_SemWait(audio_ring.data_avail);
+
+        /* several pushes may have been queued since the last wakeup,
+         * they are all forwarded in one go */
+        drain_ring();
+
+        if (SDL_AtomicGet(&audio_ring.quit))
+            break;
+    }
+
+    return 0;
+}
+
+int audio_ring_init(uint8_t* buffer, size_t size,
+                    void* aout, const struct audio_out_backend_interface* iaout)
+{
+    memset(&audio_ring, 0, sizeof(audio_ring));
+
+    audio_ring.buffer = buffer;
+    audio_ring.mask = (uint32_t)(size - 1);
+    audio_ring.aout = aout;
+    audio_ring.iaout = iaout;
+
+    audio_ring.data_avail = SDL_CreateSemaphore(0);
+    audio_ring.space_avail = SDL_CreateSemaphore(0);
+    if (!audio_ring.data_avail || !audio_ring.space_avail) {
+        DebugMessage(M64MSG_ERROR, "Could not create audio ring synchronization objects");
+        return -1;
+    }
+
+#if SDL_VERSION_ATLEAST(2,0,0)
+    audio_ring.thread = SDL_CreateThread(audio_ring_thread, "m64paudio", NULL);
+#else
+    audio_ring.thread = SDL_CreateThread(audio_ring_thread, NULL);
+#endif
+    if (!audio_ring.thread) {
+        DebugMessage(M64MSG_ERROR, "Could not create audio ring thread");
+        return -1;
+    }
+
+    return 0;
+}
+
+void audio_ring_shutdown(void)
+{
+    int status;
+
+    if (audio_ring.thread) {
+        SDL_AtomicSet(&audio_ring.quit, 1);
+        SDL_SemPost(audio_ring.data_avail);
+        SDL_WaitThread(audio_ring.thread, &status);
+        audio_ring.thread = NULL;
+    }
+    else if (audio_ring.iaout != NULL) {
+        drain_ring();
+    }
+
+    if (audio_ring.space_avail)
+        SDL_DestroySemaphore(audio_ring.space_avail);
+    if (audio_ring.data_avail)
+        SDL_DestroySemaphore(audio_ring.data_avail);
+
+    audio_ring.space_avail = NULL;
+    audio_ring.data_avail = NULL;
+}
+
+size_t audio_ring_fill(void)
+{
+    return (uint32_t)SDL_AtomicGet(&audio_ring.head) - (uint32_t)SDL_AtomicGet(&audio_ring.tail);
+}
+
+int audio_ring_wait_fill(size_t level, unsigned int timeout_ms)
+{
+    Uint32 start = SDL_GetTicks();
+
+    while (audio_ring_fill() > level) {
+        Uint32 elapsed = SDL_GetTicks() - start;
+
+        if (!audio_ring.thread || elapsed >= timeout_ms)
+            return -1;
+
+        /* stale posts only cause an extra check of the fill level */
+        if (SDL_SemWaitTimeout(audio_ring.space_avail, timeout_ms - elapsed) == SDL_MUTEX_TIMEDOUT
+         && audio_ring_fill() > level)
+            return -1;
+    }
+
+    return 0;
+}
+
+void audio_ring_get_stats(m64p_audio_ring_stats* stats)
+{
+    stats->capacity = (audio_ring.buffer != NULL) ? audio_ring.mask + 1 : 0;
+    stats->fill = (uint32_t)audio_ring_fill();
+    stats->pushes = (uint32_t)SDL_AtomicGet(&audio_ring.pushes);
+    stats->batches = (uint32_t)SDL_AtomicGet(&audio_ring.batches);
+    stats->overruns = (uint32_t)SDL_AtomicGet(&audio_ring.overruns);
+    stats->underruns = (uint32_t)SDL_AtomicGet(&audio_ring.underruns);
+}
+
+static void audio_ring_set_frequency(void* aout, unsigned int frequency)
+{
+    SDL_AtomicSet(&audio_ring.frequency_pos, SDL_AtomicGet(&audio_ring.head));
+    SDL_AtomicSet(&audio_ring.frequency, (int)frequency);
+
+    if (audio_ring.thread)
+        SDL_SemPost(audio_ring.data_avail);
+    else
+        drain_ring();
+}
+
+static void audio_ring_push_samples(void* aout, const void* samples, size_t size)
+{
+    uint32_t head = (uint32_t)SDL_AtomicGet(&audio_ring.head);
+    uint32_t tail = (uint32_t)SDL_AtomicGet(&audio_ring.tail);
+    uint32_t offset = head & audio_ring.mask;
+    uint32_t chunk = audio_ring.mask + 1 - offset;
+
+    if (size > (size_t)(audio_ring.mask + 1 - (head - tail))) {
+        SDL_AtomicAdd(&audio_ring.overruns, 1);
+        return;
+    }
+
+    if (chunk > size)
+        chunk = (uint32_t)size;
+
+    memcpy(audio_ring.buffer + offset, samples, chunk);
+    memcpy(audio_ring.buffer, (const uint8_t*)samples + chunk, size - chunk);
+
+    SDL_AtomicSet(&audio_ring.head, (int)(head + (uint32_t)size));
+    SDL_AtomicAdd(&audio_ring.pushes, 1);
+
+    if (audio_ring.thread)
+        SDL_SemPost(audio_ring.data_avail);
+    else
+        drain_ring();
+}
+
+const struct audio_out_backend_interface g_iaudio_out_backend_ring =
+{
+    audio_ring_set_frequency,
+    audio_ring_push_samples
+};
@@ -0,0 +1,66 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - audio_ring.h                                            *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_AUDIO_RING_H
+#define M64P_MAIN_AUDIO_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "api/m64p_types.h"
+#include "backends/api/audio_out_backend.h"
+
+/* Single producer / single consumer sample ring sitting between the AI
+ * controller (producer, emulation thread) and an audio out backend which
+ * is driven from a dedicated consumer thread.
+ *
+ * The ring is a backend itself (g_iaudio_out_backend_ring), so the AI
+ * controller does not need to know about it.
+ * Pushes are copied whole; if there is not enough room the push is
+ * dropped and counted as an overrun. Frequency changes are forwarded
+ * in-band, after the samples pushed before them.
+ */
+
+/* Initialize the ring over buffer (size must be a power of two) and start
+ * the consumer thread forwarding samples to (aout, iaout).
+ * If the thread cannot be created, samples are forwarded synchronously.
+ * Returns 0 if the consumer thread is running, -1 otherwise.
+ */
+int audio_ring_init(uint8_t* buffer, size_t size,
+                    void* aout, const struct audio_out_backend_interface* iaout);
+
+/* Forward pending samples and stop the consumer thread */
+void audio_ring_shutdown(void);
+
+/* Number of bytes queued and not yet forwarded to the backend */
+size_t audio_ring_fill(void);
+
+/* Back-pressure hook: block the producer until at most level bytes are
+ * queued, or timeout_ms elapsed.
+ * Returns 0 if the level was reached, -1 on timeout.
+ */
+int audio_ring_wait_fill(size_t level, unsigned int timeout_ms);
+
+void audio_ring_get_stats(m64p_audio_ring_stats* stats);
+
+extern const struct audio_out_backend_interface g_iaudio_out_backend_ring;
+
+#endif
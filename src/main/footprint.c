@@ -0,0 +1,273 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - footprint.c                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "footprint.h"
+
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "api/callbacks.h"
+#include "device/device.h"
+#include "device/memory/memory.h"
+#include "device/r4300/r4300_core.h"
+#include "main/main.h"
+#include "main/rewind.h"
+#include "main/rom.h"
+
+enum { FOOTPRINT_QUERY_TIMEOUT_MS = 2000 };
+
+static const char* const l_names[FOOTPRINT_COUNT] =
+{
+    "rdram",
+    "rom",
+    "tlb",
+    "invalid_code",
+    "precomp_blocks",
+    "code_cache",
+    "memory_map",
+    "savestates",
+    "other",
+    "process"
+};
+
+static m64p_memory_footprint l_footprint[FOOTPRINT_COUNT];
+/* generation of the last query asked for and of the last one answered */
+static SDL_atomic_t l_query_requested;
+static SDL_atomic_t l_query_served;
+static SDL_atomic_t l_release_requested;
+static SDL_threadID l_emulation_thread;
+
+#if !defined(WIN32)
+static size_t page_size(void)
+{
+    static size_t size = 0;
+
+    if (size == 0) {
+        long value = sysconf(_SC_PAGESIZE);
+        size = (value > 0) ? (size_t)value : 4096;
+    }
+
+    return size;
+}
+#endif
+
+void footprint_add(m64p_memory_footprint* entry, const void* ptr, size_t size)
+{
+    if (ptr == NULL || size == 0)
+        return;
+
+    entry->allocated += size;
+
+#if defined(WIN32)
+    entry->resident = UINT64_MAX;
+#else
+    {
+        size_t page = page_size();
+        uintptr_t begin = (uintptr_t)ptr & ~(uintptr_t)(page - 1);
+        uintptr_t end = ((uintptr_t)ptr + size + page - 1) & ~(uintptr_t)(page - 1);
+        unsigned char vec[1024];
+        size_t resident = 0;
+
+        while (begin < end)
+        {
+            size_t pages = (end - begin) / page;
+            size_t i;
+
+            if (pages > sizeof(vec))
+                pages = sizeof(vec);
+
+            if (mincore((void*)begin, pages * page, (void*)vec) != 0) {
+                entry->resident = UINT64_MAX;
+                return;
+            }
+
+            for (i = 0; i < pages; ++i) {
+                if (vec[i] & 1)
+                    resident += page;
+            }
+
+            begin += pages * page;
+        }
+
+        /* the partial pages at both ends may be resident for their neighbours */
+        if (entry->resident != UINT64_MAX)
+            entry->resident += (resident < size) ? resident : size;
+    }
+#endif
+}
+
+void footprint_add_heap(m64p_memory_footprint* entry, size_t size)
+{
+    entry->allocated += size;
+    if (entry->resident != UINT64_MAX)
+        entry->resident += size;
+}
+
+void footprint_discard(void* ptr, size_t size)
+{
+#if defined(WIN32)
+    (void)ptr;
+    (void)size;
+#else
+    size_t page = page_size();
+    uintptr_t begin = ((uintptr_t)ptr + page - 1) & ~(uintptr_t)(page - 1);
+    uintptr_t end = ((uintptr_t)ptr + size) & ~(uintptr_t)(page - 1);
+
+    if (begin < end && madvise((void*)begin, end - begin, MADV_DONTNEED) != 0)
+        DebugMessage(M64MSG_WARNING, "Failed to release %u KB of memory", (unsigned int)((end - begin) / 1024));
+#endif
+}
+
+static void footprint_process(m64p_memory_footprint* entry)
+{
+#if defined(__linux__)
+    FILE* f = fopen("/proc/self/statm", "r");
+    unsigned long size, resident;
+
+    if (f != NULL)
+    {
+        if (fscanf(f, "%lu %lu", &size, &resident) == 2) {
+            entry->allocated = (uint64_t)size * page_size();
+            entry->resident = (uint64_t)resident * page_size();
+        }
+        fclose(f);
+    }
+#else
+    (void)entry;
+#endif
+}
+
+static void footprint_compute(m64p_memory_footprint* entries)
+{
+    m64p_memory_footprint* other = &entries[FOOTPRINT_OTHER];
+    const m64p_memory_footprint* process = &entries[FOOTPRINT_PROCESS];
+    size_t i;
+
+    memset(entries, 0, FOOTPRINT_COUNT * sizeof(*entries));
+    for (i = 0; i < FOOTPRINT_COUNT; ++i) {
+        strncpy(entries[i].name, l_names[i], sizeof(entries[i].name) - 1);
+    }
+
+    footprint_add(&entries[FOOTPRINT_RDRAM], g_dev.rdram.dram, g_dev.rdram.dram_size);
+    footprint_add(&entries[FOOTPRINT_ROM], mem_base_u32(g_mem_base, MM_CART_ROM), (size_t)g_rom_size);
+    r4300_footprint(&g_dev.r4300, entries);
+    rewind_footprint(&entries[FOOTPRINT_SAVESTATES]);
+    footprint_process(&entries[FOOTPRINT_PROCESS]);
+
+    /* whatever the core subsystems do not explain */
+    if (process->allocated == 0) {
+        other->resident = UINT64_MAX;
+        entries[FOOTPRINT_PROCESS].resident = UINT64_MAX;
+        return;
+    }
+
+    other->allocated = process->allocated;
+    other->resident = process->resident;
+    for (i = 0; i < FOOTPRINT_OTHER; ++i)
+    {
+        other->allocated -= (other->allocated > entries[i].allocated) ? entries[i].allocated : other->allocated;
+        if (entries[i].resident == UINT64_MAX)
+            other->resident = UINT64_MAX;
+        if (other->resident != UINT64_MAX)
+            other->resident -= (other->resident > entries[i].resident) ? entries[i].resident : other->resident;
+    }
+}
+
+void footprint_reset(void)
+{
+    SDL_AtomicSet(&l_query_served, SDL_AtomicGet(&l_query_requested));
+    SDL_AtomicSet(&l_release_requested, 0);
+    l_emulation_thread = SDL_ThreadID();
+}
+
+m64p_error footprint_query(m64p_memory_footprint* entries, int size)
+{
+    size_t count = (size_t)size / sizeof(*entries);
+    unsigned int waited = 0;
+    int generation;
+
+    if (SDL_ThreadID() == l_emulation_thread)
+    {
+        footprint_compute(l_footprint);
+    }
+    else
+    {
+        generation = SDL_AtomicAdd(&l_query_requested, 1) + 1;
+
+        while ((int)((unsigned int)SDL_AtomicGet(&l_query_served) - (unsigned int)generation) < 0)
+        {
+            if (!g_EmulatorRunning || waited >= FOOTPRINT_QUERY_TIMEOUT_MS)
+                return M64ERR_INVALID_STATE;
+
+            SDL_Delay(1);
+            ++waited;
+        }
+    }
+
+    if (count > FOOTPRINT_COUNT) {
+        memset(entries + FOOTPRINT_COUNT, 0, (count - FOOTPRINT_COUNT) * sizeof(*entries));
+        count = FOOTPRINT_COUNT;
+    }
+    memcpy(entries, l_footprint, count * sizeof(*entries));
+
+    return M64ERR_SUCCESS;
+}
+
+void footprint_request_release(void)
+{
+    SDL_AtomicSet(&l_release_requested, 1);
+}
+
+int footprint_pending(void)
+{
+    return SDL_AtomicGet(&l_release_requested)
+        || SDL_AtomicGet(&l_query_served) != SDL_AtomicGet(&l_query_requested);
+}
+
+void footprint_run(void)
+{
+    int generation;
+
+    if (SDL_AtomicGet(&l_release_requested) && release_r4300_cached_code(&g_dev.r4300))
+    {
+#if defined(__GLIBC__)
+        malloc_trim(0);
+#endif
+        SDL_AtomicSet(&l_release_requested, 0);
+    }
+
+    generation = SDL_AtomicGet(&l_query_requested);
+    if (generation != SDL_AtomicGet(&l_query_served))
+    {
+        footprint_compute(l_footprint);
+        SDL_AtomicSet(&l_query_served, generation);
+    }
+}
@@ -0,0 +1,80 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - footprint.h                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_FOOTPRINT_H
+#define M64P_MAIN_FOOTPRINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "api/m64p_types.h"
+
+/* Breakdown of the memory used by a running instance, per subsystem.
+ *
+ * Allocated bytes are the size of the buffers owned by the subsystem,
+ * resident bytes the part of them currently in physical memory, as reported
+ * by mincore() with a page granularity. Small heap allocations are reported
+ * as resident. Where mincore() is not available, resident is UINT64_MAX.
+ *
+ * The process entry holds the whole address space and resident set size,
+ * and "other" what the listed subsystems do not account for: plugins,
+ * front-end, libraries and the rest of the core.
+ *
+ * Queries and cache releases are requested from any thread and served by
+ * the emulation thread between two frames, or while paused.
+ */
+
+enum footprint_subsystem
+{
+    FOOTPRINT_RDRAM,
+    FOOTPRINT_ROM,
+    FOOTPRINT_TLB,
+    FOOTPRINT_INVALID_CODE,
+    FOOTPRINT_PRECOMP_BLOCKS,
+    FOOTPRINT_CODE_CACHE,
+    FOOTPRINT_MEMORY_MAP,
+    FOOTPRINT_SAVESTATES,
+    FOOTPRINT_OTHER,
+    FOOTPRINT_PROCESS,
+    FOOTPRINT_COUNT
+};
+
+/* Account size bytes at ptr to entry */
+void footprint_add(m64p_memory_footprint* entry, const void* ptr, size_t size);
+/* Account a heap allocation, assumed to be resident */
+void footprint_add_heap(m64p_memory_footprint* entry, size_t size);
+
+/* Give back to the system the whole pages of [ptr, ptr+size),
+ * which read as zero (or as their previous content on Windows) afterward */
+void footprint_discard(void* ptr, size_t size);
+
+void footprint_reset(void);
+
+/* Wait for the emulation thread to fill up to size bytes of entries */
+m64p_error footprint_query(m64p_memory_footprint* entries, int size);
+/* Drop the compiled code at the next opportunity, see release_r4300_cached_code */
+void footprint_request_release(void);
+
+/* Serve the pending queries and releases, on the emulation thread */
+int footprint_pending(void);
+void footprint_run(void);
+
+#endif
@@ -0,0 +1,121 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - fork_snapshot.c                                         *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "fork_snapshot.h"
+
+#include <stddef.h>
+
+#if !defined(WIN32)
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "api/callbacks.h"
+#include "backends/file_storage.h"
+#include "rom_cache.h"
+#include "workqueue.h"
+
+static m64p_fork_callback l_fork_callback = NULL;
+static int l_fork_child = 0;
+
+m64p_error fork_snapshot_request(m64p_fork_callback callback)
+{
+#if defined(WIN32)
+    (void)callback;
+    return M64ERR_UNSUPPORTED;
+#else
+    if (l_fork_callback != NULL)
+        return M64ERR_INVALID_STATE;
+
+    l_fork_callback = callback;
+    return M64ERR_SUCCESS;
+#endif
+}
+
+int fork_snapshot_pending(void)
+{
+    return l_fork_callback != NULL;
+}
+
+#if !defined(WIN32)
+static pid_t fork_core(void)
+{
+    pid_t pid;
+
+    /* pending savestate writes hold locks and file handles */
+    rom_cache_verify_wait();
+    workqueue_suspend();
+    pid = fork();
+    workqueue_resume(pid == 0);
+
+    if (pid == 0)
+    {
+        l_fork_child = 1;
+        file_storage_fork_child();
+    }
+
+    return pid;
+}
+#endif
+
+void fork_snapshot_run(void)
+{
+#if !defined(WIN32)
+    m64p_fork_callback callback = l_fork_callback;
+    pid_t pid;
+
+    l_fork_callback = NULL;
+    if (callback == NULL)
+        return;
+
+    pid = fork_core();
+    if (pid < 0)
+        DebugMessage(M64MSG_ERROR, "Could not fork snapshot: %s", strerror(errno));
+
+    callback((int)pid);
+#endif
+}
+
+m64p_error fork_instance(int* pid)
+{
+#if defined(WIN32)
+    (void)pid;
+    return M64ERR_UNSUPPORTED;
+#else
+    pid_t child = fork_core();
+
+    if (child < 0)
+    {
+        DebugMessage(M64MSG_ERROR, "Could not fork instance: %s", strerror(errno));
+        return M64ERR_SYSTEM_FAIL;
+    }
+
+    *pid = (int)child;
+    return M64ERR_SUCCESS;
+#endif
+}
+
+int fork_snapshot_is_child(void)
+{
+    return l_fork_child;
+}
@@ -0,0 +1,53 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - fork_snapshot.h                                         *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_FORK_SNAPSHOT_H
+#define M64P_MAIN_FORK_SNAPSHOT_H
+
+#include "api/m64p_types.h"
+
+/* Snapshots taken by forking the whole process at a VI boundary, and
+ * emulator instances forked before emulation starts.
+ * Memory is shared copy-on-write between the parent and the child, so
+ * taking a snapshot costs the same whatever the size of the state.
+ *
+ * Only the emulation thread survives in the child: the core workqueue is
+ * drained before forking and restarted in the child, and the caller must
+ * make sure that no other thread (asynchronous RSP, audio ring, video or
+ * audio plugin) is involved.
+ */
+
+/* Fork at the next VI and call callback in both processes */
+m64p_error fork_snapshot_request(m64p_fork_callback callback);
+
+int fork_snapshot_pending(void);
+void fork_snapshot_run(void);
+
+/* Fork the whole core while no emulation is running, after the plugins
+ * were attached and the ROM opened, so that each process can run its own
+ * emulator without paying for the startup again. pid receives 0 in the
+ * child and the pid of the child in the parent. */
+m64p_error fork_instance(int* pid);
+
+/* Non zero in a forked child, which must not write to the parent's files */
+int fork_snapshot_is_child(void);
+
+#endif
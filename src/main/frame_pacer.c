@@ -0,0 +1,153 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - frame_pacer.c                                           *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "frame_pacer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "osal/timer.h"
+
+/* Reset the schedule when this far behind (the host cannot keep up) */
+#define FRAME_PACER_MAX_BEHIND_NS 50000000
+/* Reset the schedule when more than this many frames ahead */
+#define FRAME_PACER_MAX_AHEAD_FRAMES 3
+
+static uint64_t host_clock_get_ns(void* clock)
+{
+    return osal_monotonic_ns();
+}
+
+static void host_clock_sleep_until_ns(void* clock, uint64_t deadline_ns)
+{
+    osal_sleep_until_ns(deadline_ns);
+}
+
+const struct frame_pacer_clock_interface g_iframe_pacer_host_clock =
+{
+    host_clock_get_ns,
+    host_clock_sleep_until_ns
+};
+
+static uint64_t fake_clock_get_ns(void* clock)
+{
+    struct frame_pacer_fake_clock* fake = (struct frame_pacer_fake_clock*)clock;
+
+    fake->now_ns += fake->tick_ns;
+    return fake->now_ns;
+}
+
+static void fake_clock_sleep_until_ns(void* clock, uint64_t deadline_ns)
+{
+    struct frame_pacer_fake_clock* fake = (struct frame_pacer_fake_clock*)clock;
+
+    if (fake->now_ns < deadline_ns)
+        fake->now_ns = deadline_ns;
+    fake->now_ns += fake->sleep_overshoot_ns;
+}
+
+const struct frame_pacer_clock_interface g_iframe_pacer_fake_clock =
+{
+    fake_clock_get_ns,
+    fake_clock_sleep_until_ns
+};
+
+void init_frame_pacer(struct frame_pacer* pacer,
+                      uint64_t spin_ns,
+                      void* clock, const struct frame_pacer_clock_interface* iclock)
+{
+    memset(pacer, 0, sizeof(*pacer));
+
+    pacer->spin_ns = spin_ns;
+    pacer->clock = clock;
+    pacer->iclock = iclock;
+}
+
+void frame_pacer_wait(struct frame_pacer* pacer, uint64_t period_ns, int limit)
+{
+    uint64_t now = pacer->iclock->get_ns(pacer->clock);
+    int64_t ahead;
+
+    /* first frame, speed change or limiter turned off: restart the schedule */
+    if (!limit || !pacer->started || pacer->period_ns != period_ns) {
+        pacer->started = limit;
+        pacer->period_ns = period_ns;
+        pacer->deadline_ns = now + period_ns;
+        return;
+    }
+
+    ahead = (int64_t)(pacer->deadline_ns - now);
+
+    if (ahead < -FRAME_PACER_MAX_BEHIND_NS || ahead > (int64_t)(period_ns * FRAME_PACER_MAX_AHEAD_FRAMES)) {
+        ++pacer->resyncs;
+        pacer->deadline_ns = now + period_ns;
+        return;
+    }
+
+    if (ahead > 0) {
+        if ((uint64_t)ahead > pacer->spin_ns)
+            pacer->iclock->sleep_until_ns(pacer->clock, pacer->deadline_ns - pacer->spin_ns);
+
+        do {
+            now = pacer->iclock->get_ns(pacer->clock);
+        } while ((int64_t)(pacer->deadline_ns - now) > 0);
+    }
+    else {
+        ++pacer->late_frames;
+    }
+
+    pacer->errors_ns[pacer->error_count % FRAME_PACER_HISTORY] = (int64_t)(now - pacer->deadline_ns);
+    ++pacer->error_count;
+
+    /* a late frame shortens the next one, so that the average speed is kept */
+    pacer->deadline_ns += period_ns;
+}
+
+static int compare_int64(const void* a, const void* b)
+{
+    int64_t x = *(const int64_t*)a;
+    int64_t y = *(const int64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+void frame_pacer_get_stats(const struct frame_pacer* pacer, m64p_frame_pacing_stats* stats)
+{
+    int64_t errors[FRAME_PACER_HISTORY];
+    size_t count = (pacer->error_count < FRAME_PACER_HISTORY) ? pacer->error_count : FRAME_PACER_HISTORY;
+
+    memset(stats, 0, sizeof(*stats));
+
+    stats->samples = (uint32_t)count;
+    stats->late_frames = pacer->late_frames;
+    stats->resyncs = pacer->resyncs;
+    stats->period_ns = (uint32_t)pacer->period_ns;
+
+    if (count == 0)
+        return;
+
+    memcpy(errors, pacer->errors_ns, count * sizeof(errors[0]));
+    qsort(errors, count, sizeof(errors[0]), compare_int64);
+
+    stats->error_p50_ns = errors[(count - 1) * 50 / 100];
+    stats->error_p99_ns = errors[(count - 1) * 99 / 100];
+    stats->error_max_ns = errors[count - 1];
+}
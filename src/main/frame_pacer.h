@@ -0,0 +1,88 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - frame_pacer.h                                           *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_FRAME_PACER_H
+#define M64P_MAIN_FRAME_PACER_H
+
+#include <stdint.h>
+
+#include "api/m64p_types.h"
+
+struct frame_pacer_clock_interface
+{
+    /* Returns a monotonic time in nanoseconds
+     */
+    uint64_t (*get_ns)(void* clock);
+
+    /* Sleep until the monotonic time deadline_ns (may return early)
+     */
+    void (*sleep_until_ns)(void* clock, uint64_t deadline_ns);
+};
+
+/* Host clock, clock parameter is unused */
+extern const struct frame_pacer_clock_interface g_iframe_pacer_host_clock;
+
+/* Fake clock for headless runs: each read advances time by tick_ns and
+ * each sleep jumps to the deadline plus sleep_overshoot_ns.
+ * tick_ns must be non zero.
+ */
+struct frame_pacer_fake_clock
+{
+    uint64_t now_ns;
+    uint64_t tick_ns;
+    uint64_t sleep_overshoot_ns;
+};
+
+extern const struct frame_pacer_clock_interface g_iframe_pacer_fake_clock;
+
+enum { FRAME_PACER_HISTORY = 256 };
+
+/* Frames paced on an absolute schedule: frame n is released at
+ * start + n * period, sleeping until spin_ns before the deadline and
+ * spinning for the rest.
+ */
+struct frame_pacer
+{
+    uint64_t spin_ns;
+    uint64_t period_ns;
+    uint64_t deadline_ns;
+    int started;
+
+    /* release time minus deadline of the last paced frames */
+    int64_t errors_ns[FRAME_PACER_HISTORY];
+    uint32_t error_count;
+    uint32_t late_frames;
+    uint32_t resyncs;
+
+    void* clock;
+    const struct frame_pacer_clock_interface* iclock;
+};
+
+void init_frame_pacer(struct frame_pacer* pacer,
+                      uint64_t spin_ns,
+                      void* clock, const struct frame_pacer_clock_interface* iclock);
+
+/* Wait for the deadline of the current frame, if limit is set */
+void frame_pacer_wait(struct frame_pacer* pacer, uint64_t period_ns, int limit);
+
+void frame_pacer_get_stats(const struct frame_pacer* pacer, m64p_frame_pacing_stats* stats);
+
+#endif
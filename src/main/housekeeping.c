@@ -0,0 +1,101 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - housekeeping.c                                          *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "housekeeping.h"
+
+#include <string.h>
+
+#include "osal/timer.h"
+
+void housekeeping_reset(struct housekeeping_task* tasks, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i) {
+        tasks[i].next_ns = 0;
+        tasks[i].runs = 0;
+        tasks[i].skips = 0;
+        tasks[i].total_ns = 0;
+        tasks[i].max_ns = 0;
+    }
+}
+
+void housekeeping_run(struct housekeeping_task* tasks, size_t count)
+{
+    size_t i;
+    uint64_t now = osal_monotonic_ns();
+
+    for (i = 0; i < count; ++i) {
+        struct housekeeping_task* task = &tasks[i];
+        uint64_t end, elapsed;
+
+        switch (task->rate)
+        {
+        case HOUSEKEEPING_INTERVAL:
+            if (now < task->next_ns) {
+                ++task->skips;
+                continue;
+            }
+            break;
+        case HOUSEKEEPING_ON_DEMAND:
+            if (!task->pending()) {
+                ++task->skips;
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+
+        task->run();
+
+        /* the end of a task is the start of the next one */
+        end = osal_monotonic_ns();
+        elapsed = end - now;
+        now = end;
+
+        ++task->runs;
+        task->total_ns += elapsed;
+        if (elapsed > task->max_ns)
+            task->max_ns = elapsed;
+
+        if (task->rate == HOUSEKEEPING_INTERVAL)
+            task->next_ns = now + (uint64_t)task->interval_ms * 1000000;
+    }
+}
+
+void housekeeping_get_stats(const struct housekeeping_task* tasks, size_t count,
+                            m64p_housekeeping_stats* stats, size_t max)
+{
+    size_t i;
+
+    memset(stats, 0, max * sizeof(*stats));
+
+    for (i = 0; i < count && i < max; ++i) {
+        strncpy(stats[i].name, tasks[i].name, sizeof(stats[i].name) - 1);
+        stats[i].rate = (uint32_t)tasks[i].rate;
+        stats[i].interval_ms = tasks[i].interval_ms;
+        stats[i].runs = tasks[i].runs;
+        stats[i].skips = tasks[i].skips;
+        stats[i].total_ns = tasks[i].total_ns;
+        stats[i].max_ns = tasks[i].max_ns;
+    }
+}
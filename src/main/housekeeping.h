@@ -0,0 +1,66 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - housekeeping.h                                          *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_HOUSEKEEPING_H
+#define M64P_MAIN_HOUSEKEEPING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "api/m64p_types.h"
+
+enum housekeeping_rate
+{
+    /* run on every VI */
+    HOUSEKEEPING_EVERY_VI,
+    /* run on the first VI after interval_ms elapsed since the last run */
+    HOUSEKEEPING_INTERVAL,
+    /* run on the VIs where pending() returns non zero */
+    HOUSEKEEPING_ON_DEMAND
+};
+
+/* Work done by the core between frames (see new_vi) */
+struct housekeeping_task
+{
+    const char* name;
+    void (*run)(void);
+    enum housekeeping_rate rate;
+    unsigned int interval_ms;
+    int (*pending)(void);
+
+    uint64_t next_ns;
+
+    uint64_t runs;
+    uint64_t skips;
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
+
+void housekeeping_reset(struct housekeeping_task* tasks, size_t count);
+
+/* Run the tasks which are due, in order */
+void housekeeping_run(struct housekeeping_task* tasks, size_t count);
+
+/* Fill stats with up to max entries and zero the remaining ones */
+void housekeeping_get_stats(const struct housekeeping_task* tasks, size_t count,
+                            m64p_housekeeping_stats* stats, size_t max);
+
+#endif
@@ -44,6 +44,7 @@
 #include "api/m64p_types.h"
 #include "api/m64p_vidext.h"
 #include "api/vidext.h"
+#include "audio_ring.h"
 #include "backends/api/audio_out_backend.h"
 #include "backends/api/clock_backend.h"
 #include "backends/api/controller_input_backend.h"
@@ -64,19 +65,34 @@
 #include "device/controllers/paks/transferpak.h"
 #include "device/gb/gb_cart.h"
 #include "device/pif/bootrom_hle.h"
+#include "device/r4300/interrupt.h"
+#if defined(COUNT_INSTR)
+#include "device/r4300/instr_counters.h"
+#endif
 #include "eventloop.h"
+#include "frame_pacer.h"
+#include "footprint.h"
+#include "fork_snapshot.h"
+#include "housekeeping.h"
+#include "memtrace.h"
+#include "rewind.h"
 #include "main.h"
 #include "osal/files.h"
 #include "osal/preproc.h"
+#include "osal/timer.h"
 #include "osd/osd.h"
 #include "plugin/plugin.h"
-#if defined(PROFILE)
 #include "profile.h"
-#endif
+#include "movie.h"
 #include "rom.h"
+#include "rsp_thread.h"
+#include "sampler.h"
 #include "savestates.h"
 #include "screenshot.h"
+#include "state_container.h"
+#include "trace.h"
 #include "util.h"
+#include "workqueue.h"
 #include "netplay.h"
 
 #ifdef DBG
@@ -90,6 +106,8 @@
 /* version number for Core config section */
 #define CONFIG_PARAM_VERSION 1.01
 
+#define ARRAY_SIZE(x) (sizeof(x)/sizeof((x)[0]))
+
 /** globals **/
 m64p_handle g_CoreConfig = NULL;
 
@@ -123,6 +141,11 @@ static int   l_TakeScreenshot = 0;       // Tell OSD Rendering callback to take
 static int   l_SpeedFactor = 100;        // percentage of nominal game speed at which emulator is running
 static int   l_FrameAdvance = 0;         // variable to check if we pause on next frame
 static int   l_MainSpeedLimit = 1;       // insert delay during vi_interrupt to keep speed at real-time
+static struct frame_pacer l_FramePacer;   // absolute deadline scheduling of the speed limiter
+static uint64_t l_ViCount = 0;           // VIs emulated since the start of the run
+static uint64_t l_ViLimit = 0;           // stop the emulation after this many VIs, 0 for no limit
+static uint64_t l_RunStartNs = 0;        // wall time of the emulation loop
+static uint64_t l_RunEndNs = 0;
 
 static osd_message_t *l_msgVol = NULL;
 static osd_message_t *l_msgFF = NULL;
@@ -380,10 +403,12 @@ void main_message(m64p_msg_level level, unsigned int corner, const char *format,
 
 static void main_check_inputs(void)
 {
+    timed_section_start(TIMED_SECTION_INPUT);
 #ifdef WITH_LIRC
     lircCheckInput();
 #endif
     SDL_PumpEvents();
+    timed_section_end(TIMED_SECTION_INPUT);
 }
 
 /*********************************************************************************************************
@@ -427,6 +452,10 @@ int main_set_core_defaults(void)
     ConfigSetDefaultBool(g_CoreConfig, "DisableExtraMem", 0, "Disable 4MB expansion RAM pack. May be necessary for some games");
     ConfigSetDefaultInt(g_CoreConfig, "CountPerOp", 0, "Force number of cycles per emulated instruction");
     ConfigSetDefaultInt(g_CoreConfig, "CountPerOpDenomPot", 0, "Reduce number of cycles per update by power of two when set greater than 0 (overclock)");
+    ConfigSetDefaultInt(g_CoreConfig, "SaveStateThreads", 0, "Number of threads compressing and decompressing save states (0: one per CPU, 1: single gzip stream as in older versions)");
+    ConfigSetDefaultInt(g_CoreConfig, "SaveFlushInterval", 1000, "Interval in milliseconds at which changes to save files (EEPROM, SRAM, FlashRAM, memory paks) are written back from a background thread, existing files being memory mapped (0: write them synchronously on each change)");
+    ConfigSetDefaultBool(g_CoreConfig, "RomCache", 1, "Remember the MD5 of opened ROM and disk images in the user cache directory, so that they aren't hashed again on the next start");
+    ConfigSetDefaultBool(g_CoreConfig, "RomCacheVerify", 1, "Recompute the MD5 of images found in the ROM cache in the background, and correct the cache if it was stale");
     ConfigSetDefaultBool(g_CoreConfig, "AutoStateSlotIncrement", 0, "Increment the save state slot after each save operation");
     ConfigSetDefaultInt(g_CoreConfig, "CurrentStateSlot", 0, "Save state slot (0-9) to use when saving/loading the emulator state");
     ConfigSetDefaultBool(g_CoreConfig, "EnableDebugger", 0, "Activate the R4300 debugger when ROM execution begins, if core was built with Debugger support");
@@ -436,6 +465,18 @@ int main_set_core_defaults(void)
     ConfigSetDefaultString(g_CoreConfig, "SharedDataPath", "", "Path to a directory to search when looking for shared data files");
     ConfigSetDefaultBool(g_CoreConfig, "RandomizeInterrupt", 1, "Randomize PI/SI Interrupt Timing");
     ConfigSetDefaultInt(g_CoreConfig, "SiDmaDuration", -1, "Duration of SI DMA (-1: use per game settings)");
+    ConfigSetDefaultBool(g_CoreConfig, "AsyncRSP", 0, "Run RSP tasks other than display lists on a separate thread (experimental, ignored during netplay)");
+    ConfigSetDefaultInt(g_CoreConfig, "EventPollInterval", 4, "Minimum time in milliseconds between two polls of the SDL event queue, 0 to poll on every VI");
+    ConfigSetDefaultBool(g_CoreConfig, "Rewind", 0, "Keep a history of snapshots to rewind emulation (ignored during netplay)");
+    ConfigSetDefaultInt(g_CoreConfig, "RewindBufferSize", 64, "Memory in megabytes used for the rewind history, in addition to about 48MB of work buffers");
+    ConfigSetDefaultInt(g_CoreConfig, "RewindInterval", 2, "Number of VIs between two rewind snapshots");
+    ConfigSetDefaultBool(g_CoreConfig, "AudioRingBuffer", 0, "Queue audio samples in a core ring buffer and feed the audio plugin from a separate thread (takes effect when the audio plugin is attached)");
+    ConfigSetDefaultString(g_CoreConfig, "TraceFile", "", "Record a timeline of plugin calls, RSP tasks, recompilation, interrupts and background jobs during emulation into this file, in Chrome trace-event format (blank: no trace)");
+    ConfigSetDefaultInt(g_CoreConfig, "TraceBufferSize", 262144, "Number of trace events kept per thread, older events are overwritten");
+    ConfigSetDefaultInt(g_CoreConfig, "ProfilerRate", 0, "Sample the emulation thread this many times per second of CPU time and report the hottest r4300 code when emulation stops (0: disabled, Linux only)");
+    ConfigSetDefaultString(g_CoreConfig, "ProfilerFile", "", "Write the sampling profiler report into this file (blank: write the top entries to the log)");
+    ConfigSetDefaultString(g_CoreConfig, "MemTraceFile", "", "Record the r4300 loads and stores and the DMA transfers during emulation into this gzip compressed file, for tools/memtrace_summary (blank: no trace, slows down emulation)");
+    ConfigSetDefaultInt(g_CoreConfig, "MemTraceBufferSize", 1048576, "Number of memory accesses buffered per thread before the recording waits for the trace writer");
     ConfigSetDefaultString(g_CoreConfig, "GbCameraVideoCaptureBackend1", DEFAULT_VIDEO_CAPTURE_BACKEND, "Gameboy Camera Video Capture backend");
     ConfigSetDefaultInt(g_CoreConfig, "SaveDiskFormat", 1, "Disk Save Format (0: Full Disk Copy (*.ndr/*.d6r), 1: RAM Area Only (*.ram))");
     ConfigSetDefaultInt(g_CoreConfig, "SaveFilenameFormat", 1, "Save (SRAM/State) Filename Format (0: ROM Header Name, 1: Automatic (including partial MD5 hash))");
@@ -659,7 +700,7 @@ void main_state_inc_slot(void)
 
 void main_state_load(const char *filename)
 {
-    if (netplay_is_init())
+    if (netplay_is_init() || movie_is_active())
         return;
 
     if (filename == NULL) // Save to slot
@@ -679,6 +720,59 @@ void main_state_save(int format, const char *filename)
         savestates_set_job(savestates_job_save, (savestates_type)format, filename);
 }
 
+m64p_error main_state_load_memory(void *buffer, int size)
+{
+    if (netplay_is_init() || movie_is_active())
+        return M64ERR_INVALID_STATE;
+
+    savestates_set_memory_job(savestates_job_load, buffer, (size_t)size);
+    return M64ERR_SUCCESS;
+}
+
+m64p_error main_state_save_memory(void *buffer, int size)
+{
+    if (netplay_is_init())
+        return M64ERR_INVALID_STATE;
+
+    savestates_set_memory_job(savestates_job_save, buffer, (size_t)size);
+    return M64ERR_SUCCESS;
+}
+
+m64p_error main_state_read_section(m64p_state_section *section)
+{
+    struct state_chunk chunk;
+    size_t size = 0;
+    FILE *f;
+    int ret;
+
+    f = osal_file_open(section->path, "rb");
+    if (f == NULL)
+        return M64ERR_FILES;
+
+    ret = state_container_find(f, section->tag, &size);
+    if (ret <= 0)
+    {
+        fclose(f);
+        return (ret == 0) ? M64ERR_INPUT_NOT_FOUND : M64ERR_INPUT_INVALID;
+    }
+
+    if (section->buffer == NULL || section->size < size)
+    {
+        fclose(f);
+        section->size = (uint32_t)size;
+        return (section->buffer == NULL) ? M64ERR_SUCCESS : M64ERR_INPUT_INVALID;
+    }
+
+    chunk.tag = section->tag;
+    chunk.data = section->buffer;
+    chunk.size = size;
+    ret = state_container_read(f, &chunk, 1, 1);
+    fclose(f);
+
+    section->size = (uint32_t)size;
+    return (ret == 1) ? M64ERR_SUCCESS : M64ERR_FILES;
+}
+
 m64p_error main_core_state_query(m64p_core_param param, int *rval)
 {
     switch (param)
@@ -717,6 +811,18 @@ m64p_error main_core_state_query(m64p_core_param param, int *rval)
             *rval = (width << 16) + height;
             break;
         }
+        case M64CORE_STATE_MEMORY_SIZE:
+            *rval = (int)savestates_memory_size();
+            break;
+        case M64CORE_VI_LIMIT:
+            *rval = (int)l_ViLimit;
+            break;
+        case M64CORE_MOVIE_STATE:
+            *rval = movie_get_state();
+            break;
+        case M64CORE_TIMING_COUNTERS:
+            *rval = timed_sections_requested();
+            break;
         case M64CORE_AUDIO_VOLUME:
         {
             if (!g_EmulatorRunning)
@@ -825,6 +931,14 @@ m64p_error main_core_state_set(m64p_core_param param, int val)
                 return M64ERR_INVALID_STATE;
             event_set_gameshark(val);
             return M64ERR_SUCCESS;
+        case M64CORE_VI_LIMIT:
+            if (val < 0)
+                return M64ERR_INPUT_INVALID;
+            l_ViLimit = (uint64_t)val;
+            return M64ERR_SUCCESS;
+        case M64CORE_TIMING_COUNTERS:
+            timed_sections_enable(val);
+            return M64ERR_SUCCESS;
         // these are only used for callbacks; they cannot be queried or set
         case M64CORE_STATE_LOADCOMPLETE:
         case M64CORE_STATE_SAVECOMPLETE:
@@ -847,6 +961,27 @@ m64p_error main_read_screen(void *pixels, int bFront)
     return M64ERR_SUCCESS;
 }
 
+m64p_error main_get_rdram_dirty_pages(uint32_t* bitmap, int size)
+{
+    rdram_fetch_dirty_pages(&g_dev.rdram, bitmap, (size_t)size / sizeof(uint32_t));
+    return M64ERR_SUCCESS;
+}
+
+m64p_error main_get_audio_ring_stats(m64p_audio_ring_stats* stats)
+{
+    if (!g_audio_plugin_ring_enabled)
+        return M64ERR_INVALID_STATE;
+
+    audio_ring_get_stats(stats);
+    return M64ERR_SUCCESS;
+}
+
+m64p_error main_get_frame_pacing_stats(m64p_frame_pacing_stats* stats)
+{
+    frame_pacer_get_stats(&l_FramePacer, stats);
+    return M64ERR_SUCCESS;
+}
+
 m64p_error main_volume_up(void)
 {
     int level = 0;
@@ -897,6 +1032,10 @@ int main_volume_get_muted(void)
 
 m64p_error main_reset(int do_hard_reset)
 {
+    /* movies reset on a VI boundary */
+    if (movie_defer_reset(do_hard_reset))
+        return M64ERR_SUCCESS;
+
     if (do_hard_reset) {
         hard_reset_device(&g_dev);
     }
@@ -963,71 +1102,18 @@ void new_frame(void)
 
 static void apply_speed_limiter(void)
 {
-    static unsigned long totalVIs = 0;
-    static int resetOnce = 0;
-    static int lastSpeedFactor = 100;
-    static unsigned int StartFPSTime = 0;
-    static const double defaultSpeedFactor = 100.0;
-    unsigned int CurrentFPSTime = SDL_GetTicks();
+    /* calculate frame duration based upon ROM setting (50/60hz) and mupen64plus speed adjustment */
+    uint64_t period_ns = (UINT64_C(1000000000) * 100) / ((uint64_t)g_dev.vi.expected_refresh_rate * l_SpeedFactor);
 
-    // calculate frame duration based upon ROM setting (50/60hz) and mupen64plus speed adjustment
-    const double VILimitMilliseconds = 1000.0 / g_dev.vi.expected_refresh_rate;
-    const double SpeedFactorMultiple = defaultSpeedFactor/l_SpeedFactor;
-    const double AdjustedLimit = VILimitMilliseconds * SpeedFactorMultiple;
-
-    //if this is the first time or we are resuming from pause
-    if(StartFPSTime == 0 || !resetOnce || lastSpeedFactor != l_SpeedFactor)
-    {
-       StartFPSTime = CurrentFPSTime;
-       totalVIs = 0;
-       resetOnce = 1;
-    }
-    else
-    {
-        ++totalVIs;
-    }
-
-    lastSpeedFactor = l_SpeedFactor;
-
-#if defined(PROFILE)
     timed_section_start(TIMED_SECTION_IDLE);
-#endif
 
 #ifdef DBG
     if(g_DebuggerActive) DebuggerCallback(DEBUG_UI_VI, 0);
 #endif
 
-    double totalElapsedGameTime = AdjustedLimit*totalVIs;
-    double elapsedRealTime = CurrentFPSTime - StartFPSTime;
-    double sleepTime = totalElapsedGameTime - elapsedRealTime;
-
-    //Reset if the sleep needed is an unreasonable value
-    static const double minSleepNeeded = -50;
-    static const double maxSleepNeeded = 50;
-    if(sleepTime < minSleepNeeded || sleepTime > (maxSleepNeeded*SpeedFactorMultiple))
-    {
-       resetOnce = 0;
-    }
-
-    if (sleepTime < minSleepNeeded) {
-        totalVIs += (unsigned long)(minSleepNeeded/AdjustedLimit);
-    }
-
-    if(l_MainSpeedLimit && sleepTime > 0 && sleepTime < maxSleepNeeded*SpeedFactorMultiple)
-    {
-        while(sleepTime >= 0) {
-            SDL_Delay((unsigned int) sleepTime);
-
-            CurrentFPSTime = SDL_GetTicks();
-            elapsedRealTime = CurrentFPSTime - StartFPSTime;
-            sleepTime = totalElapsedGameTime - elapsedRealTime;
-        }
-    }
-
+    frame_pacer_wait(&l_FramePacer, period_ns, l_MainSpeedLimit);
 
-#if defined(PROFILE)
     timed_section_end(TIMED_SECTION_IDLE);
-#endif
 }
 
 /* TODO: make a GameShark module and move that there */
@@ -1057,26 +1143,218 @@ static void pause_loop(void)
         {
             SDL_Delay(10);
             main_check_inputs();
+            if (footprint_pending())
+                footprint_run();
         }
     }
 }
 
+static void housekeeping_cheats(void)
+{
+    timed_section_start(TIMED_SECTION_CHEATS);
+    gs_apply_cheats(&g_cheat_ctx);
+    timed_section_end(TIMED_SECTION_CHEATS);
+}
+
+static int housekeeping_pause_pending(void)
+{
+    return g_rom_pause;
+}
+
+static void housekeeping_netplay_sync(void)
+{
+    netplay_check_sync(&g_dev.r4300.cp0);
+}
+
+/* per VI work, in execution order.
+ * Interval tasks must tolerate being skipped for many VIs in fast-forward */
+static struct housekeeping_task l_housekeeping[] =
+{
+    { "cheats",        housekeeping_cheats,       HOUSEKEEPING_EVERY_VI,  0, NULL },
+    { "speed_limiter", apply_speed_limiter,       HOUSEKEEPING_EVERY_VI,  0, NULL },
+    { "check_inputs",  main_check_inputs,         HOUSEKEEPING_INTERVAL,  0, NULL },
+    { "footprint",     footprint_run,             HOUSEKEEPING_ON_DEMAND, 0, footprint_pending },
+    { "pause",         pause_loop,                HOUSEKEEPING_ON_DEMAND, 0, housekeeping_pause_pending },
+    { "netplay_sync",  housekeeping_netplay_sync, HOUSEKEEPING_EVERY_VI,  0, NULL },
+    { "rewind",        rewind_vi,                 HOUSEKEEPING_EVERY_VI,  0, NULL },
+    { "fork_snapshot", fork_snapshot_run,         HOUSEKEEPING_ON_DEMAND, 0, fork_snapshot_pending },
+    { "movie",         movie_vi,                  HOUSEKEEPING_ON_DEMAND, 0, movie_is_active },
+    { "profiler",      sampler_run_request,       HOUSEKEEPING_ON_DEMAND, 0, sampler_request_pending },
+};
+
+enum { HOUSEKEEPING_CHECK_INPUTS = 2 };
+
 /* called on vertical interrupt.
  * Allow the core to perform various things */
 void new_vi(void)
 {
-#if defined(PROFILE)
     timed_sections_refresh();
+
+    housekeeping_run(l_housekeeping, ARRAY_SIZE(l_housekeeping));
+
+    if (++l_ViCount == l_ViLimit)
+        main_stop();
+}
+
+m64p_error main_get_housekeeping_stats(m64p_housekeeping_stats* stats, int size)
+{
+    housekeeping_get_stats(l_housekeeping, ARRAY_SIZE(l_housekeeping), stats, (size_t)size / sizeof(*stats));
+    return M64ERR_SUCCESS;
+}
+
+m64p_error main_rewind_step(int steps)
+{
+    if (!rewind_is_enabled() || movie_is_active())
+        return M64ERR_INVALID_STATE;
+
+    rewind_step((unsigned int)steps);
+    return M64ERR_SUCCESS;
+}
+
+m64p_error main_get_rewind_stats(m64p_rewind_stats* stats)
+{
+    if (!rewind_is_enabled())
+        return M64ERR_INVALID_STATE;
+
+    rewind_get_stats(stats);
+    return M64ERR_SUCCESS;
+}
+
+m64p_error main_get_run_stats(m64p_run_stats* stats)
+{
+    uint64_t end = g_EmulatorRunning ? osal_monotonic_ns() : l_RunEndNs;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->vis = l_ViCount;
+    stats->compiled_blocks = g_dev.r4300.compiled_blocks;
+    stats->run_ns = end - l_RunStartNs;
+    stats->emumode = (uint32_t)g_dev.r4300.emumode;
+
+    if (timed_sections_requested())
+    {
+        struct timed_section_stats sections[NUM_TIMED_SECTIONS];
+        timed_sections_get(sections);
+        stats->gfx_ns = sections[TIMED_SECTION_GFX].inclusive_ns;
+        stats->audio_ns = sections[TIMED_SECTION_AUDIO].inclusive_ns;
+        stats->compiler_ns = sections[TIMED_SECTION_COMPILER].inclusive_ns;
+        stats->idle_ns = sections[TIMED_SECTION_IDLE].inclusive_ns;
+        stats->timed = 1;
+    }
+
+    return M64ERR_SUCCESS;
+}
+
+m64p_error main_get_timing_stats(m64p_timing_stats* stats, int size)
+{
+    struct timed_section_stats sections[NUM_TIMED_SECTIONS];
+    size_t count = (size_t)size / sizeof(*stats);
+    size_t i;
+
+    timed_sections_get(sections);
+
+    memset(stats, 0, count * sizeof(*stats));
+    for (i = 0; i < count && i < NUM_TIMED_SECTIONS; ++i)
+    {
+        strncpy(stats[i].name, sections[i].name, sizeof(stats[i].name) - 1);
+        stats[i].parent = sections[i].parent;
+        stats[i].calls = sections[i].calls;
+        stats[i].inclusive_ns = sections[i].inclusive_ns;
+        stats[i].exclusive_ns = sections[i].exclusive_ns;
+    }
+
+    return M64ERR_SUCCESS;
+}
+
+m64p_error main_fork_snapshot(m64p_fork_callback callback)
+{
+    /* only the emulation thread survives a fork */
+    if (netplay_is_init() || movie_is_active() || g_dev.sp.async_tasks || g_audio_plugin_ring_enabled)
+        return M64ERR_INVALID_STATE;
+
+    if (plugin_is_attached(M64PLUGIN_GFX) || plugin_is_attached(M64PLUGIN_AUDIO))
+    {
+        DebugMessage(M64MSG_ERROR, "Forked snapshots require the dummy video and audio plugins");
+        return M64ERR_INVALID_STATE;
+    }
+
+    return fork_snapshot_request(callback);
+}
+
+m64p_error main_fork_instance(int* pid)
+{
+    if (netplay_is_init() || movie_is_active())
+        return M64ERR_INVALID_STATE;
+
+    return fork_instance(pid);
+}
+
+m64p_error main_movie_record(const char* path)
+{
+    if (netplay_is_init())
+        return M64ERR_INVALID_STATE;
+
+    return movie_record(path);
+}
+
+m64p_error main_movie_play(const char* path)
+{
+    if (netplay_is_init())
+        return M64ERR_INVALID_STATE;
+
+    return movie_play(path);
+}
+
+m64p_error main_profiler_report(const char* path)
+{
+    return sampler_request_report(path);
+}
+
+m64p_error main_export_instr_counters(const char* path, m64p_export_format format)
+{
+#if defined(COUNT_INSTR)
+    return instr_counters_export(path, format);
+#else
+    return M64ERR_UNSUPPORTED;
 #endif
+}
 
-    gs_apply_cheats(&g_cheat_ctx);
+m64p_error main_get_interrupt_stats(m64p_interrupt_stats* stats)
+{
+    struct interrupt_vi_stats total;
+    size_t i;
 
-    apply_speed_limiter();
-    main_check_inputs();
+    memset(stats, 0, sizeof(*stats));
+    stats->vis = get_interrupt_stats(&g_dev.r4300.cp0, &total);
+    stats->count_per_op = g_dev.r4300.cp0.count_per_op;
+    stats->count_per_op_denom_pot = g_dev.r4300.cp0.count_per_op_denom_pot;
+    stats->checks = total.checks;
+    stats->check_raised = total.check_raised;
 
-    pause_loop();
+    for (i = 0; i <= INTERRUPT_NODES_POOL_CAPACITY; ++i) {
+        stats->queue_length[i] = total.queue_length[i];
+    }
 
-    netplay_check_sync(&g_dev.r4300.cp0);
+    for (i = 0; i < CP0_INTERRUPT_HANDLERS_COUNT; ++i)
+    {
+        strncpy(stats->types[i].name, get_interrupt_name(i), sizeof(stats->types[i].name) - 1);
+        stats->types[i].scheduled = total.scheduled[i];
+        stats->types[i].dispatched = total.dispatched[i];
+        stats->types[i].latency_cycles = total.latency[i];
+        stats->types[i].max_latency_cycles = total.max_latency[i];
+    }
+
+    return M64ERR_SUCCESS;
+}
+
+m64p_error main_get_memory_footprint(m64p_memory_footprint* entries, int size)
+{
+    return footprint_query(entries, size);
+}
+
+m64p_error main_release_caches(void)
+{
+    footprint_request_release();
+    return M64ERR_SUCCESS;
 }
 
 static void main_switch_pak(int control_id)
@@ -1538,6 +1816,12 @@ static void release_gb_ram(void* opaque)
     memset(&data->ram_fstorage, 0, sizeof(data->ram_fstorage));
 }
 
+/* real time clocks of the carts, derived from the emulated time during movies */
+static const struct clock_backend_interface* rtc_iclock(void)
+{
+    return movie_is_active() ? &g_imovie_clock : &g_iclock_ctime_plus_delta;
+}
+
 void main_change_gb_cart(int control_id)
 {
     struct transferpak* tpk = &g_dev.transferpaks[control_id];
@@ -1551,7 +1835,7 @@ void main_change_gb_cart(int control_id)
     init_gb_cart(gb_cart,
             data, init_gb_rom, release_gb_rom,
             data, init_gb_ram, release_gb_ram,
-            NULL, &g_iclock_ctime_plus_delta,
+            NULL, rtc_iclock(),
             &data->control_id, &g_irumble_backend_plugin_compat,
             data->gbcam_backend, data->igbcam_backend);
 
@@ -1587,6 +1871,7 @@ m64p_error main_run(void)
     int32_t si_dma_duration;
     int32_t no_compiled_jump;
     int32_t randomize_interrupt;
+    int32_t async_rsp_tasks;
     struct file_storage eep;
     struct file_storage fla;
     struct file_storage sra;
@@ -1617,7 +1902,7 @@ m64p_error main_run(void)
     }
 
     /* Seed MPK ID gen using current time */
-    uint64_t mpk_seed = !netplay_is_init() ? (uint64_t)time(NULL) : 0;
+    uint64_t mpk_seed = (!netplay_is_init() && !movie_is_active()) ? (uint64_t)time(NULL) : 0;
     l_mpk_idgen = xoshiro256pp_seed(mpk_seed);
 
     /* take the r4300 emulator mode from the config file at this point and cache it in a global variable */
@@ -1627,8 +1912,10 @@ m64p_error main_run(void)
     savestates_set_autoinc_slot(ConfigGetParamBool(g_CoreConfig, "AutoStateSlotIncrement"));
     savestates_select_slot(ConfigGetParamInt(g_CoreConfig, "CurrentStateSlot"));
     no_compiled_jump = ConfigGetParamBool(g_CoreConfig, "NoCompiledJump");
-    //We disable any randomness for netplay
-    randomize_interrupt = !netplay_is_init() ? ConfigGetParamBool(g_CoreConfig, "RandomizeInterrupt") : 0;
+    //We disable any randomness for netplay and movies
+    randomize_interrupt = (!netplay_is_init() && !movie_is_active()) ? ConfigGetParamBool(g_CoreConfig, "RandomizeInterrupt") : 0;
+    //Asynchronous RSP tasks are not guaranteed to be deterministic
+    async_rsp_tasks = (!netplay_is_init() && !movie_is_active()) ? ConfigGetParamBool(g_CoreConfig, "AsyncRSP") : 0;
     count_per_op = ConfigGetParamInt(g_CoreConfig, "CountPerOp");
     count_per_op_denom_pot = ConfigGetParamInt(g_CoreConfig, "CountPerOpDenomPot");
 
@@ -1650,6 +1937,9 @@ m64p_error main_run(void)
     //During netplay, player 1 is the source of truth for these settings
     netplay_sync_settings(&count_per_op, &count_per_op_denom_pot, &disable_extra_mem, &si_dma_duration, &emumode, &no_compiled_jump);
 
+    //Movies are replayed with the settings they were recorded with, except for the emulator
+    movie_sync_settings(&count_per_op, &count_per_op_denom_pot, &disable_extra_mem, &si_dma_duration);
+
     rdram_size = (disable_extra_mem == 0) ? 0x800000 : 0x400000;
 
     cheat_add_hacks(&g_cheat_ctx, ROM_PARAMS.cheats);
@@ -1705,6 +1995,11 @@ m64p_error main_run(void)
     /* open GB cam video device */
     igbcam_backend->open(gbcam_backend, M64282FP_SENSOR_W, M64282FP_SENSOR_H);
 
+    /* write back save files in the background, except in forked processes
+     * which don't write to the save files of their parent */
+    if (!netplay_is_init() && !fork_snapshot_is_child() && ConfigGetParamInt(g_CoreConfig, "SaveFlushInterval") > 0)
+        file_storage_flusher_start((unsigned int)ConfigGetParamInt(g_CoreConfig, "SaveFlushInterval"));
+
     /* open storage files, provide default content if not present */
     open_mpk_file(&mpk);
     open_eep_file(&eep);
@@ -1719,7 +2014,7 @@ m64p_error main_run(void)
     /* try to load DD disk first, if that succeeds, pass the region to load_dd_rom */
     if (load_dd_disk(&dd_disk, &dd_idisk))
     {
-        dd_rtc_iclock = &g_iclock_ctime_plus_delta;
+        dd_rtc_iclock = rtc_iclock();
         load_dd_rom((uint8_t*)mem_base_u32(g_mem_base, MM_DD_ROM), &dd_rom_size, &dd_disk.region);
     }
     else
@@ -1849,7 +2144,7 @@ m64p_error main_run(void)
                     init_gb_cart(&g_dev.gb_carts[i],
                             &l_gb_carts_data[i], init_gb_rom, release_gb_rom,
                             &l_gb_carts_data[i], init_gb_ram, release_gb_ram,
-                            NULL, &g_iclock_ctime_plus_delta,
+                            NULL, rtc_iclock(),
                             &l_gb_carts_data[i].control_id, &g_irumble_backend_plugin_compat,
                             l_gb_carts_data[i].gbcam_backend, l_gb_carts_data[i].igbcam_backend);
 
@@ -1904,12 +2199,15 @@ m64p_error main_run(void)
                 no_compiled_jump,
                 randomize_interrupt,
                 g_start_address,
-                &g_dev.ai, &g_iaudio_out_backend_plugin_compat, ((float)ROM_SETTINGS.aidmamodifier / 100.0),
+                async_rsp_tasks,
+                (g_audio_plugin_ring_enabled) ? NULL : &g_dev.ai,
+                (g_audio_plugin_ring_enabled) ? &g_iaudio_out_backend_ring : &g_iaudio_out_backend_plugin_compat,
+                ((float)ROM_SETTINGS.aidmamodifier / 100.0),
                 si_dma_duration,
                 rdram_size,
                 joybus_devices, ijoybus_devices,
                 vi_clock_from_tv_standard(ROM_PARAMS.systemtype), vi_expected_refresh_rate_from_tv_standard(ROM_PARAMS.systemtype),
-                NULL, &g_iclock_ctime_plus_delta,
+                NULL, rtc_iclock(),
                 g_rom_size,
                 eeprom_type,
                 &eep, &g_ifile_storage,
@@ -1941,6 +2239,12 @@ m64p_error main_run(void)
     /* initialize frame counter */
     l_CurrentFrame = 0;
 
+    init_frame_pacer(&l_FramePacer, OSAL_TIMER_SLEEP_SLACK_NS, NULL, &g_iframe_pacer_host_clock);
+
+    housekeeping_reset(l_housekeeping, ARRAY_SIZE(l_housekeeping));
+    footprint_reset();
+    l_housekeeping[HOUSEKEEPING_CHECK_INPUTS].interval_ms = (unsigned int)ConfigGetParamInt(g_CoreConfig, "EventPollInterval");
+
     /* initialize the on-screen display */
     if (ConfigGetParamBool(g_CoreConfig, "OnScreenDisplay"))
     {
@@ -1968,11 +2272,76 @@ m64p_error main_run(void)
     g_EmulatorRunning = 1;
     StateChanged(M64CORE_EMU_STATE, M64EMU_RUNNING);
 
+    if (async_rsp_tasks && rsp_thread_init() != 0)
+    {
+        DebugMessage(M64MSG_WARNING, "Falling back to synchronous RSP tasks");
+        g_dev.sp.async_tasks = 0;
+    }
+
+    if (g_audio_plugin_ring_enabled
+     && audio_ring_init(g_audio_plugin_ring_buffer, AUDIO_PLUGIN_RING_SIZE, NULL, &g_iaudio_out_backend_plugin_ring_compat) != 0)
+    {
+        DebugMessage(M64MSG_WARNING, "Feeding the audio plugin from the emulation thread");
+    }
+
+    if (!netplay_is_init() && ConfigGetParamBool(g_CoreConfig, "Rewind"))
+    {
+        int budget = ConfigGetParamInt(g_CoreConfig, "RewindBufferSize");
+        int interval = ConfigGetParamInt(g_CoreConfig, "RewindInterval");
+        if (budget > 0 && interval > 0)
+            rewind_init((size_t)budget * 1024 * 1024, (unsigned int)interval);
+    }
+
+    trace_thread_name("emulation");
+    {
+        const char* trace_file = ConfigGetParamString(g_CoreConfig, "TraceFile");
+        int trace_events = ConfigGetParamInt(g_CoreConfig, "TraceBufferSize");
+        if (trace_file != NULL && trace_file[0] != '\0')
+            trace_start(trace_file, (trace_events > 0) ? (size_t)trace_events : 0);
+    }
+
+    {
+        const char* memtrace_file = ConfigGetParamString(g_CoreConfig, "MemTraceFile");
+        int memtrace_records = ConfigGetParamInt(g_CoreConfig, "MemTraceBufferSize");
+        if (memtrace_file != NULL && memtrace_file[0] != '\0')
+            memtrace_start(memtrace_file, (memtrace_records > 0) ? (size_t)memtrace_records : 0);
+    }
+
+    l_ViCount = 0;
+    timed_sections_reset();
+
+    {
+        int profiler_rate = ConfigGetParamInt(g_CoreConfig, "ProfilerRate");
+        if (profiler_rate > 0)
+            sampler_start((unsigned int)profiler_rate);
+    }
+
     poweron_device(&g_dev);
     pif_bootrom_hle_execute(&g_dev.r4300);
+    l_RunStartNs = l_RunEndNs = osal_monotonic_ns();
     run_device(&g_dev);
+    l_RunEndNs = osal_monotonic_ns();
+    timed_sections_stop();
+    sampler_stop(ConfigGetParamString(g_CoreConfig, "ProfilerFile"));
+    memtrace_stop();
+    movie_finish();
 
     /* now begin to shut down */
+    wait_rsp_task(&g_dev.sp);
+    if (g_dev.sp.async_tasks)
+        rsp_thread_shutdown();
+    if (g_audio_plugin_ring_enabled)
+        audio_ring_shutdown();
+    rewind_deinit();
+
+    /* background jobs must be idle while the trace is written */
+    if (g_trace_enabled)
+    {
+        workqueue_suspend();
+        trace_stop();
+        workqueue_resume(0);
+    }
+
 #ifdef WITH_LIRC
     lircStop();
 #endif // WITH_LIRC
@@ -1997,6 +2366,7 @@ m64p_error main_run(void)
     close_file_storage(&eep);
     close_file_storage(&mpk);
     close_dd_disk(&dd_disk);
+    file_storage_flusher_stop();
 
     if (ConfigGetParamBool(g_CoreConfig, "OnScreenDisplay"))
     {
@@ -2040,6 +2410,8 @@ on_gfx_open_failure:
     close_file_storage(&eep);
     close_file_storage(&mpk);
     close_dd_disk(&dd_disk);
+    file_storage_flusher_stop();
+    movie_disarm();
 
     return failure_rval;
 }
@@ -2073,6 +2445,10 @@ void main_stop(void)
         StateChanged(M64CORE_EMU_STATE, M64EMU_RUNNING);
     }
 
+    /* a movie recording ends on the next VI */
+    if (movie_defer_stop())
+        return;
+
     stop_device(&g_dev);
 
 #ifdef DBG
@@ -85,12 +85,32 @@ void main_state_set_slot(int slot);
 void main_state_inc_slot(void);
 void main_state_load(const char *filename);
 void main_state_save(int format, const char *filename);
+m64p_error main_state_load_memory(void *buffer, int size);
+m64p_error main_state_save_memory(void *buffer, int size);
+m64p_error main_state_read_section(m64p_state_section *section);
 
 m64p_error main_core_state_query(m64p_core_param param, int *rval);
 m64p_error main_core_state_set(m64p_core_param param, int val);
 
 m64p_error main_get_screen_size(int *width, int *height);
 m64p_error main_read_screen(void *pixels, int bFront);
+m64p_error main_get_rdram_dirty_pages(uint32_t* bitmap, int size);
+m64p_error main_get_audio_ring_stats(m64p_audio_ring_stats* stats);
+m64p_error main_get_frame_pacing_stats(m64p_frame_pacing_stats* stats);
+m64p_error main_get_housekeeping_stats(m64p_housekeeping_stats* stats, int size);
+m64p_error main_rewind_step(int steps);
+m64p_error main_get_rewind_stats(m64p_rewind_stats* stats);
+m64p_error main_get_run_stats(m64p_run_stats* stats);
+m64p_error main_get_timing_stats(m64p_timing_stats* stats, int size);
+m64p_error main_fork_snapshot(m64p_fork_callback callback);
+m64p_error main_fork_instance(int* pid);
+m64p_error main_movie_record(const char* path);
+m64p_error main_movie_play(const char* path);
+m64p_error main_profiler_report(const char* path);
+m64p_error main_export_instr_counters(const char* path, m64p_export_format format);
+m64p_error main_get_interrupt_stats(m64p_interrupt_stats* stats);
+m64p_error main_get_memory_footprint(m64p_memory_footprint* entries, int size);
+m64p_error main_release_caches(void);
 
 m64p_error main_volume_up(void);
 m64p_error main_volume_down(void);
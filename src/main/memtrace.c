@@ -0,0 +1,334 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - memtrace.c                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "memtrace.h"
+
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "device/device.h"
+#include "osal/files.h"
+
+#if defined(_MSC_VER)
+  #define memtrace_thread_local __declspec(thread)
+#else
+  #define memtrace_thread_local __thread
+#endif
+
+enum { MEMTRACE_MAX_THREADS = 8 };
+enum { MEMTRACE_MIN_RECORDS = 4096, MEMTRACE_MAX_RECORDS = 1 << 24 };
+/* the writer is woken up each time this many records have been added */
+enum { MEMTRACE_BATCH = 1024 };
+
+struct memtrace_ring
+{
+    struct memtrace_record* records;
+    uint32_t mask;
+    /* free running, head is only written by the recording thread
+     * and tail by the writer */
+    SDL_atomic_t head;
+    SDL_atomic_t tail;
+    /* set once the records are allocated */
+    SDL_atomic_t ready;
+    /* times the recording thread had to wait for the writer */
+    uint32_t stalls;
+};
+
+struct memtrace_thread
+{
+    unsigned int generation;
+    struct memtrace_ring* ring;
+};
+
+int g_memtrace_enabled = 0;
+
+static struct memtrace_ring l_rings[MEMTRACE_MAX_THREADS];
+static SDL_atomic_t l_ring_count;
+/* bumped on each start, so that threads drop rings of a previous trace */
+static unsigned int l_generation;
+static uint32_t l_ring_size;
+static uint64_t l_records;
+static gzFile l_file;
+static int l_write_error;
+static SDL_sem* l_data_avail;
+static SDL_Thread* l_writer;
+static SDL_atomic_t l_quit;
+
+static memtrace_thread_local struct memtrace_thread l_thread;
+
+static uint8_t get_region(uint32_t paddr)
+{
+    if (paddr < MM_RDRAM_REGS)
+        return MEMTRACE_RDRAM;
+    if (paddr < MM_RSP_MEM)
+        return MEMTRACE_RDRAM_REGS;
+    if (paddr < MM_RSP_REGS)
+        return MEMTRACE_RSP_MEM;
+    if (paddr < MM_DPC_REGS)
+        return MEMTRACE_RSP_REGS;
+    /* DPC, DPS, MI, VI, AI, PI, RI and SI registers are 1MB apart */
+    if (paddr <= (MM_SI_REGS | UINT32_C(0xfffff)))
+        return (uint8_t)(MEMTRACE_DPC_REGS + ((paddr - MM_DPC_REGS) >> 20));
+    if (paddr < MM_DOM2_ADDR1)
+        return MEMTRACE_UNMAPPED;
+    if (paddr < MM_DOM2_ADDR2)
+        return MEMTRACE_DD;
+    if (paddr < MM_CART_ROM)
+        return MEMTRACE_CART_SAVE;
+    if (paddr < MM_PIF_MEM)
+        return MEMTRACE_CART_ROM;
+    if (paddr <= (MM_PIF_MEM | UINT32_C(0xffff)))
+        return MEMTRACE_PIF;
+
+    return MEMTRACE_UNMAPPED;
+}
+
+static struct memtrace_ring* claim_ring(void)
+{
+    int index = SDL_AtomicAdd(&l_ring_count, 1);
+    struct memtrace_ring* ring = NULL;
+
+    if (index < MEMTRACE_MAX_THREADS) {
+        ring = &l_rings[index];
+        ring->mask = l_ring_size - 1;
+        ring->records = malloc(l_ring_size * sizeof(*ring->records));
+        if (ring->records != NULL) {
+            SDL_AtomicSet(&ring->ready, 1);
+        }
+        else {
+            DebugMessage(M64MSG_WARNING, "Memory trace: couldn't allocate the ring of thread %d", index);
+            ring = NULL;
+        }
+    }
+    else {
+        DebugMessage(M64MSG_WARNING, "Memory trace: too many threads, thread %d is not traced", index);
+    }
+
+    l_thread.generation = l_generation;
+    l_thread.ring = ring;
+    return ring;
+}
+
+void memtrace_record(enum memtrace_kind kind, uint32_t pc, uint32_t vaddr, uint32_t paddr,
+                     unsigned int size, uint64_t value)
+{
+    struct memtrace_ring* ring = l_thread.ring;
+    struct memtrace_record* record;
+    uint32_t head;
+
+    if (l_thread.generation != l_generation)
+        ring = claim_ring();
+    if (ring == NULL)
+        return;
+
+    head = (uint32_t)SDL_AtomicGet(&ring->head);
+    while (head - (uint32_t)SDL_AtomicGet(&ring->tail) > ring->mask) {
+        ++ring->stalls;
+        SDL_SemPost(l_data_avail);
+        SDL_Delay(1);
+    }
+
+    record = &ring->records[head & ring->mask];
+    record->pc = pc;
+    record->vaddr = vaddr;
+    record->paddr = paddr;
+    record->kind = (uint8_t)kind;
+    record->size = (uint8_t)size;
+    record->region = (kind == MEMTRACE_DMA && paddr < MM_RDRAM_REGS)
+        ? get_region(vaddr)
+        : get_region(paddr);
+    record->reserved = 0;
+    record->value = value;
+    SDL_AtomicSet(&ring->head, (int)(head + 1));
+
+    if (((head + 1) & (MEMTRACE_BATCH - 1)) == 0)
+        SDL_SemPost(l_data_avail);
+}
+
+static void write_data(const void* data, size_t size)
+{
+    if (l_write_error || size == 0)
+        return;
+
+    if (gzwrite(l_file, data, (unsigned int)size) != (int)size) {
+        DebugMessage(M64MSG_ERROR, "Memory trace: couldn't write the trace file, recording continues without it");
+        l_write_error = 1;
+    }
+}
+
+/* Write the records of ring added since the last drain, returns their count */
+static uint32_t drain_ring(struct memtrace_ring* ring, uint32_t index)
+{
+    uint32_t tail = (uint32_t)SDL_AtomicGet(&ring->tail);
+    uint32_t head = (uint32_t)SDL_AtomicGet(&ring->head);
+    uint32_t offset = tail & ring->mask;
+    uint32_t count = head - tail;
+    uint32_t first = ring->mask + 1 - offset;
+    struct memtrace_chunk chunk;
+
+    if (count == 0)
+        return 0;
+
+    if (first > count)
+        first = count;
+
+    chunk.thread = index;
+    chunk.count = count;
+    write_data(&chunk, sizeof(chunk));
+    write_data(&ring->records[offset], first * sizeof(*ring->records));
+    write_data(&ring->records[0], (count - first) * sizeof(*ring->records));
+
+    l_records += count;
+    SDL_AtomicSet(&ring->tail, (int)head);
+    return count;
+}
+
+static uint32_t drain_rings(void)
+{
+    int count = SDL_AtomicGet(&l_ring_count);
+    uint32_t drained = 0;
+    int i;
+
+    if (count > MEMTRACE_MAX_THREADS)
+        count = MEMTRACE_MAX_THREADS;
+
+    for (i = 0; i < count; ++i) {
+        if (SDL_AtomicGet(&l_rings[i].ready))
+            drained += drain_ring(&l_rings[i], (uint32_t)i);
+    }
+
+    return drained;
+}
+
+static int memtrace_writer_thread(void* data)
+{
+    for (;;) {
+        /* also wake up periodically for threads recording slowly */
+        SDL_SemWaitTimeout(l_data_avail, 10);
+
+        if (drain_rings() == 0 && SDL_AtomicGet(&l_quit))
+            break;
+    }
+
+    return 0;
+}
+
+int memtrace_start(const char* path, size_t records_per_thread)
+{
+    struct memtrace_header header;
+
+    if (g_memtrace_enabled)
+        memtrace_stop();
+
+    /* fast compression, the recording threads wait for the writer */
+    l_file = osal_gzopen(path, "wb1");
+    if (l_file == NULL) {
+        DebugMessage(M64MSG_ERROR, "Couldn't create memory trace file %s", path);
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MEMTRACE_MAGIC, sizeof(MEMTRACE_MAGIC));
+    header.version = MEMTRACE_VERSION;
+    header.record_size = sizeof(struct memtrace_record);
+    l_write_error = 0;
+    write_data(&header, sizeof(header));
+
+    l_ring_size = MEMTRACE_MIN_RECORDS;
+    while (l_ring_size < records_per_thread && l_ring_size < MEMTRACE_MAX_RECORDS)
+        l_ring_size <<= 1;
+
+    memset(l_rings, 0, sizeof(l_rings));
+    SDL_AtomicSet(&l_ring_count, 0);
+    SDL_AtomicSet(&l_quit, 0);
+    l_records = 0;
+
+    l_data_avail = SDL_CreateSemaphore(0);
+    if (l_data_avail == NULL) {
+        DebugMessage(M64MSG_ERROR, "Could not create memory trace synchronization objects");
+        gzclose(l_file);
+        l_file = NULL;
+        return -1;
+    }
+
+#if SDL_VERSION_ATLEAST(2,0,0)
+    l_writer = SDL_CreateThread(memtrace_writer_thread, "m64pmemtrace", NULL);
+#else
+    l_writer = SDL_CreateThread(memtrace_writer_thread, NULL);
+#endif
+    if (l_writer == NULL) {
+        DebugMessage(M64MSG_ERROR, "Could not create memory trace writer thread");
+        SDL_DestroySemaphore(l_data_avail);
+        l_data_avail = NULL;
+        gzclose(l_file);
+        l_file = NULL;
+        return -1;
+    }
+
+    ++l_generation;
+    g_memtrace_enabled = 1;
+
+    DebugMessage(M64MSG_INFO, "Recording memory accesses to %s (%u records per thread)", path, l_ring_size);
+    return 0;
+}
+
+void memtrace_stop(void)
+{
+    uint32_t stalls = 0;
+    int status;
+    int i;
+
+    if (!g_memtrace_enabled)
+        return;
+    g_memtrace_enabled = 0;
+
+    SDL_AtomicSet(&l_quit, 1);
+    SDL_SemPost(l_data_avail);
+    SDL_WaitThread(l_writer, &status);
+    l_writer = NULL;
+    SDL_DestroySemaphore(l_data_avail);
+    l_data_avail = NULL;
+
+    /* records added after the last drain of the writer */
+    drain_rings();
+
+    for (i = 0; i < MEMTRACE_MAX_THREADS; ++i) {
+        stalls += l_rings[i].stalls;
+        free(l_rings[i].records);
+        l_rings[i].records = NULL;
+    }
+
+    if (gzclose(l_file) != Z_OK)
+        l_write_error = 1;
+    l_file = NULL;
+
+    if (l_write_error)
+        DebugMessage(M64MSG_ERROR, "Memory trace file is incomplete");
+    else
+        DebugMessage(M64MSG_INFO, "Memory trace: %llu records written, recording waited %u times for the writer",
+                     (unsigned long long)l_records, stalls);
+}
@@ -0,0 +1,135 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - memtrace.h                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_MEMTRACE_H
+#define M64P_MAIN_MEMTRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "osal/preproc.h"
+
+/* Opt-in recorder of the r4300 loads and stores and of the DMA transfers,
+ * for offline analysis of the memory accesses (see tools/memtrace_summary.c).
+ *
+ * Accesses are recorded where the r4300 emulators resolve them, so both the
+ * virtual and the physical address are known. The interpreters record every
+ * access; the recompilers only record those going through their memory
+ * stubs, i.e. not the RDRAM accesses they inline. Loads are recorded as the
+ * core performs them, one word or doubleword at a time.
+ *
+ * Each thread records into its own ring, claimed on its first record, which
+ * a background thread drains into a gzip compressed file. A thread whose ring
+ * is full waits for the writer, so the trace is complete but emulation runs
+ * at the speed of the compression.
+ *
+ * The file is a memtrace_header followed by chunks, each made of a
+ * memtrace_chunk and the records it announces, in host byte order.
+ */
+
+#define MEMTRACE_MAGIC "M64MTRC"
+enum { MEMTRACE_VERSION = 1 };
+
+enum memtrace_kind
+{
+    MEMTRACE_READ,
+    MEMTRACE_WRITE,
+    MEMTRACE_DMA
+};
+
+/* device side of the physical address space */
+enum memtrace_region
+{
+    MEMTRACE_UNMAPPED,
+    MEMTRACE_RDRAM,
+    MEMTRACE_RDRAM_REGS,
+    MEMTRACE_RSP_MEM,
+    MEMTRACE_RSP_REGS,
+    MEMTRACE_DPC_REGS,
+    MEMTRACE_DPS_REGS,
+    MEMTRACE_MI_REGS,
+    MEMTRACE_VI_REGS,
+    MEMTRACE_AI_REGS,
+    MEMTRACE_PI_REGS,
+    MEMTRACE_RI_REGS,
+    MEMTRACE_SI_REGS,
+    MEMTRACE_DD,
+    MEMTRACE_CART_SAVE,
+    MEMTRACE_CART_ROM,
+    MEMTRACE_PIF,
+    MEMTRACE_REGIONS_COUNT
+};
+
+enum memtrace_dma
+{
+    MEMTRACE_DMA_PI,
+    MEMTRACE_DMA_SI,
+    MEMTRACE_DMA_SP,
+    MEMTRACE_DMA_AI,
+    MEMTRACE_DMA_COUNT
+};
+
+struct memtrace_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+struct memtrace_chunk
+{
+    uint32_t thread;    /* index of the recording thread */
+    uint32_t count;     /* records following */
+};
+
+struct memtrace_record
+{
+    uint32_t pc;        /* r4300 instruction, 0 for DMA */
+    uint32_t vaddr;     /* DMA: source physical address */
+    uint32_t paddr;     /* DMA: destination physical address */
+    uint8_t kind;       /* enum memtrace_kind */
+    uint8_t size;       /* bytes accessed, DMA: enum memtrace_dma */
+    uint8_t region;     /* enum memtrace_region of paddr, DMA: of the side which is not RDRAM */
+    uint8_t reserved;
+    uint64_t value;     /* DMA: length in bytes */
+};
+
+extern int g_memtrace_enabled;
+
+/* to be called if g_memtrace_enabled is set */
+void memtrace_record(enum memtrace_kind kind, uint32_t pc, uint32_t vaddr, uint32_t paddr,
+                     unsigned int size, uint64_t value);
+
+static osal_inline void memtrace_dma(enum memtrace_dma dma, uint32_t src, uint32_t dst, uint32_t length)
+{
+    if (g_memtrace_enabled)
+        memtrace_record(MEMTRACE_DMA, 0, src, dst, (unsigned int)dma, length);
+}
+
+/* Starts recording into path with rings of records_per_thread records.
+ * Returns 0 on success, -1 on failure. */
+int memtrace_start(const char* path, size_t records_per_thread);
+
+/* Stops recording, writes the remaining records and closes the file.
+ * All traced threads must be idle. */
+void memtrace_stop(void);
+
+#endif
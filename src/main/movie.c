@@ -0,0 +1,599 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - movie.c                                                 *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "movie.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_plugin.h"
+#include "backends/api/clock_backend.h"
+#include "device/device.h"
+#include "main.h"
+#include "osal/files.h"
+#include "plugin/plugin.h"
+#include "rom.h"
+#include "util.h"
+
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+#define MOVIE_VERSION 1
+
+/* header layout, all values little endian:
+ *  0 magic, 8 version, 12 CountPerOp, 16 CountPerOpDenomPot,
+ * 20 DisableExtraMem, 24 SiDmaDuration, 28 Present/Plugin/RawData/0 of
+ * each controller, 44 start time of the real time clocks, 52 ROM MD5 */
+#define MOVIE_HEADER_SIZE 84
+
+/* each record starts with (kind << 2) | controller and the number of VIs
+ * since the previous record (LEB128), followed by the fields of its kind */
+enum movie_record_kind
+{
+    MOVIE_RECORD_INPUT,      /* poll within the VI (LEB128), input (32 bits), plugin, present */
+    MOVIE_RECORD_SOFT_RESET,
+    MOVIE_RECORD_HARD_RESET,
+    MOVIE_RECORD_END         /* RDRAM and frame hashes (64 bits each), 0 if not checked */
+};
+
+enum movie_mode
+{
+    MOVIE_OFF,
+    MOVIE_RECORD,
+    MOVIE_PLAY
+};
+
+/* polled state of a controller, only recorded when it changes */
+struct movie_input
+{
+    uint32_t value;
+    uint8_t plugin;
+    uint8_t present;
+};
+
+struct movie_record
+{
+    enum movie_record_kind kind;
+    int control_id;
+    uint32_t vi;
+    uint32_t poll;
+    struct movie_input input;
+    uint64_t rdram_hash;
+    uint64_t frame_hash;
+    size_t next;
+};
+
+static const char l_magic[8] = { 'M', '6', '4', '+', 'M', 'O', 'V', 'I' };
+
+static struct
+{
+    enum movie_mode mode;
+    int running;
+    m64p_movie_state state;
+
+    FILE* file;             /* recording */
+    unsigned char* data;    /* replay */
+    size_t size;
+    size_t pos;
+    uint32_t end_vi;
+
+    time_t start_time;
+    unsigned int refresh_rate;
+
+    uint32_t vi;
+    uint32_t record_vi;     /* VI of the last record written or replayed */
+    uint32_t polls[NUM_CONTROLLER];
+    struct movie_input inputs[NUM_CONTROLLER];
+    int reset_pending;      /* 1 for a soft reset, 2 for a hard reset */
+    int stop_pending;
+} l_movie;
+
+
+static void put_leb128(FILE* f, uint32_t value)
+{
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        fputc(byte | (value != 0 ? 0x80 : 0), f);
+    } while (value != 0);
+}
+
+static int get_leb128(const unsigned char* data, size_t size, size_t* pos, uint32_t* value)
+{
+    unsigned int shift = 0;
+    uint8_t byte;
+
+    *value = 0;
+    do {
+        if (*pos >= size || shift > 28)
+            return 0;
+        byte = data[(*pos)++];
+        *value |= (uint32_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return 1;
+}
+
+static int movie_decode(size_t pos, uint32_t vi, struct movie_record* rec)
+{
+    const unsigned char* data = l_movie.data;
+    size_t size = l_movie.size;
+    uint32_t delta;
+
+    if (pos >= size)
+        return 0;
+
+    rec->kind = (enum movie_record_kind)(data[pos] >> 2);
+    rec->control_id = data[pos] & 3;
+    ++pos;
+
+    if (!get_leb128(data, size, &pos, &delta))
+        return 0;
+    rec->vi = vi + delta;
+
+    switch (rec->kind)
+    {
+    case MOVIE_RECORD_INPUT:
+        if (!get_leb128(data, size, &pos, &rec->poll) || size - pos < 6)
+            return 0;
+        rec->input.value = load_leu32(data + pos);
+        rec->input.plugin = data[pos + 4];
+        rec->input.present = data[pos + 5];
+        pos += 6;
+        break;
+    case MOVIE_RECORD_SOFT_RESET:
+    case MOVIE_RECORD_HARD_RESET:
+        break;
+    case MOVIE_RECORD_END:
+        if (size - pos < 16)
+            return 0;
+        rec->rdram_hash = load_leu64(data + pos);
+        rec->frame_hash = load_leu64(data + pos + 8);
+        pos += 16;
+        break;
+    default:
+        return 0;
+    }
+
+    rec->next = pos;
+    return 1;
+}
+
+static void movie_write_record(enum movie_record_kind kind, int control_id)
+{
+    fputc((kind << 2) | control_id, l_movie.file);
+    put_leb128(l_movie.file, l_movie.vi - l_movie.record_vi);
+    l_movie.record_vi = l_movie.vi;
+}
+
+static uint64_t movie_rdram_hash(void)
+{
+    return XXH3_64bits(g_dev.rdram.dram, g_dev.rdram.dram_size);
+}
+
+/* hash of the frame buffer displayed by the VI, 0 if blank */
+static uint64_t movie_frame_hash(void)
+{
+    const uint32_t* regs = g_dev.vi.regs;
+    size_t origin = regs[VI_ORIGIN_REG] & 0xffffff;
+    size_t width = regs[VI_WIDTH_REG] & 0xfff;
+    int v_start = (regs[VI_V_START_REG] >> 16) & 0x3ff;
+    int v_end = regs[VI_V_START_REG] & 0x3ff;
+    size_t bpp, lines, size;
+
+    switch (regs[VI_STATUS_REG] & 3)
+    {
+    case 2: bpp = 2; break;
+    case 3: bpp = 4; break;
+    default: return 0;
+    }
+
+    if (v_end <= v_start || origin >= g_dev.rdram.dram_size)
+        return 0;
+
+    lines = ((size_t)(v_end - v_start) / 2 * (regs[VI_Y_SCALE_REG] & 0xfff)) >> 10;
+    size = width * lines * bpp;
+    if (size > g_dev.rdram.dram_size - origin)
+        size = g_dev.rdram.dram_size - origin;
+
+    return XXH3_64bits((const uint8_t*)g_dev.rdram.dram + origin, size);
+}
+
+static void movie_apply_reset(int do_hard_reset)
+{
+    if (do_hard_reset)
+        hard_reset_device(&g_dev);
+    else
+        soft_reset_device(&g_dev);
+}
+
+static void movie_end_recording(uint64_t rdram_hash, uint64_t frame_hash)
+{
+    unsigned char hashes[16];
+
+    store_leu64(rdram_hash, hashes);
+    store_leu64(frame_hash, hashes + 8);
+    movie_write_record(MOVIE_RECORD_END, 0);
+    fwrite(hashes, 1, sizeof(hashes), l_movie.file);
+
+    if (ferror(l_movie.file) | fclose(l_movie.file))
+        DebugMessage(M64MSG_ERROR, "Failed to write the movie file");
+    else
+        DebugMessage(M64MSG_INFO, "Movie recorded: %u VIs", (unsigned int) l_movie.vi);
+    l_movie.file = NULL;
+
+    l_movie.running = 0;
+    l_movie.mode = MOVIE_OFF;
+    l_movie.state = M64MOVIE_RECORDED;
+}
+
+static void movie_end_replay(const struct movie_record* end)
+{
+    uint64_t rdram_hash = movie_rdram_hash();
+    uint64_t frame_hash = movie_frame_hash();
+
+    if (end->rdram_hash != 0 && (rdram_hash != end->rdram_hash || frame_hash != end->frame_hash))
+    {
+        DebugMessage(M64MSG_WARNING, "Movie replay desynced: RDRAM %s, frame %s at VI %u",
+                     (rdram_hash == end->rdram_hash) ? "matches" : "differs",
+                     (frame_hash == end->frame_hash) ? "matches" : "differs",
+                     (unsigned int) l_movie.vi);
+        l_movie.state = M64MOVIE_DESYNC;
+    }
+    else if (l_movie.state != M64MOVIE_DESYNC)
+    {
+        DebugMessage(M64MSG_INFO, "Movie replayed: %u VIs%s", (unsigned int) l_movie.vi,
+                     (end->rdram_hash == 0) ? ", final state not checked" : ", final state matches");
+        l_movie.state = M64MOVIE_MATCHED;
+    }
+
+    movie_disarm();
+}
+
+static void movie_desync(const char* what)
+{
+    if (l_movie.state != M64MOVIE_DESYNC)
+        DebugMessage(M64MSG_WARNING, "Movie replay desynced: %s at VI %u", what, (unsigned int) l_movie.vi);
+    l_movie.state = M64MOVIE_DESYNC;
+}
+
+
+m64p_error movie_record(const char* path)
+{
+    FILE* f;
+
+    movie_disarm();
+
+    f = osal_file_open(path, "wb");
+    if (f == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Can't create movie file %s", path);
+        return M64ERR_FILES;
+    }
+
+    l_movie.file = f;
+    l_movie.mode = MOVIE_RECORD;
+    l_movie.state = M64MOVIE_NONE;
+    return M64ERR_SUCCESS;
+}
+
+m64p_error movie_play(const char* path)
+{
+    struct movie_record rec;
+    void* data;
+    size_t size, pos;
+    uint32_t vi = 0;
+    int complete = 0;
+
+    movie_disarm();
+
+    if (load_file(path, &data, &size) != file_ok)
+    {
+        DebugMessage(M64MSG_ERROR, "Can't read movie file %s", path);
+        return M64ERR_FILES;
+    }
+
+    l_movie.data = (unsigned char*) data;
+    l_movie.size = size;
+
+    if (size < MOVIE_HEADER_SIZE
+     || memcmp(l_movie.data, l_magic, sizeof(l_magic)) != 0
+     || load_leu32(l_movie.data + 8) != MOVIE_VERSION)
+    {
+        DebugMessage(M64MSG_ERROR, "%s is not a supported movie file", path);
+        movie_disarm();
+        return M64ERR_INPUT_INVALID;
+    }
+
+    if (memcmp(l_movie.data + 52, ROM_SETTINGS.MD5, 32) != 0)
+    {
+        DebugMessage(M64MSG_ERROR, "Movie %s was recorded with another ROM", path);
+        movie_disarm();
+        return M64ERR_INCOMPATIBLE;
+    }
+
+    /* the movie must be complete, ending with its final hashes */
+    for (pos = MOVIE_HEADER_SIZE; movie_decode(pos, vi, &rec); pos = rec.next)
+    {
+        vi = rec.vi;
+        if (rec.kind == MOVIE_RECORD_END)
+        {
+            complete = (rec.next == size);
+            break;
+        }
+    }
+    if (!complete)
+    {
+        DebugMessage(M64MSG_ERROR, "Movie %s is truncated or corrupted", path);
+        movie_disarm();
+        return M64ERR_INPUT_INVALID;
+    }
+
+    l_movie.end_vi = rec.vi;
+    l_movie.mode = MOVIE_PLAY;
+    l_movie.state = M64MOVIE_NONE;
+    return M64ERR_SUCCESS;
+}
+
+void movie_disarm(void)
+{
+    if (l_movie.file != NULL)
+        fclose(l_movie.file);
+    free(l_movie.data);
+
+    l_movie.file = NULL;
+    l_movie.data = NULL;
+    l_movie.size = 0;
+    l_movie.running = 0;
+    l_movie.mode = MOVIE_OFF;
+}
+
+int movie_is_active(void)
+{
+    return l_movie.mode != MOVIE_OFF;
+}
+
+m64p_movie_state movie_get_state(void)
+{
+    return l_movie.state;
+}
+
+void movie_sync_settings(uint32_t* count_per_op, uint32_t* count_per_op_denom_pot,
+                         uint32_t* disable_extra_mem, int32_t* si_dma_duration)
+{
+    unsigned char header[MOVIE_HEADER_SIZE];
+    int i;
+
+    if (l_movie.mode == MOVIE_OFF)
+        return;
+
+    l_movie.running = 1;
+    l_movie.vi = 0;
+    l_movie.record_vi = 0;
+    l_movie.reset_pending = 0;
+    l_movie.stop_pending = 0;
+    memset(l_movie.polls, 0, sizeof(l_movie.polls));
+    l_movie.refresh_rate = vi_expected_refresh_rate_from_tv_standard(ROM_PARAMS.systemtype);
+
+    if (l_movie.mode == MOVIE_RECORD)
+    {
+        l_movie.start_time = time(NULL);
+
+        memset(header, 0, sizeof(header));
+        memcpy(header, l_magic, sizeof(l_magic));
+        store_leu32(MOVIE_VERSION, header + 8);
+        store_leu32(*count_per_op, header + 12);
+        store_leu32(*count_per_op_denom_pot, header + 16);
+        store_leu32(*disable_extra_mem, header + 20);
+        store_leu32((uint32_t) *si_dma_duration, header + 24);
+        for (i = 0; i < NUM_CONTROLLER; ++i)
+        {
+            header[28 + 4 * i + 0] = (uint8_t) Controls[i].Present;
+            header[28 + 4 * i + 1] = (uint8_t) Controls[i].Plugin;
+            header[28 + 4 * i + 2] = (uint8_t) Controls[i].RawData;
+
+            if (Controls[i].Present && Controls[i].RawData)
+                DebugMessage(M64MSG_WARNING, "Controller %d uses raw input, which is not recorded", i + 1);
+        }
+        store_leu64((uint64_t) l_movie.start_time, header + 44);
+        memcpy(header + 52, ROM_SETTINGS.MD5, 32);
+        fwrite(header, 1, sizeof(header), l_movie.file);
+
+        l_movie.state = M64MOVIE_RECORDING;
+        DebugMessage(M64MSG_INFO, "Recording movie");
+    }
+    else
+    {
+        memcpy(header, l_movie.data, sizeof(header));
+        *count_per_op = load_leu32(header + 12);
+        *count_per_op_denom_pot = load_leu32(header + 16);
+        *disable_extra_mem = load_leu32(header + 20);
+        *si_dma_duration = (int32_t) load_leu32(header + 24);
+        for (i = 0; i < NUM_CONTROLLER; ++i)
+        {
+            Controls[i].Present = header[28 + 4 * i + 0];
+            Controls[i].Plugin = header[28 + 4 * i + 1];
+        }
+        l_movie.start_time = (time_t) load_leu64(header + 44);
+        l_movie.pos = MOVIE_HEADER_SIZE;
+
+        l_movie.state = M64MOVIE_PLAYING;
+        DebugMessage(M64MSG_INFO, "Replaying movie: %u VIs", (unsigned int) l_movie.end_vi);
+    }
+
+    for (i = 0; i < NUM_CONTROLLER; ++i)
+    {
+        l_movie.inputs[i].value = 0;
+        l_movie.inputs[i].plugin = header[28 + 4 * i + 1];
+        l_movie.inputs[i].present = header[28 + 4 * i + 0];
+    }
+}
+
+void movie_update_input(int control_id, uint32_t* input)
+{
+    struct movie_input* last;
+    struct movie_record rec;
+    uint32_t poll;
+
+    if (!l_movie.running || control_id < 0 || control_id >= NUM_CONTROLLER)
+        return;
+
+    last = &l_movie.inputs[control_id];
+    poll = l_movie.polls[control_id]++;
+
+    if (l_movie.mode == MOVIE_RECORD)
+    {
+        struct movie_input cur = { *input, (uint8_t) Controls[control_id].Plugin, (uint8_t) Controls[control_id].Present };
+        unsigned char fields[6];
+
+        if (cur.value == last->value && cur.plugin == last->plugin && cur.present == last->present)
+            return;
+
+        store_leu32(cur.value, fields);
+        fields[4] = cur.plugin;
+        fields[5] = cur.present;
+        movie_write_record(MOVIE_RECORD_INPUT, control_id);
+        put_leb128(l_movie.file, poll);
+        fwrite(fields, 1, sizeof(fields), l_movie.file);
+        *last = cur;
+    }
+    else
+    {
+        if (movie_decode(l_movie.pos, l_movie.record_vi, &rec)
+         && rec.kind == MOVIE_RECORD_INPUT
+         && rec.control_id == control_id
+         && rec.vi == l_movie.vi
+         && rec.poll == poll)
+        {
+            *last = rec.input;
+            l_movie.record_vi = rec.vi;
+            l_movie.pos = rec.next;
+        }
+
+        *input = last->value;
+        Controls[control_id].Plugin = last->plugin;
+        Controls[control_id].Present = last->present;
+    }
+}
+
+void movie_vi(void)
+{
+    struct movie_record rec;
+
+    if (!l_movie.running)
+        return;
+
+    ++l_movie.vi;
+    memset(l_movie.polls, 0, sizeof(l_movie.polls));
+
+    if (l_movie.mode == MOVIE_RECORD)
+    {
+        if (l_movie.reset_pending)
+        {
+            movie_write_record((l_movie.reset_pending == 2) ? MOVIE_RECORD_HARD_RESET : MOVIE_RECORD_SOFT_RESET, 0);
+            movie_apply_reset(l_movie.reset_pending == 2);
+            l_movie.reset_pending = 0;
+        }
+
+        if (l_movie.stop_pending)
+        {
+            movie_end_recording(movie_rdram_hash(), movie_frame_hash());
+            main_stop();
+        }
+        return;
+    }
+
+    while (movie_decode(l_movie.pos, l_movie.record_vi, &rec) && rec.vi <= l_movie.vi)
+    {
+        if (rec.kind == MOVIE_RECORD_END)
+        {
+            movie_end_replay(&rec);
+            main_stop();
+            return;
+        }
+
+        if (rec.vi < l_movie.vi)
+            movie_desync("controller poll missed");
+        else if (rec.kind == MOVIE_RECORD_INPUT)
+            break;
+        else
+            movie_apply_reset(rec.kind == MOVIE_RECORD_HARD_RESET);
+
+        l_movie.record_vi = rec.vi;
+        l_movie.pos = rec.next;
+    }
+}
+
+int movie_defer_stop(void)
+{
+    if (!l_movie.running || l_movie.mode != MOVIE_RECORD)
+        return 0;
+
+    l_movie.stop_pending = 1;
+    return 1;
+}
+
+int movie_defer_reset(int do_hard_reset)
+{
+    if (!l_movie.running)
+        return 0;
+
+    /* resets are part of the replayed movie */
+    if (l_movie.mode == MOVIE_RECORD)
+        l_movie.reset_pending = do_hard_reset ? 2 : 1;
+
+    return 1;
+}
+
+void movie_finish(void)
+{
+    if (l_movie.running)
+    {
+        if (l_movie.mode == MOVIE_RECORD)
+        {
+            DebugMessage(M64MSG_WARNING, "Movie recording did not stop on a VI, its final state won't be checked");
+            movie_end_recording(0, 0);
+        }
+        else
+        {
+            DebugMessage(M64MSG_INFO, "Movie replay stopped at VI %u of %u",
+                         (unsigned int) l_movie.vi, (unsigned int) l_movie.end_vi);
+            if (l_movie.state != M64MOVIE_DESYNC)
+                l_movie.state = M64MOVIE_NONE;
+        }
+    }
+
+    movie_disarm();
+}
+
+static time_t movie_clock_get_time(void* clock)
+{
+    return l_movie.start_time + (time_t)(l_movie.vi / l_movie.refresh_rate);
+}
+
+const struct clock_backend_interface g_imovie_clock =
+{
+    movie_clock_get_time
+};
@@ -0,0 +1,76 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - movie.h                                                 *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_MOVIE_H
+#define M64P_MAIN_MOVIE_H
+
+#include <stdint.h>
+
+#include "api/m64p_types.h"
+
+struct clock_backend_interface;
+
+/* Input movies: the controller state polled by the input plugin, pak
+ * switches and resets are recorded from power-on, keyed to the VI count,
+ * and replayed instead of the input plugin. Like netplay, a movie run
+ * disables every source of non determinism of the core (interrupt
+ * randomization, asynchronous RSP tasks, mempak IDs, real time clocks), so
+ * the replay executes exactly the same emulation. The RDRAM and the
+ * displayed frame are hashed when the recording stops and checked when the
+ * replay reaches the same VI.
+ *
+ * Save files, cheats and raw input plugins are not part of the movie.
+ */
+
+/* Arm a recording or a replay for the next emulation run */
+m64p_error movie_record(const char* path);
+m64p_error movie_play(const char* path);
+void movie_disarm(void);
+
+/* Non zero if a movie is armed or running */
+int movie_is_active(void);
+m64p_movie_state movie_get_state(void);
+
+/* Called when the emulation starts, before the devices are initialized:
+ * store the settings which change the emulation in the movie, or replace
+ * them with the recorded ones. The controllers configuration is stored or
+ * restored as well. */
+void movie_sync_settings(uint32_t* count_per_op, uint32_t* count_per_op_denom_pot,
+                         uint32_t* disable_extra_mem, int32_t* si_dma_duration);
+
+/* Called for each poll of a controller by the input plugin backend */
+void movie_update_input(int control_id, uint32_t* input);
+
+/* Per VI work: resets, end of the recording or of the replay */
+void movie_vi(void);
+
+/* Requests which must happen on a VI boundary while recording.
+ * Return non zero if the request was taken over by the movie. */
+int movie_defer_stop(void);
+int movie_defer_reset(int do_hard_reset);
+
+/* Called when the emulation has stopped */
+void movie_finish(void);
+
+/* Real time clock derived from the emulated time, used during movies */
+extern const struct clock_backend_interface g_imovie_clock;
+
+#endif
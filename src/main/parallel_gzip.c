@@ -0,0 +1,445 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - parallel_gzip.c                                         *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "parallel_gzip.h"
+
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+
+/* gzip header with FEXTRA set, followed by a single 'M','P' subfield
+ * holding the member size and the uncompressed size (little endian) */
+enum { GZIP_HEADER_SIZE = 24 };
+enum { GZIP_TRAILER_SIZE = 8 };
+enum { PARALLEL_GZIP_MAX_THREADS = 16 };
+
+struct gzip_member
+{
+    const unsigned char* in;
+    size_t in_size;
+    unsigned char* out;
+    size_t out_size;
+    /* when reading, uncompressed offset within the segments */
+    const struct parallel_gzip_segment* segments;
+    size_t offset;
+    int failed;
+};
+
+struct gzip_job
+{
+    struct gzip_member* members;
+    size_t count;
+    int level;
+    int (*process)(struct gzip_member* member, int level);
+    SDL_atomic_t next;
+};
+
+static void put_le32(unsigned char* p, uint32_t v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static uint32_t get_le32(const unsigned char* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* deflate member->in into member->out, which must hold
+ * GZIP_HEADER_SIZE + deflateBound + GZIP_TRAILER_SIZE bytes */
+static int compress_member(struct gzip_member* member, int level)
+{
+    z_stream s;
+    unsigned char* h = member->out;
+    int ret;
+
+    memset(&s, 0, sizeof(s));
+    if (deflateInit2(&s, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return -1;
+
+    s.next_in = (Bytef*)member->in;
+    s.avail_in = (uInt)member->in_size;
+    s.next_out = h + GZIP_HEADER_SIZE;
+    s.avail_out = (uInt)(member->out_size - GZIP_HEADER_SIZE - GZIP_TRAILER_SIZE);
+    ret = deflate(&s, Z_FINISH);
+    deflateEnd(&s);
+    if (ret != Z_STREAM_END)
+        return -1;
+
+    member->out_size = GZIP_HEADER_SIZE + s.total_out + GZIP_TRAILER_SIZE;
+
+    memset(h, 0, GZIP_HEADER_SIZE);
+    h[0] = 0x1f;
+    h[1] = 0x8b;
+    h[2] = Z_DEFLATED;
+    h[3] = 0x04;  /* FEXTRA */
+    h[9] = 0xff;  /* unknown OS */
+    h[10] = 12;   /* XLEN */
+    h[12] = 'M';
+    h[13] = 'P';
+    h[14] = 8;    /* subfield length */
+    put_le32(h + 16, (uint32_t)member->out_size);
+    put_le32(h + 20, (uint32_t)member->in_size);
+
+    put_le32(h + member->out_size - 8, (uint32_t)crc32(0, member->in, (uInt)member->in_size));
+    put_le32(h + member->out_size - 4, (uint32_t)member->in_size);
+    return 0;
+}
+
+/* inflate the deflate stream of the member into the out_size bytes found
+ * at offset in the segments */
+static int decompress_member(struct gzip_member* member, int level)
+{
+    z_stream s;
+    const unsigned char* trailer = member->in + member->in_size - GZIP_TRAILER_SIZE;
+    const struct parallel_gzip_segment* seg = member->segments;
+    size_t skip = member->offset;
+    size_t left = member->out_size;
+    uLong crc = crc32(0, NULL, 0);
+    int ret = Z_OK;
+
+    (void)level;
+
+    memset(&s, 0, sizeof(s));
+    if (inflateInit2(&s, -MAX_WBITS) != Z_OK)
+        return -1;
+
+    s.next_in = (Bytef*)member->in + GZIP_HEADER_SIZE;
+    s.avail_in = (uInt)(member->in_size - GZIP_HEADER_SIZE - GZIP_TRAILER_SIZE);
+
+    while (skip >= seg->size)
+    {
+        skip -= seg->size;
+        ++seg;
+    }
+
+    while (left > 0 && ret == Z_OK)
+    {
+        unsigned char* out = (unsigned char*)seg->data + skip;
+        size_t n = seg->size - skip;
+        if (n > left)
+            n = left;
+
+        s.next_out = out;
+        s.avail_out = (uInt)n;
+        ret = inflate(&s, Z_SYNC_FLUSH);
+        if (s.avail_out != 0)
+            break;
+
+        crc = crc32(crc, out, (uInt)n);
+        left -= n;
+        skip = 0;
+        ++seg;
+    }
+
+    /* the stream must end exactly at the end of the member */
+    if (ret == Z_OK)
+    {
+        unsigned char extra;
+        s.next_out = &extra;
+        s.avail_out = 1;
+        ret = inflate(&s, Z_FINISH);
+        if (s.avail_out == 0)
+            ret = Z_DATA_ERROR;
+    }
+    inflateEnd(&s);
+
+    if (ret != Z_STREAM_END || left != 0
+     || get_le32(trailer) != (uint32_t)crc
+     || get_le32(trailer + 4) != (uint32_t)member->out_size)
+        return -1;
+
+    return 0;
+}
+
+static int gzip_worker(void* data)
+{
+    struct gzip_job* job = data;
+    size_t i;
+
+    while ((i = (size_t)SDL_AtomicAdd(&job->next, 1)) < job->count)
+    {
+        if (job->process(&job->members[i], job->level) != 0)
+            job->members[i].failed = 1;
+    }
+
+    return 0;
+}
+
+/* Process all members, on the calling thread plus up to threads-1 helpers */
+static int run_job(struct gzip_job* job, unsigned int threads)
+{
+    SDL_Thread* helpers[PARALLEL_GZIP_MAX_THREADS];
+    unsigned int count = 0;
+    size_t i;
+
+    if (threads == 0)
+        threads = (unsigned int)SDL_GetCPUCount();
+    if (threads > PARALLEL_GZIP_MAX_THREADS)
+        threads = PARALLEL_GZIP_MAX_THREADS;
+    if (threads > job->count)
+        threads = (unsigned int)job->count;
+
+    SDL_AtomicSet(&job->next, 0);
+
+    /* if a thread can't be created, the others take its share */
+    while (count + 1 < threads)
+    {
+#if SDL_VERSION_ATLEAST(2,0,0)
+        helpers[count] = SDL_CreateThread(gzip_worker, "m64pgzip", job);
+#else
+        helpers[count] = SDL_CreateThread(gzip_worker, job);
+#endif
+        if (helpers[count] == NULL)
+            break;
+        ++count;
+    }
+
+    gzip_worker(job);
+
+    for (i = 0; i < count; ++i)
+        SDL_WaitThread(helpers[i], NULL);
+
+    for (i = 0; i < job->count; ++i)
+    {
+        if (job->members[i].failed)
+            return -1;
+    }
+
+    return 0;
+}
+
+int parallel_gzip_write(FILE* f, const void* data, size_t size,
+                        size_t chunk_size, int level, unsigned int threads)
+{
+    struct gzip_job job;
+    size_t i;
+    int ret = -1;
+
+    memset(&job, 0, sizeof(job));
+    job.count = (size + chunk_size - 1) / chunk_size;
+    job.level = level;
+    job.process = compress_member;
+    job.members = calloc(job.count, sizeof(*job.members));
+    if (job.members == NULL)
+        return -1;
+
+    for (i = 0; i < job.count; ++i)
+    {
+        struct gzip_member* m = &job.members[i];
+        m->in = (const unsigned char*)data + i * chunk_size;
+        m->in_size = (i + 1 < job.count) ? chunk_size : size - i * chunk_size;
+        m->out_size = GZIP_HEADER_SIZE + compressBound((uLong)m->in_size) + GZIP_TRAILER_SIZE;
+        m->out = malloc(m->out_size);
+        if (m->out == NULL)
+            goto cleanup;
+    }
+
+    if (run_job(&job, threads) != 0)
+        goto cleanup;
+
+    for (i = 0; i < job.count; ++i)
+    {
+        if (fwrite(job.members[i].out, 1, job.members[i].out_size, f) != job.members[i].out_size)
+            goto cleanup;
+    }
+
+    ret = 0;
+
+cleanup:
+    for (i = 0; i < job.count; ++i)
+        free(job.members[i].out);
+    free(job.members);
+    return ret;
+}
+
+int parallel_gzip_readv(FILE* f, const struct parallel_gzip_segment* segments,
+                        size_t count, size_t* out_size, unsigned int threads)
+{
+    struct gzip_job job;
+    unsigned char header[GZIP_HEADER_SIZE];
+    unsigned char* file = NULL;
+    long file_size;
+    size_t pos;
+    size_t total = 0;
+    size_t size = 0;
+    size_t i;
+    int ret = -1;
+
+    for (i = 0; i < count; ++i)
+        size += segments[i].size;
+
+    /* cheap check of the first member before reading the whole file */
+    if (fread(header, 1, GZIP_HEADER_SIZE, f) != GZIP_HEADER_SIZE
+     || header[0] != 0x1f || header[1] != 0x8b || header[3] != 0x04
+     || header[10] != 12 || header[11] != 0 || header[12] != 'M' || header[13] != 'P')
+        return 0;
+
+    if (fseek(f, 0, SEEK_END) != 0 || (file_size = ftell(f)) <= 0 || fseek(f, 0, SEEK_SET) != 0)
+        return -1;
+
+    file = malloc((size_t)file_size);
+    if (file == NULL || fread(file, 1, (size_t)file_size, f) != (size_t)file_size)
+    {
+        free(file);
+        return -1;
+    }
+
+    memset(&job, 0, sizeof(job));
+    job.process = decompress_member;
+
+    /* count members, bailing out to the generic reader on anything else */
+    for (pos = 0; pos < (size_t)file_size; pos += get_le32(file + pos + 16))
+    {
+        const unsigned char* h = file + pos;
+        if ((size_t)file_size - pos < GZIP_HEADER_SIZE + GZIP_TRAILER_SIZE
+         || h[0] != 0x1f || h[1] != 0x8b || h[3] != 0x04 || h[10] != 12 || h[11] != 0
+         || h[12] != 'M' || h[13] != 'P' || h[14] != 8 || h[15] != 0
+         || get_le32(h + 16) < GZIP_HEADER_SIZE + GZIP_TRAILER_SIZE
+         || get_le32(h + 16) > (size_t)file_size - pos)
+        {
+            ret = 0;
+            goto cleanup;
+        }
+        ++job.count;
+    }
+
+    job.members = calloc(job.count, sizeof(*job.members));
+    if (job.members == NULL)
+        goto cleanup;
+
+    for (i = 0, pos = 0; i < job.count; ++i)
+    {
+        struct gzip_member* m = &job.members[i];
+        m->in = file + pos;
+        m->in_size = get_le32(file + pos + 16);
+        m->out_size = get_le32(file + pos + 20);
+        if (m->out_size > size - total)
+        {
+            DebugMessage(M64MSG_WARNING, "gzip data is larger than the %u bytes expected", (unsigned int)size);
+            goto cleanup;
+        }
+        m->segments = segments;
+        m->offset = total;
+        total += m->out_size;
+        pos += m->in_size;
+    }
+
+    if (run_job(&job, threads) != 0)
+        goto cleanup;
+
+    *out_size = total;
+    ret = 1;
+
+cleanup:
+    free(job.members);
+    free(file);
+    return ret;
+}
+
+int parallel_gzip_read(FILE* f, void* data, size_t size, size_t* out_size,
+                       unsigned int threads)
+{
+    struct parallel_gzip_segment segment;
+
+    segment.data = data;
+    segment.size = size;
+    return parallel_gzip_readv(f, &segment, 1, out_size, threads);
+}
+
+static int compress_buffer(struct gzip_member* member, int level)
+{
+    uLongf len = (uLongf)member->out_size;
+
+    if (compress2(member->out, &len, member->in, (uLong)member->in_size, level) != Z_OK)
+        return -1;
+
+    member->out_size = len;
+    return 0;
+}
+
+static int uncompress_buffer(struct gzip_member* member, int level)
+{
+    uLongf len = (uLongf)member->out_size;
+
+    (void)level;
+
+    if (uncompress(member->out, &len, member->in, (uLong)member->in_size) != Z_OK
+     || len != member->out_size)
+        return -1;
+
+    return 0;
+}
+
+static int run_zlib_job(struct parallel_zlib_buffer* buffers, size_t count, int level,
+                        unsigned int threads, int (*process)(struct gzip_member*, int))
+{
+    struct gzip_job job;
+    size_t i;
+    int ret;
+
+    if (count == 0)
+        return 0;
+
+    memset(&job, 0, sizeof(job));
+    job.count = count;
+    job.level = level;
+    job.process = process;
+    job.members = calloc(count, sizeof(*job.members));
+    if (job.members == NULL)
+        return -1;
+
+    for (i = 0; i < count; ++i)
+    {
+        job.members[i].in = buffers[i].in;
+        job.members[i].in_size = buffers[i].in_size;
+        job.members[i].out = buffers[i].out;
+        job.members[i].out_size = buffers[i].out_size;
+    }
+
+    ret = run_job(&job, threads);
+
+    for (i = 0; i < count; ++i)
+        buffers[i].out_size = job.members[i].out_size;
+
+    free(job.members);
+    return ret;
+}
+
+int parallel_zlib_compress(struct parallel_zlib_buffer* buffers, size_t count,
+                           int level, unsigned int threads)
+{
+    return run_zlib_job(buffers, count, level, threads, compress_buffer);
+}
+
+int parallel_zlib_uncompress(struct parallel_zlib_buffer* buffers, size_t count,
+                             unsigned int threads)
+{
+    return run_zlib_job(buffers, count, 0, threads, uncompress_buffer);
+}
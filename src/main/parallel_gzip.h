@@ -0,0 +1,79 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - parallel_gzip.h                                         *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_PARALLEL_GZIP_H
+#define M64P_MAIN_PARALLEL_GZIP_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* Data is compressed as a sequence of independent gzip members, one per
+ * chunk, like pigz does. Any gzip reader (gzread included) decompresses
+ * the concatenation. Each member carries an extra field with its
+ * compressed and uncompressed sizes, so that files written here can also
+ * be inflated in parallel.
+ *
+ * threads == 0 uses one thread per CPU.
+ */
+
+/* Write size bytes of data to f. Returns 0 on success, -1 on failure. */
+int parallel_gzip_write(FILE* f, const void* data, size_t size,
+                        size_t chunk_size, int level, unsigned int threads);
+
+/* Destination segment of a scattered read */
+struct parallel_gzip_segment
+{
+    void* data;
+    size_t size;
+};
+
+/* Inflate the content of f into the segments, in order. Returns 1 on
+ * success (with the uncompressed size in *out_size), 0 if f was not
+ * written by parallel_gzip_write (the position of f is then unspecified),
+ * and -1 on failure. The segments are only written to once f is known to
+ * have the right layout, but may be partially written on failure. */
+int parallel_gzip_readv(FILE* f, const struct parallel_gzip_segment* segments,
+                        size_t count, size_t* out_size, unsigned int threads);
+
+/* parallel_gzip_readv into a single buffer */
+int parallel_gzip_read(FILE* f, void* data, size_t size, size_t* out_size,
+                       unsigned int threads);
+
+/* Independent zlib streams, (de)compressed in parallel */
+struct parallel_zlib_buffer
+{
+    void* in;
+    size_t in_size;
+    void* out;
+    size_t out_size;
+};
+
+/* out must hold compressBound(in_size) bytes, out_size is updated to the
+ * compressed size. Returns 0 on success, -1 on failure. */
+int parallel_zlib_compress(struct parallel_zlib_buffer* buffers, size_t count,
+                           int level, unsigned int threads);
+
+/* out_size must be the exact uncompressed size.
+ * Returns 0 on success, -1 on failure. */
+int parallel_zlib_uncompress(struct parallel_zlib_buffer* buffers, size_t count,
+                             unsigned int threads);
+
+#endif
@@ -23,77 +23,271 @@
 
 #include "profile.h"
 
+#include <stddef.h>
+#include <string.h>
+
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
+#include "device/device.h"
+#include "main/main.h"
+#include "osal/timer.h"
+
+#define ARRAY_SIZE(x) (sizeof(x)/sizeof((x)[0]))
 
-static long long int time_in_section[NUM_TIMED_SECTIONS];
-static long long int last_start[NUM_TIMED_SECTIONS];
-
-#if defined(WIN32) && !defined(__MINGW32__)
-  // timing
-  #include <windows.h>
-
-  static long long int get_time(void)
-  {
-      LARGE_INTEGER counter;
-      QueryPerformanceCounter(&counter);
-      return counter.QuadPart;
-  }
-  static long long int time_to_nsec(long long int time)
-  {
-      static LARGE_INTEGER freq = { 0 };
-      if (freq.QuadPart == 0)
-          QueryPerformanceFrequency(&freq);
-      return time * 1000000000 / freq.QuadPart;
-  }
-
-#else  /* Not WIN32 */
-  // timing
-  #include <time.h>
-
-  static long long int get_time(void)
-  {
-     struct timespec ts;
-     clock_gettime(CLOCK_MONOTONIC, &ts);
-     return (long long int)ts.tv_sec * 1000000000 + ts.tv_nsec;
-  }
-  static long long int time_to_nsec(long long int time)
-  {
-      return time;
-  }
+/* Timestamps come from the TSC when there is one, they are converted to
+ * nanoseconds using the TSC rate measured since the last reset. */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+  #else
+    #include <x86intrin.h>
+  #endif
+  #define get_ticks() ((uint64_t)__rdtsc())
+#else
+  #define get_ticks() osal_monotonic_ns()
 #endif
 
-void timed_section_start(enum timed_section section)
+enum { TIMED_SECTIONS_MAX_DEPTH = 32 };
+
+struct timed_section_counters
+{
+    uint64_t calls;
+    uint64_t inclusive;
+    uint64_t exclusive;
+    int parent;
+};
+
+static const char* const l_section_names[NUM_TIMED_SECTIONS] =
+{
+    "emulation",
+    "gfx",
+    "audio",
+    "compiler",
+    "idle",
+    "rsp",
+    "video",
+    "interrupt",
+    "cheats",
+    "input",
+    "savestate",
+    "mmio_rdram",
+    "mmio_sp",
+    "mmio_dp",
+    "mmio_mi",
+    "mmio_vi",
+    "mmio_ai",
+    "mmio_pi",
+    "mmio_ri",
+    "mmio_si",
+    "mmio_pif",
+    "mmio_cart",
+    "mmio_dd",
+    "dma_sp",
+    "dma_pi",
+    "dma_si",
+    "dma_ai",
+};
+
+int g_timed_sections_enabled = 0;
+
+#if defined(PROFILE)
+static int l_requested = 1;
+static uint64_t l_window_start;
+static uint64_t l_window_inclusive[NUM_TIMED_SECTIONS];
+#else
+static int l_requested = 0;
+#endif
+
+static struct timed_section_counters l_counters[NUM_TIMED_SECTIONS];
+static enum timed_section l_stack[TIMED_SECTIONS_MAX_DEPTH];
+static uint64_t l_entered[TIMED_SECTIONS_MAX_DEPTH];
+static unsigned int l_depth;
+static uint64_t l_last;
+
+static uint64_t l_reset_ticks;
+static uint64_t l_reset_ns;
+
+static double ticks_per_ns(void)
+{
+    uint64_t ticks = get_ticks() - l_reset_ticks;
+    uint64_t ns = osal_monotonic_ns() - l_reset_ns;
+
+    return (ticks == 0 || ns == 0) ? 1.0 : (double)ticks / (double)ns;
+}
+
+void timed_section_push(enum timed_section section)
+{
+    uint64_t now;
+    enum timed_section parent;
+
+    /* register handlers are too frequent for the trace */
+    if (g_trace_enabled && section < TIMED_SECTION_MMIO_RDRAM)
+        trace_event(TRACE_BEGIN, l_section_names[section], 0);
+
+    if (!g_timed_sections_enabled || l_depth == 0 || l_depth >= TIMED_SECTIONS_MAX_DEPTH)
+        return;
+
+    now = get_ticks();
+
+    parent = l_stack[l_depth - 1];
+    l_counters[parent].exclusive += now - l_last;
+
+    l_stack[l_depth] = section;
+    l_entered[l_depth] = now;
+    ++l_depth;
+    l_last = now;
+
+    ++l_counters[section].calls;
+    l_counters[section].parent = (int)parent;
+}
+
+/* closes every section above depth */
+static void timed_sections_close(unsigned int depth, uint64_t now)
+{
+    while (l_depth > depth)
+    {
+        --l_depth;
+        l_counters[l_stack[l_depth]].exclusive += now - l_last;
+        l_counters[l_stack[l_depth]].inclusive += now - l_entered[l_depth];
+        l_last = now;
+    }
+}
+
+void timed_section_pop(enum timed_section section)
+{
+    uint64_t now;
+    unsigned int depth = l_depth;
+
+    if (g_trace_enabled && section < TIMED_SECTION_MMIO_RDRAM)
+        trace_event(TRACE_END, l_section_names[section], 0);
+
+    if (!g_timed_sections_enabled)
+        return;
+
+    now = get_ticks();
+
+    /* the root is only closed by timed_sections_stop */
+    while (depth > 1 && l_stack[depth - 1] != section)
+        --depth;
+
+    /* an end without start, e.g. the section was entered before the
+     * counters were enabled or the stack overflowed */
+    if (depth <= 1)
+        return;
+
+    timed_sections_close(depth - 1, now);
+}
+
+void timed_sections_stop(void)
+{
+    timed_sections_close(0, get_ticks());
+    g_timed_sections_enabled = 0;
+    device_timed_mmio(&g_dev, 0);
+}
+
+void timed_sections_enable(int enable)
+{
+    l_requested = (enable != 0);
+
+    /* the emulation thread picks it up at the next reset */
+    if (!g_EmulatorRunning)
+        g_timed_sections_enabled = l_requested;
+}
+
+int timed_sections_requested(void)
+{
+    return l_requested;
+}
+
+void timed_sections_reset(void)
 {
-   last_start[section] = get_time();
+    memset(l_counters, 0, sizeof(l_counters));
+    l_counters[TIMED_SECTION_ALL].parent = -1;
+
+    l_reset_ns = osal_monotonic_ns();
+    l_reset_ticks = l_last = get_ticks();
+
+    l_stack[0] = TIMED_SECTION_ALL;
+    l_entered[0] = l_last;
+    l_depth = 1;
+    l_counters[TIMED_SECTION_ALL].calls = 1;
+
+#if defined(PROFILE)
+    l_window_start = l_last;
+    memset(l_window_inclusive, 0, sizeof(l_window_inclusive));
+#endif
+
+    g_timed_sections_enabled = l_requested;
+    device_timed_mmio(&g_dev, g_timed_sections_enabled);
 }
 
-void timed_section_end(enum timed_section section)
+void timed_sections_refresh(void)
 {
-   long long int end = get_time();
-   time_in_section[section] += end - last_start[section];
+    if (l_requested != g_timed_sections_enabled)
+    {
+        if (l_requested)
+            timed_sections_reset();
+        else
+            timed_sections_stop();
+    }
+
+#if defined(PROFILE)
+    if (g_timed_sections_enabled)
+    {
+        static const enum timed_section sections[] =
+            { TIMED_SECTION_GFX, TIMED_SECTION_AUDIO, TIMED_SECTION_COMPILER, TIMED_SECTION_IDLE };
+        double window[ARRAY_SIZE(sections)];
+        double rate = ticks_per_ns();
+        uint64_t now = get_ticks();
+        double elapsed = (double)(now - l_window_start);
+        size_t i;
+
+        if (elapsed / rate < 2000000000.0)
+            return;
+
+        for (i = 0; i < ARRAY_SIZE(sections); ++i)
+        {
+            window[i] = (double)(l_counters[sections[i]].inclusive - l_window_inclusive[sections[i]]);
+            l_window_inclusive[sections[i]] = l_counters[sections[i]].inclusive;
+        }
+        l_window_start = now;
+
+        DebugMessage(M64MSG_INFO, "gfx=%f%% - audio=%f%% - compiler=%f%%, idle=%f%%",
+            100.0 * window[0] / elapsed, 100.0 * window[1] / elapsed,
+            100.0 * window[2] / elapsed, 100.0 * window[3] / elapsed);
+        DebugMessage(M64MSG_INFO, "gfx=%.0fns - audio=%.0fns - compiler %.0fns - idle=%.0fns",
+            window[0] / rate, window[1] / rate, window[2] / rate, window[3] / rate);
+    }
+#endif
 }
 
-void timed_sections_refresh()
+void timed_sections_get(struct timed_section_stats stats[NUM_TIMED_SECTIONS])
 {
-   long long int curr_time = get_time();
-   if(time_to_nsec(curr_time - last_start[TIMED_SECTION_ALL]) >= 2000000000)
-   {
-      time_in_section[TIMED_SECTION_ALL] = curr_time - last_start[TIMED_SECTION_ALL];
-      DebugMessage(M64MSG_INFO, "gfx=%f%% - audio=%f%% - compiler=%f%%, idle=%f%%",
-         100.0 * (double)time_in_section[TIMED_SECTION_GFX] / time_in_section[TIMED_SECTION_ALL],
-         100.0 * (double)time_in_section[TIMED_SECTION_AUDIO] / time_in_section[TIMED_SECTION_ALL],
-         100.0 * (double)time_in_section[TIMED_SECTION_COMPILER] / time_in_section[TIMED_SECTION_ALL],
-         100.0 * (double)time_in_section[TIMED_SECTION_IDLE] / time_in_section[TIMED_SECTION_ALL]);
-      DebugMessage(M64MSG_INFO, "gfx=%llins - audio=%llins - compiler %llins - idle=%llins",
-         time_to_nsec(time_in_section[TIMED_SECTION_GFX]),
-         time_to_nsec(time_in_section[TIMED_SECTION_AUDIO]),
-         time_to_nsec(time_in_section[TIMED_SECTION_COMPILER]),
-         time_to_nsec(time_in_section[TIMED_SECTION_IDLE]));
-      time_in_section[TIMED_SECTION_GFX] = 0;
-      time_in_section[TIMED_SECTION_AUDIO] = 0;
-      time_in_section[TIMED_SECTION_COMPILER] = 0;
-      time_in_section[TIMED_SECTION_IDLE] = 0;
-      last_start[TIMED_SECTION_ALL] = curr_time;
-   }
+    uint64_t inclusive[NUM_TIMED_SECTIONS];
+    uint64_t exclusive[NUM_TIMED_SECTIONS];
+    uint64_t now = get_ticks();
+    double rate = ticks_per_ns();
+    unsigned int d;
+    int i;
+
+    for (i = 0; i < NUM_TIMED_SECTIONS; ++i)
+    {
+        inclusive[i] = l_counters[i].inclusive;
+        exclusive[i] = l_counters[i].exclusive;
+    }
+
+    /* account for the sections still open */
+    for (d = 0; d < l_depth; ++d)
+        inclusive[l_stack[d]] += now - l_entered[d];
+    if (l_depth > 0)
+        exclusive[l_stack[l_depth - 1]] += now - l_last;
+
+    for (i = 0; i < NUM_TIMED_SECTIONS; ++i)
+    {
+        stats[i].name = l_section_names[i];
+        stats[i].parent = (i == TIMED_SECTION_ALL) ? -1 : l_counters[i].parent;
+        stats[i].calls = l_counters[i].calls;
+        stats[i].inclusive_ns = (uint64_t)((double)inclusive[i] / rate);
+        stats[i].exclusive_ns = (uint64_t)((double)exclusive[i] / rate);
+    }
 }
@@ -24,6 +24,15 @@
 #ifndef PROFILE_H
 #define PROFILE_H
 
+#include <stdint.h>
+
+#include "osal/preproc.h"
+#include "trace.h"
+
+/* Sections nest freely: time spent in a section while another one is open
+ * is charged to the inner one (exclusive time) and to both (inclusive time).
+ * TIMED_SECTION_ALL is the root, opened when emulation starts, so its
+ * exclusive time is the time spent executing r4300 code. */
 enum timed_section
 {
     TIMED_SECTION_ALL,
@@ -31,11 +40,74 @@ enum timed_section
     TIMED_SECTION_AUDIO,
     TIMED_SECTION_COMPILER,
     TIMED_SECTION_IDLE,
+    TIMED_SECTION_RSP,
+    TIMED_SECTION_VIDEO,
+    TIMED_SECTION_INTERRUPT,
+    TIMED_SECTION_CHEATS,
+    TIMED_SECTION_INPUT,
+    TIMED_SECTION_SAVESTATE,
+    TIMED_SECTION_MMIO_RDRAM,
+    TIMED_SECTION_MMIO_SP,
+    TIMED_SECTION_MMIO_DP,
+    TIMED_SECTION_MMIO_MI,
+    TIMED_SECTION_MMIO_VI,
+    TIMED_SECTION_MMIO_AI,
+    TIMED_SECTION_MMIO_PI,
+    TIMED_SECTION_MMIO_RI,
+    TIMED_SECTION_MMIO_SI,
+    TIMED_SECTION_MMIO_PIF,
+    TIMED_SECTION_MMIO_CART,
+    TIMED_SECTION_MMIO_DD,
+    TIMED_SECTION_DMA_SP,
+    TIMED_SECTION_DMA_PI,
+    TIMED_SECTION_DMA_SI,
+    TIMED_SECTION_DMA_AI,
     NUM_TIMED_SECTIONS
 };
 
-void timed_section_start(enum timed_section section);
-void timed_section_end(enum timed_section section);
+struct timed_section_stats
+{
+    const char* name;
+    int parent;                 /* section it was last entered from, -1 for the root */
+    uint64_t calls;
+    uint64_t inclusive_ns;
+    uint64_t exclusive_ns;
+};
+
+/* only read by the emulation thread, see timed_sections_enable.
+ * Sections are also recorded by the tracer when it is enabled. */
+extern int g_timed_sections_enabled;
+
+void timed_section_push(enum timed_section section);
+void timed_section_pop(enum timed_section section);
+
+static osal_inline void timed_section_start(enum timed_section section)
+{
+    if (g_timed_sections_enabled || g_trace_enabled)
+        timed_section_push(section);
+}
+
+static osal_inline void timed_section_end(enum timed_section section)
+{
+    if (g_timed_sections_enabled || g_trace_enabled)
+        timed_section_pop(section);
+}
+
+/* Requests enabling or disabling the counters. While emulation is running the
+ * request is applied by timed_sections_refresh on the next VI. */
+void timed_sections_enable(int enable);
+int timed_sections_requested(void);
+
+/* called once per VI from the emulation thread */
 void timed_sections_refresh(void);
 
+/* clears the counters and opens the root section, called when emulation starts */
+void timed_sections_reset(void);
+
+/* closes every open section, called when emulation stops */
+void timed_sections_stop(void);
+
+/* counters accumulated since the last reset, sections still open included */
+void timed_sections_get(struct timed_section_stats stats[NUM_TIMED_SECTIONS]);
+
 #endif
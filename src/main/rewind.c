@@ -0,0 +1,392 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rewind.c                                                *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "rewind.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "main/footprint.h"
+#include "osal/timer.h"
+#include "savestates.h"
+
+enum { REWIND_PAGE_SIZE = 0x1000 };
+enum { REWIND_PAGE_WORDS = REWIND_PAGE_SIZE / sizeof(uint32_t) };
+enum { REWIND_MAX_SNAPSHOTS = 0x10000 };
+
+/* Delta layout, in 32-bit words:
+ *   size (in words, including this header), page count
+ *   for each page: page index, then tokens until the page is covered.
+ *   A token is (unchanged words << 16) | changed words, followed by the
+ *   XOR of the changed words.
+ */
+enum { REWIND_DELTA_HEADER_WORDS = 2 };
+
+struct rewind_delta
+{
+    size_t offset;
+    size_t size;
+};
+
+static struct
+{
+    int enabled;
+    unsigned int interval;
+    unsigned int vi_count;
+    unsigned int steps;
+    enum rewind_job job;
+
+    size_t state_words;
+    uint32_t* ref;
+    uint32_t* cur;
+    uint32_t* scratch;
+    size_t scratch_size;
+    int ref_valid;
+    int ref_loaded;
+
+    unsigned char* ring;
+    size_t ring_size;
+    size_t ring_used;
+    struct rewind_delta* deltas;
+    size_t first;
+    size_t count;
+
+    uint64_t captures;
+    uint64_t restores;
+    uint64_t evictions;
+    uint64_t last_delta_size;
+    uint64_t capture_total_ns;
+    uint64_t capture_max_ns;
+    uint64_t restore_last_ns;
+    uint64_t restore_max_ns;
+} l_rewind;
+
+int rewind_init(size_t budget, unsigned int interval)
+{
+    size_t state_size = savestates_memory_size();
+    size_t pages = (state_size + REWIND_PAGE_SIZE - 1) / REWIND_PAGE_SIZE;
+
+    rewind_deinit();
+
+    /* worst case: every page fully changed, with a token every 3 words */
+    l_rewind.state_words = state_size / sizeof(uint32_t);
+    l_rewind.ref = malloc(state_size);
+    l_rewind.cur = malloc(state_size);
+    l_rewind.scratch_size = (REWIND_DELTA_HEADER_WORDS + pages * (1 + REWIND_PAGE_WORDS + REWIND_PAGE_WORDS / 2)) * sizeof(uint32_t);
+    l_rewind.scratch = malloc(l_rewind.scratch_size);
+    l_rewind.ring = malloc(budget);
+    l_rewind.deltas = malloc(REWIND_MAX_SNAPSHOTS * sizeof(*l_rewind.deltas));
+
+    if (l_rewind.ref == NULL || l_rewind.cur == NULL || l_rewind.scratch == NULL
+     || l_rewind.ring == NULL || l_rewind.deltas == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to allocate %u MB for the rewind history",
+                     (unsigned int)((budget + 3 * state_size) / (1024 * 1024)));
+        rewind_deinit();
+        return -1;
+    }
+
+    l_rewind.ring_size = budget;
+    l_rewind.interval = (interval == 0) ? 1 : interval;
+    l_rewind.enabled = 1;
+
+    DebugMessage(M64MSG_INFO, "Rewind: snapshot every %u VI, %u MB history",
+                 l_rewind.interval, (unsigned int)(budget / (1024 * 1024)));
+    return 0;
+}
+
+void rewind_deinit(void)
+{
+    free(l_rewind.ref);
+    free(l_rewind.cur);
+    free(l_rewind.scratch);
+    free(l_rewind.ring);
+    free(l_rewind.deltas);
+    memset(&l_rewind, 0, sizeof(l_rewind));
+}
+
+int rewind_is_enabled(void)
+{
+    return l_rewind.enabled;
+}
+
+void rewind_vi(void)
+{
+    if (!l_rewind.enabled)
+        return;
+
+    if (++l_rewind.vi_count >= l_rewind.interval && l_rewind.job == rewind_job_nothing)
+    {
+        l_rewind.vi_count = 0;
+        l_rewind.job = rewind_job_capture;
+    }
+}
+
+void rewind_step(unsigned int steps)
+{
+    if (!l_rewind.enabled)
+        return;
+
+    l_rewind.steps = steps;
+    l_rewind.job = rewind_job_restore;
+}
+
+enum rewind_job rewind_get_job(void)
+{
+    return l_rewind.job;
+}
+
+/* Encode the XOR of the pages differing between cur and ref into out.
+ * Returns the size of the delta in words. */
+static size_t rewind_encode(uint32_t* out, const uint32_t* cur, const uint32_t* ref, size_t words)
+{
+    uint32_t* p = out + REWIND_DELTA_HEADER_WORDS;
+    size_t page_count = 0;
+    size_t base;
+
+    for (base = 0; base < words; base += REWIND_PAGE_WORDS)
+    {
+        size_t n = (words - base < REWIND_PAGE_WORDS) ? words - base : REWIND_PAGE_WORDS;
+        const uint32_t* c = cur + base;
+        const uint32_t* r = ref + base;
+        size_t i = 0;
+
+        if (memcmp(c, r, n * sizeof(uint32_t)) == 0)
+            continue;
+
+        *p++ = (uint32_t)(base / REWIND_PAGE_WORDS);
+        ++page_count;
+
+        while (i < n)
+        {
+            uint32_t* token = p++;
+            uint32_t same = 0;
+            uint32_t changed = 0;
+
+            while (i < n && c[i] == r[i]) { ++i; ++same; }
+
+            /* don't break a changed run for a single unchanged word */
+            while (i < n && (c[i] != r[i] || (i + 1 < n && c[i + 1] != r[i + 1])))
+            {
+                *p++ = c[i] ^ r[i];
+                ++i; ++changed;
+            }
+
+            *token = (same << 16) | changed;
+        }
+    }
+
+    out[0] = (uint32_t)(p - out);
+    out[1] = (uint32_t)page_count;
+    return (size_t)(p - out);
+}
+
+/* XOR a delta into state */
+static void rewind_apply(uint32_t* state, const uint32_t* delta, size_t words)
+{
+    const uint32_t* p = delta + REWIND_DELTA_HEADER_WORDS;
+    uint32_t pages = delta[1];
+
+    while (pages-- > 0)
+    {
+        size_t base = (size_t)*p++ * REWIND_PAGE_WORDS;
+        size_t n = (words - base < REWIND_PAGE_WORDS) ? words - base : REWIND_PAGE_WORDS;
+        uint32_t* s = state + base;
+        size_t i = 0;
+
+        while (i < n)
+        {
+            uint32_t token = *p++;
+            uint32_t changed = token & 0xffff;
+
+            i += token >> 16;
+            while (changed-- > 0)
+                s[i++] ^= *p++;
+        }
+    }
+}
+
+static void rewind_evict_oldest(void)
+{
+    l_rewind.ring_used -= l_rewind.deltas[l_rewind.first].size;
+    l_rewind.first = (l_rewind.first + 1) % REWIND_MAX_SNAPSHOTS;
+    --l_rewind.count;
+    ++l_rewind.evictions;
+}
+
+static void rewind_push(const uint32_t* delta, size_t size)
+{
+    struct rewind_delta* d;
+    size_t pos = 0;
+
+    if (size > l_rewind.ring_size)
+    {
+        /* the chain is broken anyway: history restarts at the reference */
+        while (l_rewind.count > 0)
+            rewind_evict_oldest();
+        return;
+    }
+
+    if (l_rewind.count == REWIND_MAX_SNAPSHOTS)
+        rewind_evict_oldest();
+
+    if (l_rewind.count > 0)
+    {
+        const struct rewind_delta* newest = &l_rewind.deltas[(l_rewind.first + l_rewind.count - 1) % REWIND_MAX_SNAPSHOTS];
+        pos = newest->offset + newest->size;
+
+        if (pos + size > l_rewind.ring_size)
+        {
+            /* wrap: everything stored after the newest delta is older */
+            while (l_rewind.count > 0 && l_rewind.deltas[l_rewind.first].offset >= pos)
+                rewind_evict_oldest();
+            pos = 0;
+        }
+
+        while (l_rewind.count > 0
+            && l_rewind.deltas[l_rewind.first].offset < pos + size
+            && l_rewind.deltas[l_rewind.first].offset + l_rewind.deltas[l_rewind.first].size > pos)
+            rewind_evict_oldest();
+    }
+
+    if (l_rewind.count == 0)
+        pos = 0;
+
+    d = &l_rewind.deltas[(l_rewind.first + l_rewind.count) % REWIND_MAX_SNAPSHOTS];
+    d->offset = pos;
+    d->size = size;
+    memcpy(l_rewind.ring + pos, delta, size);
+    l_rewind.ring_used += size;
+    ++l_rewind.count;
+}
+
+int rewind_capture(void)
+{
+    uint64_t start = osal_monotonic_ns();
+    uint64_t elapsed;
+    uint32_t* tmp;
+
+    l_rewind.job = rewind_job_nothing;
+
+    if (!savestates_save_m64p_buffer(l_rewind.cur, l_rewind.state_words * sizeof(uint32_t)))
+        return 0;
+
+    if (l_rewind.ref_valid)
+    {
+        /* backward delta: turns the new reference back into the previous one */
+        size_t words = rewind_encode(l_rewind.scratch, l_rewind.cur, l_rewind.ref, l_rewind.state_words);
+        l_rewind.last_delta_size = words * sizeof(uint32_t);
+        rewind_push(l_rewind.scratch, words * sizeof(uint32_t));
+    }
+
+    tmp = l_rewind.ref;
+    l_rewind.ref = l_rewind.cur;
+    l_rewind.cur = tmp;
+    l_rewind.ref_valid = 1;
+    l_rewind.ref_loaded = 0;
+
+    elapsed = osal_monotonic_ns() - start;
+    ++l_rewind.captures;
+    l_rewind.capture_total_ns += elapsed;
+    if (elapsed > l_rewind.capture_max_ns)
+        l_rewind.capture_max_ns = elapsed;
+
+    return 1;
+}
+
+int rewind_restore(void)
+{
+    uint64_t start = osal_monotonic_ns();
+    uint64_t elapsed;
+    unsigned int steps = l_rewind.steps;
+    void* state;
+    int ret;
+
+    l_rewind.job = rewind_job_nothing;
+    l_rewind.vi_count = 0;
+
+    if (!l_rewind.ref_valid)
+    {
+        StateChanged(M64CORE_STATE_LOADCOMPLETE, 0);
+        return 0;
+    }
+
+    /* the reference itself is the first step back, unless
+     * nothing was captured since it was last loaded */
+    if (l_rewind.ref_loaded)
+        ++steps;
+
+    while (steps-- > 1 && l_rewind.count > 0)
+    {
+        size_t newest = (l_rewind.first + l_rewind.count - 1) % REWIND_MAX_SNAPSHOTS;
+        rewind_apply(l_rewind.ref, (const uint32_t*)(l_rewind.ring + l_rewind.deltas[newest].offset), l_rewind.state_words);
+        l_rewind.ring_used -= l_rewind.deltas[newest].size;
+        --l_rewind.count;
+    }
+
+    /* loading byte swaps the buffer in place on big endian hosts */
+    state = l_rewind.ref;
+#if defined(M64P_BIG_ENDIAN)
+    memcpy(l_rewind.cur, l_rewind.ref, l_rewind.state_words * sizeof(uint32_t));
+    state = l_rewind.cur;
+#endif
+    ret = savestates_load_m64p_buffer(state, l_rewind.state_words * sizeof(uint32_t));
+    l_rewind.ref_loaded = 1;
+
+    elapsed = osal_monotonic_ns() - start;
+    ++l_rewind.restores;
+    l_rewind.restore_last_ns = elapsed;
+    if (elapsed > l_rewind.restore_max_ns)
+        l_rewind.restore_max_ns = elapsed;
+
+    StateChanged(M64CORE_STATE_LOADCOMPLETE, ret);
+    return ret;
+}
+
+void rewind_get_stats(m64p_rewind_stats* stats)
+{
+    stats->buffer_size = l_rewind.ring_size;
+    stats->buffer_used = l_rewind.ring_used;
+    stats->snapshots = (uint32_t)(l_rewind.count + (l_rewind.ref_valid ? 1 : 0));
+    stats->interval = l_rewind.interval;
+    stats->captures = l_rewind.captures;
+    stats->restores = l_rewind.restores;
+    stats->evictions = l_rewind.evictions;
+    stats->last_delta_size = l_rewind.last_delta_size;
+    stats->capture_avg_ns = (l_rewind.captures > 0) ? l_rewind.capture_total_ns / l_rewind.captures : 0;
+    stats->capture_max_ns = l_rewind.capture_max_ns;
+    stats->restore_last_ns = l_rewind.restore_last_ns;
+    stats->restore_max_ns = l_rewind.restore_max_ns;
+}
+
+void rewind_footprint(m64p_memory_footprint* entry)
+{
+    size_t state_size = l_rewind.state_words * sizeof(uint32_t);
+
+    footprint_add(entry, l_rewind.ref, state_size);
+    footprint_add(entry, l_rewind.cur, state_size);
+    footprint_add(entry, l_rewind.scratch, l_rewind.scratch_size);
+    footprint_add(entry, l_rewind.ring, l_rewind.ring_size);
+    footprint_add(entry, l_rewind.deltas, REWIND_MAX_SNAPSHOTS * sizeof(*l_rewind.deltas));
+}
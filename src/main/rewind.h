@@ -0,0 +1,68 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rewind.h                                                *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_REWIND_H
+#define M64P_MAIN_REWIND_H
+
+#include <stddef.h>
+
+#include "api/m64p_types.h"
+
+/* Rewind history made of uncompressed m64p states.
+ *
+ * The newest snapshot is kept whole (the reference); every older one is
+ * stored in a byte ring as the XOR of its changed 4KB pages against the
+ * next newer snapshot, with runs of unchanged words elided. Stepping back
+ * applies the newest delta to the reference and loads it.
+ * When the ring is full the oldest deltas are evicted.
+ */
+
+enum rewind_job
+{
+    rewind_job_nothing,
+    rewind_job_capture,
+    rewind_job_restore
+};
+
+/* Allocate the history. budget is the ring size in bytes, interval the
+ * number of VIs between two snapshots. Returns 0 on success. */
+int rewind_init(size_t budget, unsigned int interval);
+void rewind_deinit(void);
+int rewind_is_enabled(void);
+
+/* Called on every VI, schedules the next capture */
+void rewind_vi(void);
+
+/* Schedule a restore of the snapshot taken steps snapshots ago
+ * (steps == 1 being the newest one) */
+void rewind_step(unsigned int steps);
+
+/* Pending job, run by gen_interrupt like savestates jobs */
+enum rewind_job rewind_get_job(void);
+int rewind_capture(void);
+int rewind_restore(void);
+
+void rewind_get_stats(m64p_rewind_stats* stats);
+
+/* Account the history buffers to entry */
+void rewind_footprint(m64p_memory_footprint* entry);
+
+#endif
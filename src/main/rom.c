@@ -44,6 +44,8 @@
 #include "osal/preproc.h"
 #include "osd/osd.h"
 #include "rom.h"
+#include "rom_cache.h"
+#include "rom_index.h"
 #include "util.h"
 
 #define CHUNKSIZE 1024*128 /* Read files 128KB at a time. */
@@ -58,6 +60,8 @@ enum { DEFAULT_SI_DMA_DURATION = 0x900 };
 enum { DEFAULT_AI_DMA_MODIFIER = 100 };
 
 static romdatabase_entry* ini_search_by_md5(md5_byte_t* md5);
+static romdatabase_entry* list_search_by_md5(md5_byte_t* md5);
+static void romdatabase_free_lists(void);
 
 static _romdatabase g_romdatabase;
 
@@ -87,43 +91,50 @@ static int is_valid_rom(const unsigned char *buffer)
         return 0;
 }
 
+/* Returns V64IMAGE, N64IMAGE or Z64IMAGE according to the byte order of a
+ * valid Nintendo 64 ROM image. */
+static unsigned char rom_image_type(const unsigned char* image)
+{
+    if (memcmp(image, V64_SIGNATURE, sizeof(V64_SIGNATURE)) == 0)
+        return V64IMAGE;
+    else if (memcmp(image, N64_SIGNATURE, sizeof(N64_SIGNATURE)) == 0)
+        return N64IMAGE;
+    else
+        return Z64IMAGE;
+}
+
 /* Copies the source block of memory to the destination block of memory while
  * switching the endianness of .v64 and .n64 images to the .z64 format, which
  * is native to the Nintendo 64. The data extraction routines and MD5 hashing
- * function may only act on the .z64 big-endian format.
+ * function may then be used on the destination block.
  *
- * IN: src: The source block of memory. This must be a valid Nintendo 64 ROM
- *          image of 'len' bytes.
+ * IN: src: A block of 'len' bytes of a Nintendo 64 ROM image.
  *     len: The length of the source and destination, in bytes.
+ *     imagetype: V64IMAGE, N64IMAGE or Z64IMAGE, as returned by
+ *                rom_image_type for the start of the image.
  * OUT: dst: The destination block of memory. This must be a valid buffer for
  *           at least 'len' bytes.
- *      imagetype: A pointer to a byte that gets updated with the value of
- *                 V64IMAGE, N64IMAGE or Z64IMAGE according to the format of
- *                 the source block. The value is undefined if 'src' does not
- *                 represent a valid Nintendo 64 ROM image.
  */
-static void swap_copy_rom(void* dst, const void* src, size_t len, unsigned char* imagetype)
+static void swap_copy_rom(void* dst, const void* src, size_t len, unsigned char imagetype)
 {
-    if (memcmp(src, V64_SIGNATURE, sizeof(V64_SIGNATURE)) == 0)
+    if (imagetype == V64IMAGE)
     {
         size_t i;
         const uint16_t* src16 = (const uint16_t*) src;
         uint16_t* dst16 = (uint16_t*) dst;
 
-        *imagetype = V64IMAGE;
         /* .v64 images have byte-swapped half-words (16-bit). */
         for (i = 0; i < len; i += 2)
         {
             *dst16++ = m64p_swap16(*src16++);
         }
     }
-    else if (memcmp(src, N64_SIGNATURE, sizeof(N64_SIGNATURE)) == 0)
+    else if (imagetype == N64IMAGE)
     {
         size_t i;
         const uint32_t* src32 = (const uint32_t*) src;
         uint32_t* dst32 = (uint32_t*) dst;
 
-        *imagetype = N64IMAGE;
         /* .n64 images have byte-swapped words (32-bit). */
         for (i = 0; i < len; i += 4)
         {
@@ -131,40 +142,140 @@ static void swap_copy_rom(void* dst, const void* src, size_t len, unsigned char*
         }
     }
     else {
-        *imagetype = Z64IMAGE;
         memcpy(dst, src, len);
     }
 }
 
-m64p_error open_rom(const unsigned char* romimage, unsigned int size)
+/* Same as swap_copy_rom, but the destination gets the ROM as host endian
+ * 32-bit words, which is how the cart ROM region is accessed. This is a
+ * single pass over the image whatever its format; the loops are simple
+ * enough for the compiler to vectorize. */
+static void swap_copy_rom_words(uint32_t* dst, const void* src, size_t len, unsigned char imagetype)
+{
+#if defined(M64P_BIG_ENDIAN)
+    swap_copy_rom(dst, src, len, imagetype);
+#else
+    const uint32_t* src32 = (const uint32_t*) src;
+    size_t count = (len + 3) / 4;
+    size_t i;
+
+    if (imagetype == V64IMAGE)
+    {
+        /* swapped half-words of big endian words: swap the half-words */
+        for (i = 0; i < count; ++i)
+            dst[i] = (src32[i] << 16) | (src32[i] >> 16);
+    }
+    else if (imagetype == N64IMAGE)
+    {
+        /* .n64 images already are little endian words */
+        memcpy(dst, src, len);
+    }
+    else
+    {
+        for (i = 0; i < count; ++i)
+            dst[i] = m64p_swap32(src32[i]);
+    }
+#endif
+}
+
+/* MD5 of the ROM in .z64 format */
+static void rom_md5(md5_byte_t* digest, const unsigned char* image, size_t size, unsigned char imagetype)
 {
     md5_state_t state;
-    md5_byte_t digest[16];
-    romdatabase_entry* entry;
-    char buffer[256];
-    unsigned char imagetype;
-    int i;
 
-    /* check input requirements */
-    if (romimage == NULL || !is_valid_rom(romimage))
+    md5_init(&state);
+    if (imagetype == Z64IMAGE)
     {
-        DebugMessage(M64MSG_ERROR, "open_rom(): not a valid ROM image");
-        return M64ERR_INPUT_INVALID;
+        md5_append(&state, (const md5_byte_t*)image, size);
     }
+    else
+    {
+        uint32_t block[0x1000];
+        size_t offset, n;
 
-    /* Clear Byte-swapped flag, since ROM is now deleted. */
-    g_RomWordsLittleEndian = 0;
-    /* allocate new buffer for ROM and copy into this buffer */
-    g_rom_size = size;
-    swap_copy_rom((uint8_t*)mem_base_u32(g_mem_base, MM_CART_ROM), romimage, size, &imagetype);
-    /* ROM is now in N64 native (big endian) byte order */
+        for (offset = 0; offset < size; offset += n)
+        {
+            n = (size - offset < sizeof(block)) ? size - offset : sizeof(block);
+            swap_copy_rom(block, image + offset, n, imagetype);
+            md5_append(&state, (const md5_byte_t*)block, n);
+        }
+    }
+    md5_finish(&state, digest);
+}
 
-    memcpy(&ROM_HEADER, (uint8_t*)mem_base_u32(g_mem_base, MM_CART_ROM), sizeof(m64p_rom_header));
+/* MD5 of the image in the cart ROM region, to verify a cached digest */
+static void rom_region_md5(unsigned char* digest, void* opaque)
+{
+    (void)opaque;
+#if defined(M64P_BIG_ENDIAN)
+    rom_md5(digest, (const unsigned char*)mem_base_u32(g_mem_base, MM_CART_ROM), g_rom_size, Z64IMAGE);
+#else
+    /* little endian host words hold the bytes in .n64 order */
+    rom_md5(digest, (const unsigned char*)mem_base_u32(g_mem_base, MM_CART_ROM), g_rom_size, N64IMAGE);
+#endif
+}
+
+/* MD5 of an image, taken from the ROM identity cache when possible.
+ * A cached digest is checked in the background by calling verify with
+ * opaque. release is called with opaque once the image isn't needed. */
+static void image_md5(md5_byte_t* digest, const char* filename, const unsigned char* image, size_t size,
+                      unsigned char imagetype, rom_cache_digest_fn verify, rom_cache_release_fn release, void* opaque)
+{
+    struct rom_identity id;
+
+    if (!ConfigGetParamBool(g_CoreConfig, "RomCache"))
+    {
+        rom_md5(digest, image, size, imagetype);
+    }
+    else
+    {
+        rom_cache_identify(&id, filename, image, size);
+        if (!rom_cache_lookup(&id, digest))
+        {
+            rom_md5(digest, image, size, imagetype);
+            rom_cache_store(&id, digest);
+        }
+        else
+        {
+            DebugMessage(M64MSG_VERBOSE, "MD5 taken from the ROM identity cache");
+            if (verify != NULL && ConfigGetParamBool(g_CoreConfig, "RomCacheVerify"))
+            {
+                rom_cache_verify(&id, digest, verify, release, opaque);
+                return;
+            }
+        }
+    }
+
+    if (release != NULL)
+        release(opaque);
+}
+
+/* Size of the ROM file mapped in the cart ROM region, 0 if it was copied */
+static size_t l_rom_mapped_size = 0;
+
+static void rom_unmap_file(void)
+{
+    if (l_rom_mapped_size == 0)
+        return;
+
+    if (osal_file_unmap_at(mem_base_u32(g_mem_base, MM_CART_ROM), l_rom_mapped_size) != 0)
+        DebugMessage(M64MSG_WARNING, "Could not unmap ROM file");
+    l_rom_mapped_size = 0;
+}
+
+/* Fill in the ROM header, parameters and settings of the image, which is
+ * already in the cart ROM region */
+static m64p_error identify_rom(const char* filename, const unsigned char* romimage, unsigned char imagetype)
+{
+    md5_byte_t digest[16];
+    romdatabase_entry* entry;
+    char buffer[256];
+    int i;
+
+    swap_copy_rom(&ROM_HEADER, romimage, sizeof(m64p_rom_header), imagetype);
 
     /* Calculate MD5 hash  */
-    md5_init(&state);
-    md5_append(&state, (const md5_byte_t*)((uint8_t*)mem_base_u32(g_mem_base, MM_CART_ROM)), g_rom_size);
-    md5_finish(&state, digest);
+    image_md5(digest, filename, romimage, g_rom_size, imagetype, rom_region_md5, NULL, NULL);
     for ( i = 0; i < 16; ++i )
         sprintf(buffer+i*2, "%02X", digest[i]);
     buffer[32] = '\0';
@@ -249,8 +360,92 @@ m64p_error open_rom(const unsigned char* romimage, unsigned int size)
     return M64ERR_SUCCESS;
 }
 
+m64p_error open_rom(const unsigned char* romimage, unsigned int size)
+{
+    unsigned char imagetype;
+
+    /* check input requirements */
+    if (romimage == NULL || !is_valid_rom(romimage) || size > CART_ROM_MAX_SIZE)
+    {
+        DebugMessage(M64MSG_ERROR, "open_rom(): not a valid ROM image");
+        return M64ERR_INPUT_INVALID;
+    }
+
+    rom_cache_verify_wait();
+    rom_unmap_file();
+    imagetype = rom_image_type(romimage);
+    g_rom_size = size;
+
+    /* copy the ROM straight into the byte order used by the cart ROM region */
+    swap_copy_rom_words(mem_base_u32(g_mem_base, MM_CART_ROM), romimage, size, imagetype);
+#if !defined(M64P_BIG_ENDIAN)
+    g_RomWordsLittleEndian = 1;
+#endif
+
+    return identify_rom(NULL, romimage, imagetype);
+}
+
+m64p_error open_rom_file(const char* filename)
+{
+    uint32_t* rom = mem_base_u32(g_mem_base, MM_CART_ROM);
+    unsigned char* romimage;
+    unsigned char imagetype;
+    size_t size = 0;
+    m64p_error ret;
+
+    /* read through a private mapping, the file is only paged in once */
+    romimage = (unsigned char*)osal_file_map(filename, &size);
+    if (romimage == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "open_rom_file(): couldn't open ROM file '%s'", filename);
+        return M64ERR_FILES;
+    }
+
+    if (size < 4096 || size > CART_ROM_MAX_SIZE || !is_valid_rom(romimage))
+    {
+        DebugMessage(M64MSG_ERROR, "open_rom_file(): not a valid ROM image");
+        osal_file_unmap(romimage, size);
+        return M64ERR_INPUT_INVALID;
+    }
+
+    rom_cache_verify_wait();
+    rom_unmap_file();
+    imagetype = rom_image_type(romimage);
+    g_rom_size = (int)size;
+
+    /* Images which already have the byte order of the cart ROM region are
+     * mapped there without any copy. Pages are copy-on-write and only
+     * loaded from the file when first accessed. */
+#if defined(M64P_BIG_ENDIAN)
+    if (imagetype == Z64IMAGE && osal_file_map_at(filename, rom, size) == 0)
+#else
+    if (imagetype == N64IMAGE && osal_file_map_at(filename, rom, size) == 0)
+#endif
+    {
+        l_rom_mapped_size = size;
+        DebugMessage(M64MSG_VERBOSE, "ROM file mapped in the cart ROM region");
+    }
+    else
+    {
+        swap_copy_rom_words(rom, romimage, size, imagetype);
+    }
+#if !defined(M64P_BIG_ENDIAN)
+    g_RomWordsLittleEndian = 1;
+#endif
+
+    ret = identify_rom(filename, romimage, imagetype);
+    osal_file_unmap(romimage, size);
+
+    if (ret != M64ERR_SUCCESS)
+        rom_unmap_file();
+    return ret;
+}
+
 m64p_error close_rom(void)
 {
+    rom_cache_verify_wait();
+    rom_unmap_file();
+
     /* Clear Byte-swapped flag, since ROM is now deleted. */
     g_RomWordsLittleEndian = 0;
     DebugMessage(M64MSG_STATUS, "Rom closed.");
@@ -258,9 +453,24 @@ m64p_error close_rom(void)
     return M64ERR_SUCCESS;
 }
 
+/* Digest and release of a disk image checked in the background */
+static void disk_md5(unsigned char* digest, void* opaque)
+{
+    struct file_storage* fstorage = (struct file_storage*)opaque;
+
+    rom_md5(digest, fstorage->data, fstorage->size, Z64IMAGE);
+}
+
+static void disk_release(void* opaque)
+{
+    struct file_storage* fstorage = (struct file_storage*)opaque;
+
+    close_file_storage(fstorage);
+    free(fstorage);
+}
+
 m64p_error open_disk(void)
 {
-    md5_state_t state;
     md5_byte_t digest[16];
     romdatabase_entry* entry;
     char buffer[256];
@@ -307,10 +517,8 @@ m64p_error open_disk(void)
         fstorage->data = new_data;
     }
 
-    /* Calculate MD5 hash  */
-    md5_init(&state);
-    md5_append(&state, (const md5_byte_t*)(fstorage->data), fstorage->size);
-    md5_finish(&state, digest);
+    /* Calculate MD5 hash, the disk image is released once it is done */
+    image_md5(digest, dd_disk_filename, fstorage->data, fstorage->size, Z64IMAGE, disk_md5, disk_release, fstorage);
     for ( i = 0; i < 16; ++i )
         sprintf(buffer+i*2, "%02X", digest[i]);
     buffer[32] = '\0';
@@ -360,8 +568,6 @@ m64p_error open_disk(void)
     memset(ROM_PARAMS.headername, 0, 20);
     g_rom_size = 0;
 
-    close_file_storage(fstorage);
-    free(fstorage);
     return M64ERR_SUCCESS;
 
 wrong_disk_format:
@@ -454,7 +660,7 @@ static size_t romdatabase_resolve_round(void)
         if (!entry->entry.refmd5)
             continue;
 
-        ref = ini_search_by_md5(entry->entry.refmd5);
+        ref = list_search_by_md5(entry->entry.refmd5);
         if (!ref) {
             DebugMessage(M64MSG_WARNING, "ROM Database: Error solving RefMD5s");
             continue;
@@ -585,13 +791,21 @@ void romdatabase_open(void)
     romdatabase_search* search = NULL;
     romdatabase_search** next_search;
 
-    int counter, value, lineno;
+    int value, lineno;
     unsigned char index;
     const char *pathname = ConfigGetSharedDataFilepath("mupen64plus.ini");
 
     if(g_romdatabase.have_database)
         return;
 
+    /* Use the binary index if the database didn't change since it was built */
+    if (pathname != NULL && rom_index_open(pathname))
+    {
+        DebugMessage(M64MSG_VERBOSE, "ROM database index loaded");
+        g_romdatabase.have_database = 1;
+        return;
+    }
+
     /* Open romdatabase. */
     if (pathname == NULL || (fPtr = osal_file_open(pathname, "rb")) == NULL)
     {
@@ -602,10 +816,8 @@ void romdatabase_open(void)
     g_romdatabase.have_database = 1;
 
     /* Clear premade indices. */
-    for(counter = 0; counter < 255; ++counter)
-        g_romdatabase.crc_lists[counter] = NULL;
-    for(counter = 0; counter < 255; ++counter)
-        g_romdatabase.md5_lists[counter] = NULL;
+    memset(g_romdatabase.crc_lists, 0, sizeof(g_romdatabase.crc_lists));
+    memset(g_romdatabase.md5_lists, 0, sizeof(g_romdatabase.md5_lists));
     g_romdatabase.list = NULL;
 
     next_search = &g_romdatabase.list;
@@ -867,6 +1079,13 @@ void romdatabase_open(void)
 
     fclose(fPtr);
     romdatabase_resolve();
+
+    /* the lists are only kept if the index can't be built */
+    if (rom_index_build(pathname, &g_romdatabase))
+    {
+        DebugMessage(M64MSG_VERBOSE, "ROM database index built");
+        romdatabase_free_lists();
+    }
 }
 
 void romdatabase_close(void)
@@ -874,6 +1093,14 @@ void romdatabase_close(void)
     if (!g_romdatabase.have_database)
         return;
 
+    romdatabase_free_lists();
+    rom_index_close();
+
+    g_romdatabase.have_database = 0;
+}
+
+static void romdatabase_free_lists(void)
+{
     while (g_romdatabase.list != NULL)
         {
         romdatabase_search* search = g_romdatabase.list->next_entry;
@@ -886,16 +1113,27 @@ void romdatabase_close(void)
         g_romdatabase.list = search;
         }
 
-    g_romdatabase.have_database = 0;
+    memset(g_romdatabase.crc_lists, 0, sizeof(g_romdatabase.crc_lists));
+    memset(g_romdatabase.md5_lists, 0, sizeof(g_romdatabase.md5_lists));
 }
 
 static romdatabase_entry* ini_search_by_md5(md5_byte_t* md5)
 {
-    romdatabase_search* search;
+    static romdatabase_entry found_entry;
 
     if(!g_romdatabase.have_database)
         return NULL;
 
+    if (rom_index_find_md5(md5, &found_entry))
+        return &found_entry;
+
+    return list_search_by_md5(md5);
+}
+
+static romdatabase_entry* list_search_by_md5(md5_byte_t* md5)
+{
+    romdatabase_search* search;
+
     search = g_romdatabase.md5_lists[md5[0]];
 
     while (search != NULL && memcmp(search->entry.md5, md5, 16) != 0)
@@ -909,12 +1147,16 @@ static romdatabase_entry* ini_search_by_md5(md5_byte_t* md5)
 
 romdatabase_entry* ini_search_by_crc(unsigned int crc1, unsigned int crc2)
 {
+    static romdatabase_entry index_entry;
     romdatabase_search* search;
     romdatabase_entry* found_entry = NULL;
 
     if(!g_romdatabase.have_database) 
         return NULL;
 
+    if (rom_index_find_crc(crc1, crc2, &index_entry))
+        return &index_entry;
+
     search = g_romdatabase.crc_lists[((crc1 >> 24) & 0xff)];
 
     // because CRCs can be ambiguous (there can be multiple database entries with the same CRC),
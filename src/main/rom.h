@@ -39,6 +39,7 @@
 /* ROM Loading and Saving functions */
 
 m64p_error open_rom(const unsigned char* romimage, unsigned int size);
+m64p_error open_rom_file(const char* filename);
 m64p_error close_rom(void);
 
 m64p_error open_disk(void);
@@ -0,0 +1,326 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rom_cache.c                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "rom_cache.h"
+
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define M64P_CORE_PROTOTYPES 1
+#include "api/callbacks.h"
+#include "api/m64p_config.h"
+#include "api/m64p_types.h"
+#include "osal/files.h"
+#include "util.h"
+
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+#define ROM_CACHE_FILENAME "romcache.bin"
+#define ROM_CACHE_VERSION 1
+#define ROM_CACHE_MAX_ENTRIES 4096
+
+/* bytes hashed at the start, at each sample and at the end of a file */
+#define ROM_CACHE_SAMPLE_SIZE 4096
+#define ROM_CACHE_SAMPLE_COUNT 64
+
+static const char l_magic[8] = { 'M', '6', '4', '+', 'R', 'I', 'D', 'C' };
+
+/* stored as is in the cache file, which is only read on the same host */
+struct rom_cache_entry
+{
+    struct rom_identity id;
+    unsigned char md5[16];
+};
+
+struct rom_cache_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+};
+
+static struct
+{
+    int loaded;
+    struct rom_cache_entry* entries;
+    size_t count;
+} l_cache;
+
+static struct
+{
+    SDL_Thread* thread;
+    struct rom_identity id;
+    unsigned char expected[16];
+    unsigned char actual[16];
+    rom_cache_digest_fn digest;
+    rom_cache_release_fn release;
+    void* opaque;
+} l_verify;
+
+static char* rom_cache_path(void)
+{
+    const char* dir = ConfigGetUserCachePath();
+
+    return (dir == NULL) ? NULL : combinepath(dir, ROM_CACHE_FILENAME);
+}
+
+static void rom_cache_load(void)
+{
+    struct rom_cache_header header;
+    char* path;
+    FILE* f;
+
+    if (l_cache.loaded)
+        return;
+    l_cache.loaded = 1;
+
+    path = rom_cache_path();
+    if (path == NULL)
+        return;
+
+    f = osal_file_open(path, "rb");
+    free(path);
+    if (f == NULL)
+        return;
+
+    if (fread(&header, sizeof(header), 1, f) == 1
+     && memcmp(header.magic, l_magic, sizeof(l_magic)) == 0
+     && header.version == ROM_CACHE_VERSION
+     && header.count <= ROM_CACHE_MAX_ENTRIES)
+    {
+        l_cache.entries = malloc(header.count * sizeof(*l_cache.entries));
+        if (l_cache.entries != NULL
+         && fread(l_cache.entries, sizeof(*l_cache.entries), header.count, f) == header.count)
+        {
+            l_cache.count = header.count;
+        }
+    }
+    else
+    {
+        DebugMessage(M64MSG_VERBOSE, "Ignoring invalid ROM identity cache");
+    }
+    fclose(f);
+}
+
+static void rom_cache_save(void)
+{
+    struct rom_cache_header header;
+    char* path;
+    FILE* f;
+
+    path = rom_cache_path();
+    if (path == NULL)
+        return;
+
+    f = osal_file_open(path, "wb");
+    if (f == NULL)
+    {
+        DebugMessage(M64MSG_WARNING, "Couldn't write ROM identity cache %s", path);
+        free(path);
+        return;
+    }
+
+    memcpy(header.magic, l_magic, sizeof(l_magic));
+    header.version = ROM_CACHE_VERSION;
+    header.count = (uint32_t)l_cache.count;
+
+    if (fwrite(&header, sizeof(header), 1, f) != 1
+     || fwrite(l_cache.entries, sizeof(*l_cache.entries), l_cache.count, f) != l_cache.count)
+    {
+        DebugMessage(M64MSG_WARNING, "Couldn't write ROM identity cache %s", path);
+    }
+    fclose(f);
+    free(path);
+}
+
+/* A file is matched by its name, the content of a buffer by its hash */
+static int rom_cache_same_image(const struct rom_identity* a, const struct rom_identity* b)
+{
+    if (a->path_hash != 0 || b->path_hash != 0)
+        return a->path_hash == b->path_hash;
+
+    return a->size == b->size
+        && a->content_hash[0] == b->content_hash[0]
+        && a->content_hash[1] == b->content_hash[1];
+}
+
+void rom_cache_identify(struct rom_identity* id, const char* filename, const unsigned char* image, size_t size)
+{
+    XXH128_hash_t hash;
+
+    memset(id, 0, sizeof(*id));
+    id->size = size;
+
+    if (filename == NULL
+     || osal_file_identity(filename, &id->size, &id->mtime, &id->fileid) != 0
+     || id->size != size)
+    {
+        /* without a file to tell changes, hash the whole image */
+        id->size = size;
+        id->mtime = 0;
+        id->fileid = 0;
+        hash = XXH3_128bits(image, size);
+    }
+    else
+    {
+        XXH3_state_t state;
+        size_t i, offset, n;
+
+        id->path_hash = XXH3_64bits(filename, strlen(filename));
+        if (id->path_hash == 0)
+            id->path_hash = 1;
+
+        XXH3_128bits_reset(&state);
+        for (i = 0; i <= ROM_CACHE_SAMPLE_COUNT; ++i)
+        {
+            offset = (i == ROM_CACHE_SAMPLE_COUNT)
+                ? ((size > ROM_CACHE_SAMPLE_SIZE) ? size - ROM_CACHE_SAMPLE_SIZE : 0)
+                : (size / ROM_CACHE_SAMPLE_COUNT * i) & ~(size_t)(ROM_CACHE_SAMPLE_SIZE - 1);
+            n = (size - offset < ROM_CACHE_SAMPLE_SIZE) ? size - offset : ROM_CACHE_SAMPLE_SIZE;
+            XXH3_128bits_update(&state, image + offset, n);
+        }
+        hash = XXH3_128bits_digest(&state);
+    }
+
+    id->content_hash[0] = hash.low64;
+    id->content_hash[1] = hash.high64;
+}
+
+int rom_cache_lookup(const struct rom_identity* id, unsigned char md5[16])
+{
+    size_t i;
+
+    rom_cache_load();
+
+    for (i = 0; i < l_cache.count; ++i)
+    {
+        if (memcmp(&l_cache.entries[i].id, id, sizeof(*id)) == 0)
+        {
+            memcpy(md5, l_cache.entries[i].md5, 16);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void rom_cache_store(const struct rom_identity* id, const unsigned char md5[16])
+{
+    struct rom_cache_entry* entry = NULL;
+    size_t i;
+
+    rom_cache_load();
+
+    for (i = 0; i < l_cache.count; ++i)
+    {
+        if (rom_cache_same_image(&l_cache.entries[i].id, id))
+        {
+            entry = &l_cache.entries[i];
+            break;
+        }
+    }
+
+    if (entry == NULL)
+    {
+        if (l_cache.count == ROM_CACHE_MAX_ENTRIES)
+        {
+            /* forget the oldest image */
+            memmove(l_cache.entries, l_cache.entries + 1, (l_cache.count - 1) * sizeof(*l_cache.entries));
+            --l_cache.count;
+        }
+        else
+        {
+            entry = realloc(l_cache.entries, (l_cache.count + 1) * sizeof(*l_cache.entries));
+            if (entry == NULL)
+                return;
+            l_cache.entries = entry;
+        }
+        entry = &l_cache.entries[l_cache.count++];
+    }
+
+    entry->id = *id;
+    memcpy(entry->md5, md5, 16);
+    rom_cache_save();
+}
+
+static int rom_cache_verify_thread(void* data)
+{
+    (void)data;
+
+    l_verify.digest(l_verify.actual, l_verify.opaque);
+    if (l_verify.release != NULL)
+        l_verify.release(l_verify.opaque);
+
+    if (memcmp(l_verify.actual, l_verify.expected, 16) != 0)
+        DebugMessage(M64MSG_WARNING, "ROM identity cache was stale, ROM settings may be wrong until the next start");
+    else
+        DebugMessage(M64MSG_VERBOSE, "ROM identity cache verified");
+
+    return 0;
+}
+
+void rom_cache_verify(const struct rom_identity* id, const unsigned char md5[16],
+                      rom_cache_digest_fn digest, rom_cache_release_fn release, void* opaque)
+{
+    rom_cache_verify_wait();
+
+    l_verify.id = *id;
+    memcpy(l_verify.expected, md5, 16);
+    l_verify.digest = digest;
+    l_verify.release = release;
+    l_verify.opaque = opaque;
+
+    l_verify.thread = SDL_CreateThread(rom_cache_verify_thread, "ROMVerify", NULL);
+    if (l_verify.thread == NULL)
+    {
+        /* verify now rather than never */
+        rom_cache_verify_thread(NULL);
+        l_verify.thread = NULL;
+        if (memcmp(l_verify.actual, l_verify.expected, 16) != 0)
+            rom_cache_store(&l_verify.id, l_verify.actual);
+    }
+}
+
+void rom_cache_verify_wait(void)
+{
+    if (l_verify.thread == NULL)
+        return;
+
+    SDL_WaitThread(l_verify.thread, NULL);
+    l_verify.thread = NULL;
+
+    if (memcmp(l_verify.actual, l_verify.expected, 16) != 0)
+        rom_cache_store(&l_verify.id, l_verify.actual);
+}
+
+void rom_cache_close(void)
+{
+    rom_cache_verify_wait();
+
+    free(l_cache.entries);
+    l_cache.entries = NULL;
+    l_cache.count = 0;
+    l_cache.loaded = 0;
+}
@@ -0,0 +1,75 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rom_cache.h                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_ROM_CACHE_H
+#define M64P_MAIN_ROM_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Persistent cache of the MD5 of ROM and disk images.
+ *
+ * Hashing a 64MB image with MD5 is a large part of opening it, so the
+ * digest is remembered in the user cache directory. Images opened from a
+ * file are keyed by path, size, modification time, file identifier and an
+ * XXH3 of the header and of sparse samples; images passed in a buffer are
+ * keyed by their size and an XXH3 of their whole content, which is still
+ * far cheaper than MD5. The ROM database entry is looked up from the
+ * cached MD5 as before, so that edits of the .ini file are seen.
+ *
+ * A cached digest can be checked by a background thread while the game
+ * runs; a stale entry is reported and corrected for the next run.
+ */
+
+struct rom_identity
+{
+    uint64_t path_hash;         /* 0 if the image isn't read from a file */
+    uint64_t size;
+    int64_t mtime;
+    uint64_t fileid;
+    uint64_t content_hash[2];
+};
+
+/* Compute the identity of an image. filename may be NULL. */
+void rom_cache_identify(struct rom_identity* id, const char* filename, const unsigned char* image, size_t size);
+
+/* Returns 1 and fills md5 if the identity is in the cache, 0 otherwise. */
+int rom_cache_lookup(const struct rom_identity* id, unsigned char md5[16]);
+
+/* Add or replace the digest of an identity and write the cache file. */
+void rom_cache_store(const struct rom_identity* id, const unsigned char md5[16]);
+
+/* Recompute the digest of a cached identity in the background.
+ * digest is called from the verification thread with opaque, then release
+ * (if not NULL). The image must stay valid until rom_cache_verify_wait. */
+typedef void (*rom_cache_digest_fn)(unsigned char md5[16], void* opaque);
+typedef void (*rom_cache_release_fn)(void* opaque);
+
+void rom_cache_verify(const struct rom_identity* id, const unsigned char md5[16],
+                      rom_cache_digest_fn digest, rom_cache_release_fn release, void* opaque);
+
+/* Wait for a pending verification and correct the cache if needed. */
+void rom_cache_verify_wait(void);
+
+/* Wait for verification and free the cache. */
+void rom_cache_close(void);
+
+#endif /* M64P_MAIN_ROM_CACHE_H */
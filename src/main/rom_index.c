@@ -0,0 +1,514 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rom_index.c                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "rom_index.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32)
+#include <process.h>
+#define getpid _getpid
+#endif
+
+#define M64P_CORE_PROTOTYPES 1
+#include "api/callbacks.h"
+#include "api/m64p_config.h"
+#include "api/m64p_types.h"
+#include "osal/files.h"
+#include "util.h"
+
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+#define ROM_INDEX_FILENAME "romdatabase.idx"
+#define ROM_INDEX_VERSION 1
+
+#define ROM_INDEX_NO_STRING UINT32_C(0xffffffff)
+/* set in a CRC slot when several records have this CRC pair */
+#define ROM_INDEX_AMBIGUOUS UINT32_C(0x80000000)
+
+static const char l_magic[8] = { 'M', '6', '4', '+', 'R', 'D', 'B', 'X' };
+
+/* The file is only read on the host which wrote it, so everything is in
+ * host byte order. It is made of the header, the records, the MD5 slots,
+ * the CRC slots and the string pool. A slot holds a record number plus one,
+ * 0 if empty. */
+struct rom_index_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t record_count;
+    uint64_t ini_path_hash;
+    uint64_t ini_size;
+    int64_t ini_mtime;
+    uint64_t ini_fileid;
+    uint32_t md5_slots;     /* power of two */
+    uint32_t crc_slots;     /* power of two */
+    uint32_t strings_size;
+    uint32_t reserved;
+};
+
+struct rom_index_record
+{
+    md5_byte_t md5[16];
+    uint32_t crc1;
+    uint32_t crc2;
+    uint32_t goodname;      /* offsets in the string pool */
+    uint32_t cheats;
+    uint32_t sidmaduration;
+    uint32_t aidmamodifier;
+    uint32_t set_flags;
+    unsigned char status;
+    unsigned char savetype;
+    unsigned char players;
+    unsigned char rumble;
+    unsigned char countperop;
+    unsigned char disableextramem;
+    unsigned char transferpak;
+    unsigned char mempak;
+    unsigned char biopak;
+    unsigned char padding[3];
+};
+
+static struct
+{
+    unsigned char* data;
+    size_t size;
+    int mapped;
+    const struct rom_index_header* header;
+    const struct rom_index_record* records;
+    const uint32_t* md5_slots;
+    const uint32_t* crc_slots;
+    const char* strings;
+} l_index;
+
+struct ini_identity
+{
+    uint64_t path_hash;
+    uint64_t size;
+    int64_t mtime;
+    uint64_t fileid;
+};
+
+static int get_ini_identity(const char* ini_path, struct ini_identity* id)
+{
+    id->path_hash = XXH3_64bits(ini_path, strlen(ini_path));
+    return osal_file_identity(ini_path, &id->size, &id->mtime, &id->fileid) == 0;
+}
+
+static char* rom_index_path(void)
+{
+    const char* dir = ConfigGetUserCachePath();
+
+    return (dir == NULL) ? NULL : combinepath(dir, ROM_INDEX_FILENAME);
+}
+
+static uint32_t md5_hash(const md5_byte_t* md5)
+{
+    uint32_t h;
+
+    /* MD5 bits are already uniformly distributed */
+    memcpy(&h, md5, sizeof(h));
+    return h;
+}
+
+static uint32_t crc_hash(uint32_t crc1, uint32_t crc2)
+{
+    return (crc1 * UINT32_C(0x9e3779b1)) ^ crc2;
+}
+
+static uint32_t slot_count(uint32_t records)
+{
+    uint32_t n = 16;
+
+    /* keep the load factor under one half */
+    while (n < 2 * records)
+        n *= 2;
+    return n;
+}
+
+static size_t rom_index_size(uint32_t records, uint32_t md5_slots, uint32_t crc_slots, uint32_t strings_size)
+{
+    return sizeof(struct rom_index_header)
+         + records * sizeof(struct rom_index_record)
+         + (md5_slots + crc_slots) * sizeof(uint32_t)
+         + strings_size;
+}
+
+/* Point the tables at an index, returns 0 if it is malformed */
+static int rom_index_use(unsigned char* data, size_t size, int mapped)
+{
+    const struct rom_index_header* header = (const struct rom_index_header*)data;
+
+    if (size < sizeof(*header)
+     || memcmp(header->magic, l_magic, sizeof(l_magic)) != 0
+     || header->version != ROM_INDEX_VERSION
+     || header->record_count >= ROM_INDEX_AMBIGUOUS
+     || (header->md5_slots & (header->md5_slots - 1)) != 0 || header->md5_slots <= header->record_count
+     || (header->crc_slots & (header->crc_slots - 1)) != 0 || header->crc_slots <= header->record_count
+     || header->strings_size == 0
+     || size != rom_index_size(header->record_count, header->md5_slots, header->crc_slots, header->strings_size))
+    {
+        return 0;
+    }
+
+    l_index.data = data;
+    l_index.size = size;
+    l_index.mapped = mapped;
+    l_index.header = header;
+    l_index.records = (const struct rom_index_record*)(header + 1);
+    l_index.md5_slots = (const uint32_t*)(l_index.records + header->record_count);
+    l_index.crc_slots = l_index.md5_slots + header->md5_slots;
+    l_index.strings = (const char*)(l_index.crc_slots + header->crc_slots);
+
+    /* the pool ends with a terminator so that no string overruns it */
+    if (l_index.strings[header->strings_size - 1] != '\0')
+    {
+        memset(&l_index, 0, sizeof(l_index));
+        return 0;
+    }
+
+    return 1;
+}
+
+int rom_index_open(const char* ini_path)
+{
+    const struct rom_index_header* header;
+    struct ini_identity id;
+    unsigned char* data;
+    size_t size = 0;
+    char* path;
+
+    if (!get_ini_identity(ini_path, &id) || (path = rom_index_path()) == NULL)
+        return 0;
+
+    data = (unsigned char*)osal_file_map(path, &size);
+    free(path);
+    if (data == NULL)
+        return 0;
+
+    header = (const struct rom_index_header*)data;
+    if (size < sizeof(*header)
+     || header->ini_path_hash != id.path_hash
+     || header->ini_size != id.size
+     || header->ini_mtime != id.mtime
+     || header->ini_fileid != id.fileid
+     || !rom_index_use(data, size, 1))
+    {
+        DebugMessage(M64MSG_VERBOSE, "ROM database index is out of date");
+        osal_file_unmap(data, size);
+        return 0;
+    }
+
+    return 1;
+}
+
+/* record number of a database node, to find it from the CRC lists */
+struct node_record
+{
+    const romdatabase_search* node;
+    uint32_t record;
+};
+
+static int compare_nodes(const void* a, const void* b)
+{
+    uintptr_t na = (uintptr_t)((const struct node_record*)a)->node;
+    uintptr_t nb = (uintptr_t)((const struct node_record*)b)->node;
+
+    return (na > nb) - (na < nb);
+}
+
+static uint32_t add_string(char* strings, uint32_t* strings_size, const char* s)
+{
+    uint32_t offset = *strings_size;
+    size_t len;
+
+    if (s == NULL)
+        return ROM_INDEX_NO_STRING;
+
+    len = strlen(s) + 1;
+    memcpy(strings + offset, s, len);
+    *strings_size += (uint32_t)len;
+    return offset;
+}
+
+static void write_index(const unsigned char* data, size_t size)
+{
+    char* path = rom_index_path();
+    char* tmp_path;
+    FILE* f;
+    int ok;
+
+    if (path == NULL)
+        return;
+
+    /* replace the file at once, other processes may have it mapped */
+    tmp_path = formatstr("%s.%u.tmp", path, (unsigned int)getpid());
+    if (tmp_path == NULL)
+    {
+        free(path);
+        return;
+    }
+
+    f = osal_file_open(tmp_path, "wb");
+    ok = (f != NULL);
+    if (f != NULL)
+    {
+        ok = (fwrite(data, 1, size, f) == size);
+        ok = (fclose(f) == 0) && ok;
+    }
+
+#if defined(WIN32)
+    /* rename doesn't replace an existing file on Windows */
+    if (ok)
+        remove(path);
+#endif
+    if (!ok || rename(tmp_path, path) != 0)
+    {
+        DebugMessage(M64MSG_WARNING, "Couldn't write ROM database index %s", path);
+        remove(tmp_path);
+    }
+
+    free(tmp_path);
+    free(path);
+}
+
+int rom_index_build(const char* ini_path, const _romdatabase* db)
+{
+    const romdatabase_search* search;
+    struct node_record* nodes;
+    struct rom_index_header* header;
+    struct rom_index_record* records;
+    struct ini_identity id;
+    uint32_t *md5_slots, *crc_slots;
+    uint32_t count = 0, strings_size = 1, i, h, mask;
+    unsigned char* data;
+    char* strings;
+    size_t size;
+
+    rom_index_close();
+
+    for (search = db->list; search != NULL; search = search->next_entry)
+    {
+        ++count;
+        if (search->entry.goodname != NULL)
+            strings_size += (uint32_t)strlen(search->entry.goodname) + 1;
+        if (search->entry.cheats != NULL)
+            strings_size += (uint32_t)strlen(search->entry.cheats) + 1;
+    }
+
+    size = rom_index_size(count, slot_count(count), slot_count(count), strings_size);
+    data = (unsigned char*)calloc(1, size);
+    nodes = (struct node_record*)malloc((count + 1) * sizeof(*nodes));
+    if (data == NULL || nodes == NULL)
+    {
+        free(data);
+        free(nodes);
+        return 0;
+    }
+
+    header = (struct rom_index_header*)data;
+    memcpy(header->magic, l_magic, sizeof(l_magic));
+    header->version = ROM_INDEX_VERSION;
+    header->record_count = count;
+    header->md5_slots = slot_count(count);
+    header->crc_slots = slot_count(count);
+    header->strings_size = strings_size;
+
+    records = (struct rom_index_record*)(header + 1);
+    md5_slots = (uint32_t*)(records + count);
+    crc_slots = md5_slots + header->md5_slots;
+    strings = (char*)(crc_slots + header->crc_slots);
+
+    /* an empty string at offset 0 keeps the pool non empty */
+    strings_size = 1;
+
+    /* records in file order, a repeated MD5 refers to the last one */
+    mask = header->md5_slots - 1;
+    for (i = 0, search = db->list; search != NULL; ++i, search = search->next_entry)
+    {
+        const romdatabase_entry* entry = &search->entry;
+        struct rom_index_record* record = &records[i];
+
+        memcpy(record->md5, entry->md5, 16);
+        record->crc1 = entry->crc1;
+        record->crc2 = entry->crc2;
+        record->goodname = add_string(strings, &strings_size, entry->goodname);
+        record->cheats = add_string(strings, &strings_size, entry->cheats);
+        record->sidmaduration = entry->sidmaduration;
+        record->aidmamodifier = entry->aidmamodifier;
+        record->set_flags = entry->set_flags;
+        record->status = entry->status;
+        record->savetype = entry->savetype;
+        record->players = entry->players;
+        record->rumble = entry->rumble;
+        record->countperop = entry->countperop;
+        record->disableextramem = entry->disableextramem;
+        record->transferpak = entry->transferpak;
+        record->mempak = entry->mempak;
+        record->biopak = entry->biopak;
+
+        for (h = md5_hash(entry->md5) & mask; md5_slots[h] != 0; h = (h + 1) & mask)
+        {
+            if (memcmp(records[md5_slots[h] - 1].md5, entry->md5, 16) == 0)
+                break;
+        }
+        md5_slots[h] = i + 1;
+
+        nodes[i].node = search;
+        nodes[i].record = i;
+    }
+
+    /* Only the entries with a CRC of their own are in the CRC lists, not
+     * those which got it through a RefMD5 */
+    qsort(nodes, count, sizeof(*nodes), compare_nodes);
+    mask = header->crc_slots - 1;
+    for (i = 0; i < 256; ++i)
+    {
+        for (search = db->crc_lists[i]; search != NULL; search = search->next_crc)
+        {
+            struct node_record key, *found;
+
+            key.node = search;
+            found = (struct node_record*)bsearch(&key, nodes, count, sizeof(*nodes), compare_nodes);
+            if (found == NULL)
+                continue;
+
+            for (h = crc_hash(search->entry.crc1, search->entry.crc2) & mask; crc_slots[h] != 0; h = (h + 1) & mask)
+            {
+                const struct rom_index_record* record = &records[(crc_slots[h] & ~ROM_INDEX_AMBIGUOUS) - 1];
+                if (record->crc1 == search->entry.crc1 && record->crc2 == search->entry.crc2)
+                    break;
+            }
+            crc_slots[h] = (crc_slots[h] != 0)
+                ? (crc_slots[h] | ROM_INDEX_AMBIGUOUS)
+                : (found->record + 1);
+        }
+    }
+    free(nodes);
+
+    /* the index is usable even if it can't be written */
+    if (get_ini_identity(ini_path, &id))
+    {
+        header->ini_path_hash = id.path_hash;
+        header->ini_size = id.size;
+        header->ini_mtime = id.mtime;
+        header->ini_fileid = id.fileid;
+        write_index(data, size);
+    }
+
+    if (!rom_index_use(data, size, 0))
+    {
+        free(data);
+        return 0;
+    }
+
+    return 1;
+}
+
+void rom_index_close(void)
+{
+    if (l_index.data == NULL)
+        return;
+
+    if (l_index.mapped)
+        osal_file_unmap(l_index.data, l_index.size);
+    else
+        free(l_index.data);
+
+    memset(&l_index, 0, sizeof(l_index));
+}
+
+static void fill_entry(const struct rom_index_record* record, romdatabase_entry* entry)
+{
+    const uint32_t strings_size = l_index.header->strings_size;
+
+    memset(entry, 0, sizeof(*entry));
+    memcpy(entry->md5, record->md5, 16);
+    entry->refmd5 = NULL;
+    entry->goodname = (record->goodname < strings_size) ? (char*)l_index.strings + record->goodname : NULL;
+    entry->cheats = (record->cheats < strings_size) ? (char*)l_index.strings + record->cheats : NULL;
+    entry->crc1 = record->crc1;
+    entry->crc2 = record->crc2;
+    entry->status = record->status;
+    entry->savetype = record->savetype;
+    entry->players = record->players;
+    entry->rumble = record->rumble;
+    entry->countperop = record->countperop;
+    entry->disableextramem = record->disableextramem;
+    entry->transferpak = record->transferpak;
+    entry->mempak = record->mempak;
+    entry->biopak = record->biopak;
+    entry->sidmaduration = record->sidmaduration;
+    entry->aidmamodifier = record->aidmamodifier;
+    entry->set_flags = record->set_flags;
+}
+
+int rom_index_find_md5(const md5_byte_t* md5, romdatabase_entry* entry)
+{
+    uint32_t mask, h, n, slot;
+
+    if (l_index.data == NULL)
+        return 0;
+
+    mask = l_index.header->md5_slots - 1;
+    for (h = md5_hash(md5) & mask, n = 0; n <= mask && (slot = l_index.md5_slots[h]) != 0; h = (h + 1) & mask, ++n)
+    {
+        if (slot <= l_index.header->record_count
+         && memcmp(l_index.records[slot - 1].md5, md5, 16) == 0)
+        {
+            fill_entry(&l_index.records[slot - 1], entry);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int rom_index_find_crc(unsigned int crc1, unsigned int crc2, romdatabase_entry* entry)
+{
+    uint32_t mask, h, n, slot, record;
+
+    if (l_index.data == NULL)
+        return 0;
+
+    mask = l_index.header->crc_slots - 1;
+    for (h = crc_hash(crc1, crc2) & mask, n = 0; n <= mask && (slot = l_index.crc_slots[h]) != 0; h = (h + 1) & mask, ++n)
+    {
+        record = (slot & ~ROM_INDEX_AMBIGUOUS) - 1;
+        if (record < l_index.header->record_count
+         && l_index.records[record].crc1 == crc1
+         && l_index.records[record].crc2 == crc2)
+        {
+            /* CRCs can be ambiguous, MD5s are preferred */
+            if (slot & ROM_INDEX_AMBIGUOUS)
+                return 0;
+
+            fill_entry(&l_index.records[record], entry);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rom_index.h                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_ROM_INDEX_H
+#define M64P_MAIN_ROM_INDEX_H
+
+#include "rom.h"
+
+/* Binary index of the ROM database.
+ *
+ * Parsing mupen64plus.ini and resolving its RefMD5 references takes a
+ * noticeable part of the core startup. The resolved database is written
+ * once to an index file in the user cache directory and mapped on the
+ * next starts, as long as the size, modification time and identifier of
+ * the .ini file haven't changed.
+ *
+ * The index holds fixed size records, a string pool for good names and
+ * cheats, and two open addressed hash tables of record numbers, one on the
+ * MD5 and one on the CRC pair. Entries sharing a CRC pair are flagged so
+ * that a CRC search for them finds nothing, as with the .ini lists.
+ */
+
+/* Map the index of the .ini file if it is up to date.
+ * Returns 1 on success, 0 if it needs to be built. */
+int rom_index_open(const char* ini_path);
+
+/* Build the index from the parsed and resolved database, write it to the
+ * cache directory and use it. Returns 1 on success, 0 on failure. */
+int rom_index_build(const char* ini_path, const _romdatabase* db);
+
+void rom_index_close(void);
+
+/* Fill entry and return 1 if found, return 0 otherwise. The strings of
+ * the entry stay valid until rom_index_close. */
+int rom_index_find_md5(const md5_byte_t* md5, romdatabase_entry* entry);
+int rom_index_find_crc(unsigned int crc1, unsigned int crc2, romdatabase_entry* entry);
+
+#endif /* M64P_MAIN_ROM_INDEX_H */
@@ -0,0 +1,139 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rsp_thread.c                                            *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "rsp_thread.h"
+
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "plugin/plugin.h"
+#include "trace.h"
+
+struct rsp_thread {
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *task_avail;
+    SDL_cond *task_done;
+    int task_pending;
+    int quit;
+};
+
+static struct rsp_thread rsp_thread;
+
+static int rsp_thread_handler(void *data)
+{
+    int quit;
+
+    trace_thread_name("rsp");
+
+    for (;;) {
+        SDL_LockMutex(rsp_thread.lock);
+        while (!rsp_thread.task_pending && !rsp_thread.quit)
+            SDL_CondWait(rsp_thread.task_avail, rsp_thread.lock);
+        quit = rsp_thread.quit;
+        SDL_UnlockMutex(rsp_thread.lock);
+
+        if (quit)
+            break;
+
+        trace_begin("rsp_task");
+        rsp.doRspCycles(0xffffffff);
+        trace_end("rsp_task");
+
+        SDL_LockMutex(rsp_thread.lock);
+        rsp_thread.task_pending = 0;
+        SDL_CondSignal(rsp_thread.task_done);
+        SDL_UnlockMutex(rsp_thread.lock);
+    }
+
+    return 0;
+}
+
+int rsp_thread_init(void)
+{
+    memset(&rsp_thread, 0, sizeof(rsp_thread));
+
+    rsp_thread.lock = SDL_CreateMutex();
+    rsp_thread.task_avail = SDL_CreateCond();
+    rsp_thread.task_done = SDL_CreateCond();
+    if (!rsp_thread.lock || !rsp_thread.task_avail || !rsp_thread.task_done) {
+        DebugMessage(M64MSG_ERROR, "Could not create RSP thread synchronization objects");
+        rsp_thread_shutdown();
+        return -1;
+    }
+
+#if SDL_VERSION_ATLEAST(2,0,0)
+    rsp_thread.thread = SDL_CreateThread(rsp_thread_handler, "m64prsp", NULL);
+#else
+    rsp_thread.thread = SDL_CreateThread(rsp_thread_handler, NULL);
+#endif
+    if (!rsp_thread.thread) {
+        DebugMessage(M64MSG_ERROR, "Could not create RSP thread");
+        rsp_thread_shutdown();
+        return -1;
+    }
+
+    return 0;
+}
+
+void rsp_thread_shutdown(void)
+{
+    int status;
+
+    if (rsp_thread.thread) {
+        rsp_thread_wait_task();
+
+        SDL_LockMutex(rsp_thread.lock);
+        rsp_thread.quit = 1;
+        SDL_CondSignal(rsp_thread.task_avail);
+        SDL_UnlockMutex(rsp_thread.lock);
+
+        SDL_WaitThread(rsp_thread.thread, &status);
+    }
+
+    if (rsp_thread.task_done)
+        SDL_DestroyCond(rsp_thread.task_done);
+    if (rsp_thread.task_avail)
+        SDL_DestroyCond(rsp_thread.task_avail);
+    if (rsp_thread.lock)
+        SDL_DestroyMutex(rsp_thread.lock);
+
+    memset(&rsp_thread, 0, sizeof(rsp_thread));
+}
+
+void rsp_thread_start_task(void)
+{
+    SDL_LockMutex(rsp_thread.lock);
+    rsp_thread.task_pending = 1;
+    SDL_CondSignal(rsp_thread.task_avail);
+    SDL_UnlockMutex(rsp_thread.lock);
+}
+
+void rsp_thread_wait_task(void)
+{
+    SDL_LockMutex(rsp_thread.lock);
+    while (rsp_thread.task_pending)
+        SDL_CondWait(rsp_thread.task_done, rsp_thread.lock);
+    SDL_UnlockMutex(rsp_thread.lock);
+}
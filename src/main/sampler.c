@@ -0,0 +1,534 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - sampler.c                                               *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* REG_RIP / REG_EIP */
+#endif
+
+#include "sampler.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "device/device.h"
+#include "device/r4300/cached_interp.h"
+#include "device/r4300/new_dynarec/new_dynarec.h"
+#include "device/r4300/r4300_core.h"
+#include "device/r4300/recomp_types.h"
+#include "main/main.h"
+
+#if defined(__linux__)
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+enum { SAMPLER_CAPACITY = 1 << 18, SAMPLER_MAX_RATE = 10000 };
+enum { SAMPLER_LOG_LINES = 20, SAMPLER_FILE_LINES = 500 };
+
+/* guest address of the samples taken outside of r4300 code */
+#define SAMPLE_IN_CORE UINT32_C(0xffffffff)
+
+struct sample
+{
+    uintptr_t host;
+    uint32_t guest;
+};
+
+struct sample_count
+{
+    uint32_t address;
+    uint32_t function;
+    unsigned int samples;
+};
+
+static struct sample* l_samples;
+static volatile unsigned int l_count;
+static volatile unsigned int l_dropped;
+static int l_running;
+static unsigned int l_rate;
+static timer_t l_timer;
+static struct sigaction l_old_action;
+
+static char l_request_path[4096];
+static volatile int l_request_pending;
+
+static uintptr_t context_pc(const void* context)
+{
+    const ucontext_t* uc = (const ucontext_t*)context;
+#if defined(__x86_64__)
+    return (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+    return (uintptr_t)uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+    return (uintptr_t)uc->uc_mcontext.pc;
+#elif defined(__arm__)
+    return (uintptr_t)uc->uc_mcontext.arm_pc;
+#else
+    (void)uc;
+    return 0;
+#endif
+}
+
+/* only runs on the emulation thread, and only touches preallocated memory */
+static void sampler_signal(int signum, siginfo_t* info, void* context)
+{
+    unsigned int n = l_count;
+
+    if (n >= SAMPLER_CAPACITY) {
+        ++l_dropped;
+        return;
+    }
+
+    l_samples[n].host = context_pc(context);
+    l_samples[n].guest = *r4300_pc(&g_dev.r4300);
+    l_count = n + 1;
+}
+
+static void block_signal(int block)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPROF);
+    pthread_sigmask(block ? SIG_BLOCK : SIG_UNBLOCK, &set, NULL);
+}
+
+m64p_error sampler_start(unsigned int rate)
+{
+    struct sigaction action;
+    struct sigevent event;
+    struct itimerspec period;
+
+    if (l_running)
+        return M64ERR_INVALID_STATE;
+
+    if (rate > SAMPLER_MAX_RATE)
+        rate = SAMPLER_MAX_RATE;
+
+    l_samples = malloc(SAMPLER_CAPACITY * sizeof(*l_samples));
+    if (l_samples == NULL)
+        return M64ERR_NO_MEMORY;
+    l_count = 0;
+    l_dropped = 0;
+    l_request_pending = 0;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = sampler_signal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, &l_old_action) != 0) {
+        free(l_samples);
+        return M64ERR_SYSTEM_FAIL;
+    }
+
+    /* sample the CPU time of this thread only */
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = (pid_t)syscall(SYS_gettid);
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &l_timer) != 0) {
+        DebugMessage(M64MSG_ERROR, "Couldn't create the profiler timer");
+        sigaction(SIGPROF, &l_old_action, NULL);
+        free(l_samples);
+        return M64ERR_SYSTEM_FAIL;
+    }
+
+    period.it_interval.tv_sec = 0;
+    period.it_interval.tv_nsec = 1000000000L / rate;
+    period.it_value = period.it_interval;
+    timer_settime(l_timer, 0, &period, NULL);
+
+    block_signal(0);
+    l_rate = rate;
+    l_running = 1;
+    DebugMessage(M64MSG_INFO, "Sampling profiler started at %u Hz", rate);
+    return M64ERR_SUCCESS;
+}
+
+/* Maps the host address of samples taken in recompiled code to guest
+ * addresses, other samples are attributed to the core. */
+#ifdef NEW_DYNAREC
+static int compare_entries(const void* a, const void* b)
+{
+    uintptr_t ha = ((const struct new_dynarec_entry*)a)->host;
+    uintptr_t hb = ((const struct new_dynarec_entry*)b)->host;
+    return (ha > hb) - (ha < hb);
+}
+
+static void resolve_samples(struct sample* samples, unsigned int count)
+{
+    uintptr_t begin, end;
+    size_t n = new_dynarec_get_entries(NULL, 0, &begin, &end);
+    struct new_dynarec_entry* entries = malloc((n + 1) * sizeof(*entries));
+    unsigned int i;
+
+    if (entries != NULL) {
+        size_t total = new_dynarec_get_entries(entries, n, &begin, &end);
+        n = (total < n) ? total : n;
+        qsort(entries, n, sizeof(*entries), compare_entries);
+    }
+
+    for (i = 0; i < count; ++i) {
+        uintptr_t host = samples[i].host;
+        size_t lo = 0, hi = (entries != NULL) ? n : 0;
+
+        samples[i].guest = SAMPLE_IN_CORE;
+        if (host < begin || host >= end)
+            continue;
+
+        /* last entry point at or before host */
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (entries[mid].host <= host)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo > 0)
+            samples[i].guest = entries[lo - 1].vaddr & ~UINT32_C(3);
+    }
+
+    free(entries);
+}
+#else
+static int compare_blocks(const void* a, const void* b)
+{
+    uintptr_t ca = (uintptr_t)(*(struct precomp_block* const*)a)->code;
+    uintptr_t cb = (uintptr_t)(*(struct precomp_block* const*)b)->code;
+    return (ca > cb) - (ca < cb);
+}
+
+static void resolve_samples(struct sample* samples, unsigned int count)
+{
+    struct precomp_block** blocks = g_dev.r4300.cached_interp.blocks;
+    struct precomp_block** sorted = malloc(0x100000 * sizeof(*sorted));
+    size_t n = 0, b;
+    unsigned int i;
+
+    if (sorted != NULL) {
+        for (b = 0; b < 0x100000; ++b) {
+            if (blocks[b] != NULL && blocks[b]->code != NULL)
+                sorted[n++] = blocks[b];
+        }
+        qsort(sorted, n, sizeof(*sorted), compare_blocks);
+    }
+
+    for (i = 0; i < count; ++i) {
+        uintptr_t host = samples[i].host;
+        size_t lo = 0, hi = n;
+        const struct precomp_block* block;
+        uint32_t offset, k, length;
+
+        samples[i].guest = SAMPLE_IN_CORE;
+
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if ((uintptr_t)sorted[mid]->code <= host)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == 0)
+            continue;
+
+        block = sorted[lo - 1];
+        if (host >= (uintptr_t)block->code + block->code_length)
+            continue;
+
+        /* last instruction starting at or before host */
+        offset = (uint32_t)(host - (uintptr_t)block->code);
+        length = (uint32_t)get_block_length(block);
+        samples[i].guest = block->start;
+        for (k = 0; k < length; ++k) {
+            if (block->block[k].local_addr > offset)
+                break;
+            samples[i].guest = block->block[k].addr;
+        }
+    }
+
+    free(sorted);
+}
+#endif
+
+/* Entry points are the targets of the JAL instructions found in RDRAM, as
+ * offsets in a 256MB segment */
+static int compare_u32(const void* a, const void* b)
+{
+    uint32_t va = *(const uint32_t*)a, vb = *(const uint32_t*)b;
+    return (va > vb) - (va < vb);
+}
+
+static size_t find_functions(uint32_t** targets)
+{
+    const uint32_t* dram = g_dev.rdram.dram;
+    size_t words = g_dev.rdram.dram_size / 4;
+    size_t i, n = 0, u = 0;
+
+    *targets = malloc((words / 4 + 1) * sizeof(**targets));
+    if (*targets == NULL)
+        return 0;
+
+    for (i = 0; i < words && n < words / 4; ++i) {
+        if ((dram[i] >> 26) == 0x03)
+            (*targets)[n++] = (dram[i] & UINT32_C(0x03ffffff)) << 2;
+    }
+
+    qsort(*targets, n, sizeof(**targets), compare_u32);
+    for (i = 0; i < n; ++i) {
+        if (u == 0 || (*targets)[u - 1] != (*targets)[i])
+            (*targets)[u++] = (*targets)[i];
+    }
+
+    return u;
+}
+
+static uint32_t function_of(uint32_t address, const uint32_t* targets, size_t count)
+{
+    uint32_t offset = address & UINT32_C(0x0fffffff);
+    size_t lo = 0, hi = count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (targets[mid] <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return (lo > 0) ? (address & UINT32_C(0xf0000000)) | targets[lo - 1] : address;
+}
+
+static int compare_guest(const void* a, const void* b)
+{
+    uint32_t va = ((const struct sample*)a)->guest, vb = ((const struct sample*)b)->guest;
+    return (va > vb) - (va < vb);
+}
+
+static int compare_function(const void* a, const void* b)
+{
+    uint32_t va = ((const struct sample_count*)a)->function, vb = ((const struct sample_count*)b)->function;
+    return (va > vb) - (va < vb);
+}
+
+static int compare_samples(const void* a, const void* b)
+{
+    unsigned int va = ((const struct sample_count*)a)->samples, vb = ((const struct sample_count*)b)->samples;
+    return (va < vb) - (va > vb);
+}
+
+static void report_line(FILE* file, const char* format, ...)
+{
+    char line[256];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    if (file != NULL)
+        fprintf(file, "%s\n", line);
+    else
+        DebugMessage(M64MSG_INFO, "%s", line);
+}
+
+static void write_report(const char* path, struct sample* samples, unsigned int count, unsigned int dropped)
+{
+    static const char* const emumodes[] = { "pure interpreter", "cached interpreter", "dynarec" };
+    struct sample_count* counts;
+    uint32_t* targets = NULL;
+    size_t ntargets, ncounts = 0, nfunctions = 0, i, lines;
+    unsigned int in_core = 0;
+    FILE* file = NULL;
+    double total = (count > 0) ? (double)count : 1.0;
+
+    if (path != NULL && path[0] != '\0') {
+        file = fopen(path, "w");
+        if (file == NULL)
+            DebugMessage(M64MSG_ERROR, "Couldn't create profile %s, writing it to the log", path);
+    }
+    lines = (file != NULL) ? SAMPLER_FILE_LINES : SAMPLER_LOG_LINES;
+
+    if (g_dev.r4300.emumode == EMUMODE_DYNAREC)
+        resolve_samples(samples, count);
+
+    /* flat profile */
+    qsort(samples, count, sizeof(*samples), compare_guest);
+    counts = malloc((count + 1) * sizeof(*counts));
+    ntargets = find_functions(&targets);
+    for (i = 0; counts != NULL && i < count; ++i) {
+        if (samples[i].guest == SAMPLE_IN_CORE) {
+            ++in_core;
+        }
+        else if (ncounts > 0 && counts[ncounts - 1].address == samples[i].guest) {
+            ++counts[ncounts - 1].samples;
+        }
+        else {
+            counts[ncounts].address = samples[i].guest;
+            counts[ncounts].function = function_of(samples[i].guest, targets, ntargets);
+            counts[ncounts].samples = 1;
+            ++ncounts;
+        }
+    }
+
+    report_line(file, "Guest profile: %u samples at %u Hz, %s, %u dropped", count, l_rate,
+                emumodes[g_dev.r4300.emumode <= EMUMODE_DYNAREC ? g_dev.r4300.emumode : EMUMODE_DYNAREC], dropped);
+    report_line(file, "%u samples (%.2f%%) outside of r4300 code (core, plugins, memory handlers)",
+                in_core, 100.0 * in_core / total);
+
+    if (counts != NULL) {
+        struct sample_count* functions = malloc((ncounts + 1) * sizeof(*functions));
+
+        qsort(counts, ncounts, sizeof(*counts), compare_samples);
+        report_line(file, "");
+        report_line(file, "Flat profile:");
+        report_line(file, "   samples        %%   address  function");
+        for (i = 0; i < ncounts && i < lines; ++i) {
+            report_line(file, "%10u  %6.2f%%  %08x  %08x", counts[i].samples,
+                        100.0 * counts[i].samples / total, counts[i].address, counts[i].function);
+        }
+
+        /* per function profile */
+        if (functions != NULL) {
+            memcpy(functions, counts, ncounts * sizeof(*functions));
+            qsort(functions, ncounts, sizeof(*functions), compare_function);
+            for (i = 0; i < ncounts; ++i) {
+                if (nfunctions > 0 && functions[nfunctions - 1].function == functions[i].function)
+                    functions[nfunctions - 1].samples += functions[i].samples;
+                else
+                    functions[nfunctions++] = functions[i];
+            }
+            qsort(functions, nfunctions, sizeof(*functions), compare_samples);
+
+            report_line(file, "");
+            report_line(file, "Per function profile (entry points are JAL targets found in RDRAM):");
+            report_line(file, "   samples        %%  function");
+            for (i = 0; i < nfunctions && i < lines; ++i) {
+                report_line(file, "%10u  %6.2f%%  %08x", functions[i].samples,
+                            100.0 * functions[i].samples / total, functions[i].function);
+            }
+            free(functions);
+        }
+    }
+
+    free(targets);
+    free(counts);
+
+    if (file != NULL) {
+        fclose(file);
+        DebugMessage(M64MSG_INFO, "Guest profile written to %s", path);
+    }
+}
+
+static void report_and_reset(const char* path)
+{
+    unsigned int count, dropped;
+
+    /* the handler must not write into the samples while they are sorted */
+    block_signal(1);
+    count = l_count;
+    dropped = l_dropped;
+    write_report(path, l_samples, count, dropped);
+    l_count = 0;
+    l_dropped = 0;
+    block_signal(0);
+}
+
+void sampler_stop(const char* path)
+{
+    if (!l_running)
+        return;
+
+    block_signal(1);
+    timer_delete(l_timer);
+    sigaction(SIGPROF, &l_old_action, NULL);
+    l_running = 0;
+
+    write_report(path, l_samples, l_count, l_dropped);
+
+    free(l_samples);
+    l_samples = NULL;
+    l_request_pending = 0;
+    block_signal(0);
+}
+
+m64p_error sampler_request_report(const char* path)
+{
+    if (!l_running)
+        return M64ERR_INVALID_STATE;
+
+    if (path == NULL)
+        path = "";
+    if (strlen(path) >= sizeof(l_request_path))
+        return M64ERR_INPUT_INVALID;
+
+    strcpy(l_request_path, path);
+    l_request_pending = 1;
+    return M64ERR_SUCCESS;
+}
+
+int sampler_request_pending(void)
+{
+    return l_request_pending;
+}
+
+void sampler_run_request(void)
+{
+    l_request_pending = 0;
+    report_and_reset(l_request_path);
+}
+
+#else
+
+m64p_error sampler_start(unsigned int rate)
+{
+    DebugMessage(M64MSG_WARNING, "The sampling profiler is only available on Linux");
+    return M64ERR_UNSUPPORTED;
+}
+
+void sampler_stop(const char* path)
+{
+}
+
+m64p_error sampler_request_report(const char* path)
+{
+    return M64ERR_UNSUPPORTED;
+}
+
+int sampler_request_pending(void)
+{
+    return 0;
+}
+
+void sampler_run_request(void)
+{
+}
+
+#endif
@@ -0,0 +1,52 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - sampler.h                                               *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_SAMPLER_H
+#define M64P_MAIN_SAMPLER_H
+
+#include "api/m64p_types.h"
+
+/* Statistical profiler of the emulation thread.
+ *
+ * A timer running on the CPU time of the emulation thread delivers SIGPROF
+ * rate times per second; the handler records the host program counter and
+ * the r4300 PC kept by the interpreters. When a report is written, samples
+ * taken in recompiled code are mapped back to guest addresses through the
+ * recompiler block tables, and guest addresses are grouped by function,
+ * using the targets of the JAL instructions found in RDRAM as entry points.
+ *
+ * Only available on Linux.
+ */
+
+/* Called on the emulation thread before it starts running r4300 code */
+m64p_error sampler_start(unsigned int rate);
+
+/* Writes the report (to path, or to the log if path is empty) and stops
+ * the profiler, on the emulation thread */
+void sampler_stop(const char* path);
+
+/* Asks for a report of the samples taken since the start or the last
+ * report. It is written by sampler_run_request on the emulation thread. */
+m64p_error sampler_request_report(const char* path);
+int sampler_request_pending(void);
+void sampler_run_request(void);
+
+#endif
@@ -44,11 +44,14 @@
 #include "main/list.h"
 #include "main/main.h"
 #include "osal/files.h"
+#include "osal/timer.h"
 #include "osal/preproc.h"
 #include "osd/osd.h"
 #include "plugin/plugin.h"
 #include "rom.h"
+#include "parallel_gzip.h"
 #include "savestates.h"
+#include "state_container.h"
 #include "util.h"
 #include "workqueue.h"
 
@@ -59,11 +62,97 @@ enum { DD_DISK_ID_OFFSET = 0x43670 };
 
 static const char* savestate_magic = "M64+SAVE";
 static const int savestate_latest_version = 0x00010900;  /* 1.9 */
+
+/* m64p savestate layout (uncompressed): header, device state, event queue,
+ * using_tlb flag and extra state (since 1.2) */
+enum { M64P_HEADER_SIZE = 44 };
+enum { M64P_DATA_SIZE = 16788244 };
+enum { M64P_QUEUE_SIZE = 1024 };
+enum { M64P_EXTRA_SIZE = 4096 };
+enum { M64P_SAVESTATE_SIZE = M64P_HEADER_SIZE + M64P_DATA_SIZE + M64P_QUEUE_SIZE + 4 + M64P_EXTRA_SIZE };
+
+/* device state layout: registers, RDRAM, SP memory, PIF RAM and flashram
+ * leftovers, TLB lookup tables, r4300 state */
+enum { M64P_TLB_LUTS_SIZE = 2 * 0x100000 * 4 };
+enum { M64P_REGS_SIZE = 400 };
+enum { M64P_MID_SIZE = PIF_RAM_SIZE + 4 + 4+8+4+4 };
+enum { M64P_TAIL_SIZE = M64P_DATA_SIZE - M64P_REGS_SIZE - RDRAM_MAX_SIZE - SP_MEM_SIZE - M64P_MID_SIZE - M64P_TLB_LUTS_SIZE };
+
+/* Uncompressed m64p savestate split around its large arrays, so that the
+ * streaming loaders can read those straight into the device.
+ * A NULL array means that it was already read in place. */
+struct m64p_sections
+{
+    unsigned char *regs;
+    unsigned char *rdram;
+    unsigned char *sp_mem;
+    unsigned char *mid;
+    unsigned char *tlb_luts;
+    unsigned char *tail;
+    char *queue;
+    unsigned char *using_tlb_data;
+    unsigned char *data_0001_0200;
+};
+
+/* The m64p savestate container stores the same data as tagged chunks, one
+ * per device where the layout allows it, in m64p layout order. Chunk data
+ * is the m64p serialization of the section (little endian). */
+enum m64p_chunk_section
+{
+    M64P_SECTION_HEADER,
+    M64P_SECTION_REGS,
+    M64P_SECTION_RDRAM,
+    M64P_SECTION_SP_MEM,
+    M64P_SECTION_MID,
+    M64P_SECTION_LUT_R,
+    M64P_SECTION_LUT_W,
+    M64P_SECTION_TAIL,
+    M64P_SECTION_QUEUE,
+    M64P_SECTION_USING_TLB,
+    M64P_SECTION_EXTRA,
+    M64P_SECTION_COUNT
+};
+
+static const struct m64p_chunk
+{
+    char tag[5];
+    enum m64p_chunk_section section;
+    size_t size;
+} m64p_chunks[] =
+{
+    { "HEAD", M64P_SECTION_HEADER, M64P_HEADER_SIZE },      /* magic, state version, ROM MD5 */
+    { "RDRG", M64P_SECTION_REGS, 40 },                      /* RDRAM registers */
+    { "MIRG", M64P_SECTION_REGS, 36 },                      /* MI */
+    { "PIRG", M64P_SECTION_REGS, 52 },                      /* PI */
+    { "SPRG", M64P_SECTION_REGS, 60 },                      /* RSP */
+    { "SIRG", M64P_SECTION_REGS, 16 },                      /* SI */
+    { "VIRG", M64P_SECTION_REGS, 60 },                      /* VI */
+    { "RIRG", M64P_SECTION_REGS, 32 },                      /* RI */
+    { "AIRG", M64P_SECTION_REGS, 40 },                      /* AI */
+    { "DPRG", M64P_SECTION_REGS, 64 },                      /* RDP command and span registers */
+    { "RDRM", M64P_SECTION_RDRAM, RDRAM_MAX_SIZE },
+    { "SPMM", M64P_SECTION_SP_MEM, SP_MEM_SIZE },           /* RSP DMEM and IMEM */
+    { "PIFR", M64P_SECTION_MID, PIF_RAM_SIZE },
+    { "FLSH", M64P_SECTION_MID, M64P_MID_SIZE - PIF_RAM_SIZE }, /* cart flashram */
+    { "TLBR", M64P_SECTION_LUT_R, M64P_TLB_LUTS_SIZE/2 },
+    { "TLBW", M64P_SECTION_LUT_W, M64P_TLB_LUTS_SIZE/2 },
+    { "R43K", M64P_SECTION_TAIL, M64P_TAIL_SIZE },          /* r4300, cp0 (TLB entries), cp1 */
+    { "EVTQ", M64P_SECTION_QUEUE, M64P_QUEUE_SIZE },
+    { "TLBF", M64P_SECTION_USING_TLB, 4 },
+    { "XTRA", M64P_SECTION_EXTRA, M64P_EXTRA_SIZE },        /* versioned extra state: carts, paks, DD, ... */
+};
+enum { M64P_CHUNK_COUNT = sizeof(m64p_chunks) / sizeof(m64p_chunks[0]) };
+
 static const unsigned char pj64_magic[4] = { 0xC8, 0xA6, 0xD8, 0x23 };
 
+/* m64p states are written as independent gzip members of this size */
+enum { SAVESTATE_GZIP_CHUNK_SIZE = 1024 * 1024 };
+
 static savestates_job job = savestates_job_nothing;
 static savestates_type type = savestates_type_unknown;
 static char *fname = NULL;
+static void *mem_buffer = NULL;
+static size_t mem_size = 0;
 
 static unsigned int slot = 0;
 static int autoinc_save_slot = 0;
@@ -71,9 +160,11 @@ static int autoinc_save_slot = 0;
 static SDL_mutex *savestates_lock;
 
 struct savestate_work {
+    savestates_type type;
     char *filepath;
     char *data;
     size_t size;
+    unsigned int threads;
     struct work_struct work;
 };
 
@@ -165,9 +256,30 @@ void savestates_set_job(savestates_job j, savestates_type t, const char *fn)
         fname = strdup(fn);
 }
 
+void savestates_set_memory_job(savestates_job j, void *buffer, size_t size)
+{
+    savestates_set_job(j, savestates_type_m64p_memory, NULL);
+    mem_buffer = buffer;
+    mem_size = size;
+}
+
+size_t savestates_memory_size(void)
+{
+    return M64P_SAVESTATE_SIZE;
+}
+
+/* number of threads used to (de)compress m64p states, 0 for one per CPU */
+static unsigned int savestates_gzip_threads(void)
+{
+    int threads = ConfigGetParamInt(g_CoreConfig, "SaveStateThreads");
+    return (threads > 0) ? (unsigned int)threads : 0;
+}
+
 static void savestates_clear_job(void)
 {
     savestates_set_job(savestates_job_nothing, savestates_type_unknown, NULL);
+    mem_buffer = NULL;
+    mem_size = 0;
 }
 
 #define GETARRAY(buff, type, count) \
@@ -185,126 +297,72 @@ static void savestates_clear_job(void)
 #define PUTDATA(buff, type, value) \
     do { type x = value; PUTARRAY(&x, buff, type, 1); } while(0)
 
-static int savestates_load_m64p(struct device* dev, char *filepath)
+/* Check the magic, version and ROM MD5 of a m64p savestate header */
+static int savestates_check_m64p_header(const unsigned char *header, unsigned int *version, const char *name)
 {
-    unsigned char header[44];
-    gzFile f;
-    unsigned int version;
-    int i;
-    uint32_t FCR31;
-
-    size_t savestateSize;
-    unsigned char *savestateData, *curr;
-    char queue[1024];
-    unsigned char using_tlb_data[4];
-    unsigned char data_0001_0200[4096]; // 4k for extra state from v1.2
-
-    uint32_t* cp0_regs = r4300_cp0_regs(&dev->r4300.cp0);
-
-    SDL_LockMutex(savestates_lock);
-
-    f = osal_gzopen(filepath, "rb");
-    if(f==NULL)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", filepath);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-
-    /* Read and check Mupen64Plus magic number. */
-    if (gzread(f, header, 44) != 44)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read header from state file %s", filepath);
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-    curr = header;
+    const unsigned char *curr = header;
 
     if(strncmp((char *)curr, savestate_magic, 8)!=0)
     {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State file: %s is not a valid Mupen64plus savestate.", filepath);
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State file: %s is not a valid Mupen64plus savestate.", name);
         return 0;
     }
     curr += 8;
 
-    version = *curr++;
-    version = (version << 8) | *curr++;
-    version = (version << 8) | *curr++;
-    version = (version << 8) | *curr++;
-    if((version >> 16) != (savestate_latest_version >> 16))
+    *version = *curr++;
+    *version = (*version << 8) | *curr++;
+    *version = (*version << 8) | *curr++;
+    *version = (*version << 8) | *curr++;
+    if((*version >> 16) != (savestate_latest_version >> 16))
     {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State version (%08x) isn't compatible. Please update Mupen64Plus.", version);
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State version (%08x) isn't compatible. Please update Mupen64Plus.", *version);
         return 0;
     }
 
     if(memcmp((char *)curr, ROM_SETTINGS.MD5, 32))
     {
         main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State ROM MD5 does not match current ROM.");
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
         return 0;
     }
-    curr += 32;
 
-    /* Read the rest of the savestate */
-    savestateSize = 16788244;
-    savestateData = curr = (unsigned char *)malloc(savestateSize);
-    if (savestateData == NULL)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to load state.");
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-    if (version == 0x00010000) /* original savestate version */
-    {
-        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
-            (gzread(f, queue, sizeof(queue)) % 4) != 0)
-        {
-            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.0 data from %s", filepath);
-            free(savestateData);
-            gzclose(f);
-            SDL_UnlockMutex(savestates_lock);
-            return 0;
-        }
-    }
-    else if (version == 0x00010100) // saves entire eventqueue plus 4-byte using_tlb flags
-    {
-        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
-            gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
-            gzread(f, using_tlb_data, sizeof(using_tlb_data)) != sizeof(using_tlb_data))
-        {
-            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.1 data from %s", filepath);
-            free(savestateData);
-            gzclose(f);
-            SDL_UnlockMutex(savestates_lock);
-            return 0;
-        }
-    }
-    else // version >= 0x00010200  saves entire eventqueue, 4-byte using_tlb flags and extra state
-    {
-        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
-            gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
-            gzread(f, using_tlb_data, sizeof(using_tlb_data)) != sizeof(using_tlb_data) ||
-            gzread(f, data_0001_0200, sizeof(data_0001_0200)) != sizeof(data_0001_0200))
-        {
-            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.2+ data from %s", filepath);
-            free(savestateData);
-            gzclose(f);
-            SDL_UnlockMutex(savestates_lock);
-            return 0;
-        }
-    }
+    return 1;
 
-    gzclose(f);
-    SDL_UnlockMutex(savestates_lock);
+}
+
+/* Point the sections into a contiguous m64p savestate, header excluded */
+static void savestates_m64p_sections(struct m64p_sections *s, unsigned char *data)
+{
+    s->regs = data;
+    s->rdram = s->regs + M64P_REGS_SIZE;
+    s->sp_mem = s->rdram + RDRAM_MAX_SIZE;
+    s->mid = s->sp_mem + SP_MEM_SIZE;
+    s->tlb_luts = s->mid + M64P_MID_SIZE;
+    s->tail = s->tlb_luts + M64P_TLB_LUTS_SIZE;
+    s->queue = (char *)s->tail + M64P_TAIL_SIZE;
+    s->using_tlb_data = (unsigned char *)s->queue + M64P_QUEUE_SIZE;
+    s->data_0001_0200 = s->using_tlb_data + 4;
+}
+
+/* Copy a 32-bit array section, or fix the byte order of an array which was read in place */
+static void savestates_load_array32(void *dst, unsigned char *src, size_t size)
+{
+    if (src != NULL)
+        COPYARRAY(dst, src, uint32_t, size/4);
+    else
+        to_little_endian_buffer(dst, 4, size/4);
+}
+
+/* Restore device state from the uncompressed m64p savestate sections */
+static void savestates_load_m64p_data(struct device* dev, unsigned int version,
+                                      const struct m64p_sections *s)
+{
+    int i;
+    uint32_t FCR31;
+    unsigned char *curr = s->regs;
+    char *queue = s->queue;
+
+    uint32_t* cp0_regs = r4300_cp0_regs(&dev->r4300.cp0);
 
-    // Parse savestate
     dev->rdram.regs[0][RDRAM_CONFIG_REG]       = GETDATA(curr, uint32_t);
     dev->rdram.regs[0][RDRAM_DEVICE_ID_REG]    = GETDATA(curr, uint32_t);
     dev->rdram.regs[0][RDRAM_DELAY_REG]        = GETDATA(curr, uint32_t);
@@ -419,8 +477,11 @@ static int savestates_load_m64p(struct device* dev, char *filepath)
     dev->dp.dps_regs[DPS_BUFTEST_ADDR_REG] = GETDATA(curr, uint32_t);
     dev->dp.dps_regs[DPS_BUFTEST_DATA_REG] = GETDATA(curr, uint32_t);
 
-    COPYARRAY(dev->rdram.dram, curr, uint32_t, RDRAM_MAX_SIZE/4);
-    COPYARRAY(dev->sp.mem, curr, uint32_t, SP_MEM_SIZE/4);
+    savestates_load_array32(dev->rdram.dram, s->rdram, RDRAM_MAX_SIZE);
+    rdram_mark_dirty_range(&dev->rdram, 0, RDRAM_MAX_SIZE);
+    savestates_load_array32(dev->sp.mem, s->sp_mem, SP_MEM_SIZE);
+
+    curr = s->mid;
     COPYARRAY(dev->pif.ram, curr, uint8_t, PIF_RAM_SIZE);
 
     dev->cart.use_flashram = GETDATA(curr, int32_t);
@@ -428,8 +489,10 @@ static int savestates_load_m64p(struct device* dev, char *filepath)
     /* by default, reset flashram state here and load it later if available */
     poweron_flashram(&dev->cart.flashram);
 
-    COPYARRAY(dev->r4300.cp0.tlb.LUT_r, curr, uint32_t, 0x100000);
-    COPYARRAY(dev->r4300.cp0.tlb.LUT_w, curr, uint32_t, 0x100000);
+    savestates_load_array32(dev->r4300.cp0.tlb.LUT_r, s->tlb_luts, M64P_TLB_LUTS_SIZE/2);
+    savestates_load_array32(dev->r4300.cp0.tlb.LUT_w, (s->tlb_luts != NULL) ? s->tlb_luts + M64P_TLB_LUTS_SIZE/2 : NULL, M64P_TLB_LUTS_SIZE/2);
+
+    curr = s->tail;
 
     *r4300_llbit(&dev->r4300) = GETDATA(curr, uint32_t);
     COPYARRAY(r4300_regs(&dev->r4300), curr, int64_t, 32);
@@ -488,7 +551,7 @@ static int savestates_load_m64p(struct device* dev, char *filepath)
 
     if (version >= 0x00010100)
     {
-        curr = using_tlb_data;
+        curr = s->using_tlb_data;
         using_tlb = GETDATA(curr, uint32_t);
     }
 #endif
@@ -504,7 +567,7 @@ static int savestates_load_m64p(struct device* dev, char *filepath)
 #define ALIGNED_GETDATA(buff, type) \
     (COPYARRAY(aligned.bytes, buff, uint8_t, sizeof(type)), *(type*)aligned.bytes)
 
-        curr = data_0001_0200;
+        curr = s->data_0001_0200;
 
         /* extra ai state */
         dev->ai.last_read = GETDATA(curr, uint32_t);
@@ -648,7 +711,7 @@ static int savestates_load_m64p(struct device* dev, char *filepath)
     }
     else if (version >= 0x00010300)
     {
-        curr = data_0001_0200;
+        curr = s->data_0001_0200;
 
         /* extra ai state */
         dev->ai.last_read = GETDATA(curr, uint32_t);
@@ -953,12 +1016,379 @@ static int savestates_load_m64p(struct device* dev, char *filepath)
     dev->r4300.cp0.interrupt_unsafe_state = 0;
 
     *r4300_cp0_last_addr(&dev->r4300.cp0) = *r4300_pc(&dev->r4300);
+}
+
+static int savestates_load_m64p_memory(struct device* dev, unsigned char *buffer, size_t size)
+{
+    unsigned int version;
+    struct m64p_sections s;
+
+    if (size < M64P_SAVESTATE_SIZE)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State buffer is too small (%u bytes).", (unsigned int)size);
+        return 0;
+    }
+
+    if (!savestates_check_m64p_header(buffer, &version, "(memory)"))
+        return 0;
+
+    if (version < 0x00010200)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State version (%08x) isn't supported for memory states.", version);
+        return 0;
+    }
+
+    savestates_m64p_sections(&s, buffer + M64P_HEADER_SIZE);
+    savestates_load_m64p_data(dev, version, &s);
+
+    return 1;
+}
+
+/* Small sections of a streamed m64p savestate,
+ * the large arrays are read straight into the device */
+struct m64p_stream_buffer
+{
+    unsigned char header[M64P_HEADER_SIZE];
+    unsigned char regs[M64P_REGS_SIZE];
+    unsigned char mid[M64P_MID_SIZE];
+    unsigned char tail[M64P_TAIL_SIZE];
+    char queue[M64P_QUEUE_SIZE];
+    unsigned char using_tlb_data[4];
+    unsigned char data_0001_0200[M64P_EXTRA_SIZE]; // 4k for extra state from v1.2
+};
+
+static void savestates_m64p_stream_sections(struct m64p_sections *s, struct m64p_stream_buffer *b)
+{
+    s->regs = b->regs;
+    s->rdram = NULL;
+    s->sp_mem = NULL;
+    s->mid = b->mid;
+    s->tlb_luts = NULL;
+    s->tail = b->tail;
+    s->queue = b->queue;
+    s->using_tlb_data = b->using_tlb_data;
+    s->data_0001_0200 = b->data_0001_0200;
+}
+
+/* Point the container chunks at the given section bases */
+static void savestates_m64p_chunk_list(struct state_chunk *chunks, unsigned char *const *bases)
+{
+    size_t offsets[M64P_SECTION_COUNT] = { 0 };
+    size_t i;
+
+    for (i = 0; i < M64P_CHUNK_COUNT; ++i)
+    {
+        const struct m64p_chunk *c = &m64p_chunks[i];
+
+        chunks[i].tag = c->tag;
+        chunks[i].data = bases[c->section] + offsets[c->section];
+        chunks[i].size = c->size;
+        offsets[c->section] += c->size;
+    }
+}
+
+/* A streamed load failed after overwriting part of the device */
+static void savestates_load_m64p_failed(const char *filepath)
+{
+    main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State file %s is truncated or corrupted, resetting", namefrompath(filepath));
+    main_reset(1);
+}
+
+/* Read the header of a gzip'd m64p savestate */
+static int savestates_read_m64p_header(const char *filepath, unsigned char *header)
+{
+    gzFile f = osal_gzopen(filepath, "rb");
+    int ret;
+
+    if (f == NULL)
+        return 0;
+
+    ret = (gzread(f, header, M64P_HEADER_SIZE) == M64P_HEADER_SIZE);
+    gzclose(f);
+    return ret;
+}
+
+/* Load a state made of gzip members written by parallel_gzip_write,
+ * inflating them in parallel straight into the device.
+ * Returns -1 if the file has another layout and must go through gzread */
+static int savestates_load_m64p_parallel(struct device* dev, char *filepath, struct m64p_stream_buffer *b)
+{
+    FILE *fPtr;
+    struct m64p_sections s;
+    struct parallel_gzip_segment segments[11];
+    unsigned int version;
+    size_t size = 0;
+    uint64_t start = osal_monotonic_ns();
+    int ret;
+
+    fPtr = osal_file_open(filepath, "rb");
+    if (fPtr == NULL)
+        return -1;
+
+    /* the header must be checked before anything is written to the device */
+    if (!savestates_read_m64p_header(filepath, b->header)
+     || !savestates_check_m64p_header(b->header, &version, filepath))
+    {
+        fclose(fPtr);
+        return 0;
+    }
+
+    segments[0].data = b->header;                       segments[0].size = M64P_HEADER_SIZE;
+    segments[1].data = b->regs;                         segments[1].size = M64P_REGS_SIZE;
+    segments[2].data = dev->rdram.dram;                 segments[2].size = RDRAM_MAX_SIZE;
+    segments[3].data = dev->sp.mem;                     segments[3].size = SP_MEM_SIZE;
+    segments[4].data = b->mid;                          segments[4].size = M64P_MID_SIZE;
+    segments[5].data = dev->r4300.cp0.tlb.LUT_r;        segments[5].size = M64P_TLB_LUTS_SIZE/2;
+    segments[6].data = dev->r4300.cp0.tlb.LUT_w;        segments[6].size = M64P_TLB_LUTS_SIZE/2;
+    segments[7].data = b->tail;                         segments[7].size = M64P_TAIL_SIZE;
+    segments[8].data = b->queue;                        segments[8].size = M64P_QUEUE_SIZE;
+    segments[9].data = b->using_tlb_data;               segments[9].size = 4;
+    segments[10].data = b->data_0001_0200;              segments[10].size = M64P_EXTRA_SIZE;
+
+    ret = parallel_gzip_readv(fPtr, segments, 11, &size, savestates_gzip_threads());
+    fclose(fPtr);
+
+    if (ret == 0)
+        return -1;
+
+    if (ret < 0 || size != M64P_SAVESTATE_SIZE)
+    {
+        savestates_load_m64p_failed(filepath);
+        return 0;
+    }
+
+    DebugMessage(M64MSG_VERBOSE, "State decompressed in %u ms (parallel gzip members)",
+                 (unsigned int)((osal_monotonic_ns() - start) / 1000000));
+
+    savestates_m64p_stream_sections(&s, b);
+    savestates_load_m64p_data(dev, version, &s);
 
-    free(savestateData);
     main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State loaded from: %s", namefrompath(filepath));
     return 1;
 }
 
+/* Load an uncompressed m64p savestate file, parsed from a private mapping.
+ * Returns -1 if the file is compressed */
+static int savestates_load_m64p_mapped(struct device* dev, char *filepath)
+{
+    unsigned char *data;
+    size_t size = 0;
+    int ret;
+
+    data = (unsigned char *)osal_file_map(filepath, &size);
+    if (data == NULL)
+        return -1;
+
+    if (size < 8 || strncmp((char *)data, savestate_magic, 8) != 0)
+    {
+        osal_file_unmap(data, size);
+        return -1;
+    }
+
+    ret = savestates_load_m64p_memory(dev, data, size);
+    osal_file_unmap(data, size);
+
+    if (ret)
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State loaded from: %s", namefrompath(filepath));
+    return ret;
+}
+
+/* Load a m64p savestate container, verifying every chunk before the
+ * device is touched and decompressing them concurrently, the large arrays
+ * straight into the device */
+static int savestates_load_m64p_chunked(struct device* dev, char *filepath)
+{
+    FILE *fPtr;
+    struct m64p_sections s;
+    struct m64p_stream_buffer *b;
+    struct state_chunk chunks[M64P_CHUNK_COUNT];
+    unsigned char *bases[M64P_SECTION_COUNT];
+    unsigned int version;
+    uint64_t start = osal_monotonic_ns();
+    int ret = 0;
+
+    SDL_LockMutex(savestates_lock);
+
+    b = malloc(sizeof(*b));
+    if (b == NULL)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to load state.");
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    fPtr = osal_file_open(filepath, "rb");
+    if (fPtr == NULL)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", filepath);
+        goto cleanup;
+    }
+
+    bases[M64P_SECTION_HEADER] = b->header;
+    bases[M64P_SECTION_REGS] = b->regs;
+    bases[M64P_SECTION_RDRAM] = (unsigned char *)dev->rdram.dram;
+    bases[M64P_SECTION_SP_MEM] = (unsigned char *)dev->sp.mem;
+    bases[M64P_SECTION_MID] = b->mid;
+    bases[M64P_SECTION_LUT_R] = (unsigned char *)dev->r4300.cp0.tlb.LUT_r;
+    bases[M64P_SECTION_LUT_W] = (unsigned char *)dev->r4300.cp0.tlb.LUT_w;
+    bases[M64P_SECTION_TAIL] = b->tail;
+    bases[M64P_SECTION_QUEUE] = (unsigned char *)b->queue;
+    bases[M64P_SECTION_USING_TLB] = b->using_tlb_data;
+    bases[M64P_SECTION_EXTRA] = b->data_0001_0200;
+    savestates_m64p_chunk_list(chunks, bases);
+
+    /* the header comes first, as the version and ROM must be checked
+     * before anything is written to the device */
+    if (state_container_read(fPtr, chunks, 1, 1) != 1)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read header from state file %s", filepath);
+        goto cleanup;
+    }
+    if (!savestates_check_m64p_header(b->header, &version, filepath))
+        goto cleanup;
+
+    ret = state_container_read(fPtr, chunks + 1, M64P_CHUNK_COUNT - 1, savestates_gzip_threads());
+    if (ret == 0)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State file %s is corrupted", namefrompath(filepath));
+        goto cleanup;
+    }
+    if (ret < 0)
+    {
+        ret = 0;
+        savestates_load_m64p_failed(filepath);
+        goto cleanup;
+    }
+
+    DebugMessage(M64MSG_VERBOSE, "State decompressed in %u ms (chunked container)",
+                 (unsigned int)((osal_monotonic_ns() - start) / 1000000));
+
+    savestates_m64p_stream_sections(&s, b);
+    savestates_load_m64p_data(dev, version, &s);
+
+    main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State loaded from: %s", namefrompath(filepath));
+
+cleanup:
+    if (fPtr != NULL)
+        fclose(fPtr);
+    free(b);
+    SDL_UnlockMutex(savestates_lock);
+    return ret;
+}
+
+static int savestates_load_m64p(struct device* dev, char *filepath)
+{
+    gzFile f;
+    unsigned int version;
+    struct m64p_sections s;
+    struct m64p_stream_buffer *b;
+    int ret;
+
+    SDL_LockMutex(savestates_lock);
+
+    ret = savestates_load_m64p_mapped(dev, filepath);
+    if (ret >= 0)
+    {
+        SDL_UnlockMutex(savestates_lock);
+        return ret;
+    }
+
+    b = malloc(sizeof(*b));
+    if (b == NULL)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to load state.");
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    if (savestates_gzip_threads() != 1)
+    {
+        ret = savestates_load_m64p_parallel(dev, filepath, b);
+        if (ret >= 0)
+        {
+            free(b);
+            SDL_UnlockMutex(savestates_lock);
+            return ret;
+        }
+    }
+
+    f = osal_gzopen(filepath, "rb");
+    if(f==NULL)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", filepath);
+        free(b);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    /* Read and check Mupen64Plus magic number. */
+    if (gzread(f, b->header, M64P_HEADER_SIZE) != M64P_HEADER_SIZE)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read header from state file %s", filepath);
+        gzclose(f);
+        free(b);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+    if (!savestates_check_m64p_header(b->header, &version, filepath))
+    {
+        gzclose(f);
+        free(b);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    /* Stream the rest of the savestate, large arrays straight into the device */
+    if (gzread(f, b->regs, M64P_REGS_SIZE) != M64P_REGS_SIZE)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate data from %s", filepath);
+        gzclose(f);
+        free(b);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    if (gzread(f, dev->rdram.dram, RDRAM_MAX_SIZE) != RDRAM_MAX_SIZE ||
+        gzread(f, dev->sp.mem, SP_MEM_SIZE) != SP_MEM_SIZE ||
+        gzread(f, b->mid, M64P_MID_SIZE) != M64P_MID_SIZE ||
+        gzread(f, dev->r4300.cp0.tlb.LUT_r, M64P_TLB_LUTS_SIZE/2) != M64P_TLB_LUTS_SIZE/2 ||
+        gzread(f, dev->r4300.cp0.tlb.LUT_w, M64P_TLB_LUTS_SIZE/2) != M64P_TLB_LUTS_SIZE/2 ||
+        gzread(f, b->tail, M64P_TAIL_SIZE) != M64P_TAIL_SIZE)
+        ret = 0;
+    else if (version == 0x00010000) /* original savestate version */
+        ret = (gzread(f, b->queue, sizeof(b->queue)) % 4) == 0;
+    else if (version == 0x00010100) // saves entire eventqueue plus 4-byte using_tlb flags
+        ret = gzread(f, b->queue, sizeof(b->queue)) == sizeof(b->queue) &&
+              gzread(f, b->using_tlb_data, sizeof(b->using_tlb_data)) == sizeof(b->using_tlb_data);
+    else // version >= 0x00010200  saves entire eventqueue, 4-byte using_tlb flags and extra state
+        ret = gzread(f, b->queue, sizeof(b->queue)) == sizeof(b->queue) &&
+              gzread(f, b->using_tlb_data, sizeof(b->using_tlb_data)) == sizeof(b->using_tlb_data) &&
+              gzread(f, b->data_0001_0200, sizeof(b->data_0001_0200)) == sizeof(b->data_0001_0200);
+
+    gzclose(f);
+    SDL_UnlockMutex(savestates_lock);
+
+    if (!ret)
+    {
+        savestates_load_m64p_failed(filepath);
+        free(b);
+        return 0;
+    }
+
+    savestates_m64p_stream_sections(&s, b);
+    savestates_load_m64p_data(dev, version, &s);
+
+    free(b);
+    main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State loaded from: %s", namefrompath(filepath));
+    return 1;
+}
+
+int savestates_load_m64p_buffer(void *buffer, size_t size)
+{
+    wait_rsp_task(&g_dev.sp);
+    return savestates_load_m64p_memory(&g_dev, (unsigned char *)buffer, size);
+}
+
 static int savestates_load_pj64(struct device* dev,
                                 char *filepath, void *handle,
                                 int (*read_func)(void *, void *, size_t))
@@ -1238,6 +1668,7 @@ static int savestates_load_pj64(struct device* dev,
     // RDRAM
     memset(dev->rdram.dram, 0, RDRAM_MAX_SIZE);
     COPYARRAY(dev->rdram.dram, curr, uint32_t, SaveRDRAMSize/4);
+    rdram_mark_dirty_range(&dev->rdram, 0, RDRAM_MAX_SIZE);
 
     // DMEM + IMEM
     COPYARRAY(dev->sp.mem, curr, uint32_t, SP_MEM_SIZE/4);
@@ -1368,7 +1799,8 @@ static int savestates_load_pj64_unc(struct device* dev, char *filepath)
 
 static savestates_type savestates_detect_type(char *filepath)
 {
-    unsigned char magic[4];
+    unsigned char magic[STATE_CONTAINER_MAGIC_SIZE];
+    size_t count;
     FILE *f = osal_file_open(filepath, "rb");
     if (f == NULL)
     {
@@ -1376,7 +1808,8 @@ static savestates_type savestates_detect_type(char *filepath)
         return savestates_type_unknown;
     }
 
-    if (fread(magic, 1, 4, f) != 4)
+    count = fread(magic, 1, sizeof(magic), f);
+    if (count < 4)
     {
         fclose(f);
         DebugMessage(M64MSG_STATUS, "Could not read from state file %s\n", filepath);
@@ -1387,6 +1820,10 @@ static savestates_type savestates_detect_type(char *filepath)
 
     if (magic[0] == 0x1f && magic[1] == 0x8b) // GZIP header
         return savestates_type_m64p;
+    else if (count == sizeof(magic) && state_container_is_magic(magic)) // M64P state container
+        return savestates_type_m64p_chunked;
+    else if (memcmp(magic, savestate_magic, 4) == 0) // uncompressed M64P state
+        return savestates_type_m64p;
     else if (memcmp(magic, "PK\x03\x04", 4) == 0) // ZIP header
         return savestates_type_pj64_zip;
     else if (memcmp(magic, pj64_magic, 4) == 0) // PJ64 header
@@ -1404,6 +1841,16 @@ int savestates_load(void)
     char *filepath = NULL;
     int ret = 0;
 
+    if (type == savestates_type_m64p_memory)
+    {
+        wait_rsp_task(&g_dev.sp);
+        ret = savestates_load_m64p_memory(&g_dev, (unsigned char *)mem_buffer, mem_size);
+
+        StateChanged(M64CORE_STATE_LOADCOMPLETE, ret);
+        savestates_clear_job();
+        return ret;
+    }
+
     if (fname == NULL) // For slots, autodetect the savestate type
     {
         // try M64P type first
@@ -1459,9 +1906,12 @@ int savestates_load(void)
     {
         struct device* dev = &g_dev;
 
+        wait_rsp_task(&dev->sp);
+
         switch (type)
         {
             case savestates_type_m64p: ret = savestates_load_m64p(dev, filepath); break;
+            case savestates_type_m64p_chunked: ret = savestates_load_m64p_chunked(dev, filepath); break;
             case savestates_type_pj64_zip: ret = savestates_load_pj64_zip(dev, filepath); break;
             case savestates_type_pj64_unc: ret = savestates_load_pj64_unc(dev, filepath); break;
             default: ret = 0; break;
@@ -1481,32 +1931,93 @@ int savestates_load(void)
 static void savestates_save_m64p_work(struct work_struct *work)
 {
     gzFile f;
+    FILE *fPtr;
     int gzres;
+    int failed = 0;
+    uint64_t start;
     struct savestate_work *save = container_of(work, struct savestate_work, work);
 
     SDL_LockMutex(savestates_lock);
+    start = osal_monotonic_ns();
+
+    if (save->type == savestates_type_m64p_chunked)
+    {
+        // Write the state as a container of chunks compressed in parallel
+        struct state_chunk chunks[M64P_CHUNK_COUNT];
+        unsigned char *bases[M64P_SECTION_COUNT];
+        struct m64p_sections s;
 
-    // Write the state to a GZIP file
-    f = osal_gzopen(save->filepath, "wb");
+        fPtr = osal_file_open(save->filepath, "wb");
+        if (fPtr == NULL)
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", save->filepath);
+            goto cleanup;
+        }
 
-    if (f==NULL)
+        savestates_m64p_sections(&s, (unsigned char *)save->data + M64P_HEADER_SIZE);
+        bases[M64P_SECTION_HEADER] = (unsigned char *)save->data;
+        bases[M64P_SECTION_REGS] = s.regs;
+        bases[M64P_SECTION_RDRAM] = s.rdram;
+        bases[M64P_SECTION_SP_MEM] = s.sp_mem;
+        bases[M64P_SECTION_MID] = s.mid;
+        bases[M64P_SECTION_LUT_R] = s.tlb_luts;
+        bases[M64P_SECTION_LUT_W] = s.tlb_luts + M64P_TLB_LUTS_SIZE/2;
+        bases[M64P_SECTION_TAIL] = s.tail;
+        bases[M64P_SECTION_QUEUE] = (unsigned char *)s.queue;
+        bases[M64P_SECTION_USING_TLB] = s.using_tlb_data;
+        bases[M64P_SECTION_EXTRA] = s.data_0001_0200;
+        savestates_m64p_chunk_list(chunks, bases);
+
+        failed = state_container_write(fPtr, chunks, M64P_CHUNK_COUNT,
+                                       Z_DEFAULT_COMPRESSION, save->threads) != 0;
+        if (fclose(fPtr) != 0)
+            failed = 1;
+    }
+    else if (save->threads != 1)
     {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", save->filepath);
-        free(save->data);
-        return;
+        // Write the state as gzip members compressed in parallel
+        fPtr = osal_file_open(save->filepath, "wb");
+        if (fPtr == NULL)
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", save->filepath);
+            goto cleanup;
+        }
+
+        failed = parallel_gzip_write(fPtr, save->data, save->size, SAVESTATE_GZIP_CHUNK_SIZE,
+                                     Z_DEFAULT_COMPRESSION, save->threads) != 0;
+        if (fclose(fPtr) != 0)
+            failed = 1;
+    }
+    else
+    {
+        // Write the state to a GZIP file
+        f = osal_gzopen(save->filepath, "wb");
+
+        if (f==NULL)
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", save->filepath);
+            goto cleanup;
+        }
+
+        gzres = gzwrite(f, save->data, save->size);
+        if ((gzres < 0) || ((size_t)gzres != save->size))
+            failed = 1;
+        gzclose(f);
     }
 
-    gzres = gzwrite(f, save->data, save->size);
-    if ((gzres < 0) || ((size_t)gzres != save->size))
+    if (failed)
     {
         main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not write data to state file: %s", save->filepath);
-        gzclose(f);
-        free(save->data);
-        return;
+        goto cleanup;
     }
 
-    gzclose(f);
+    DebugMessage(M64MSG_VERBOSE, "State compressed in %u ms (%s)",
+                 (unsigned int)((osal_monotonic_ns() - start) / 1000000),
+                 (save->type == savestates_type_m64p_chunked) ? "chunked container" :
+                 (save->threads != 1) ? "parallel gzip members" : "single gzip stream");
     main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Saved state to: %s", namefrompath(save->filepath));
+
+cleanup:
     free(save->data);
     free(save->filepath);
     free(save);
@@ -1514,46 +2025,20 @@ static void savestates_save_m64p_work(struct work_struct *work)
     SDL_UnlockMutex(savestates_lock);
 }
 
-static int savestates_save_m64p(const struct device* dev, char *filepath)
+/* Write the uncompressed m64p savestate (M64P_SAVESTATE_SIZE bytes) to data */
+static void savestates_save_m64p_data(const struct device* dev, char *data)
 {
     unsigned char outbuf[4];
     int i;
 
-    char queue[1024];
-
-    struct savestate_work *save;
-    char *curr;
+    char queue[M64P_QUEUE_SIZE];
+    char *curr = data;
 
     /* OK to cast away const qualifier */
     const uint32_t* cp0_regs = r4300_cp0_regs((struct cp0*)&dev->r4300.cp0);
 
-    save = malloc(sizeof(*save));
-    if (!save) {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
-        return 0;
-    }
-
-    save->filepath = strdup(filepath);
-
-    if(autoinc_save_slot)
-        savestates_inc_slot();
-
     save_eventqueue_infos(&dev->r4300.cp0, queue);
 
-    // Allocate memory for the save state data
-    save->size = 16788288 + sizeof(queue) + 4 + 4096;
-    save->data = curr = malloc(save->size);
-    if (save->data == NULL)
-    {
-        free(save->filepath);
-        free(save);
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
-        return 0;
-    }
-
-    memset(save->data, 0, save->size);
-
-    // Write the save state data to memory
     PUTARRAY(savestate_magic, curr, unsigned char, 8);
 
     outbuf[0] = (savestate_latest_version >> 24) & 0xff;
@@ -1709,7 +2194,8 @@ static int savestates_save_m64p(const struct device* dev, char *filepath)
     PUTARRAY(dev->pif.ram, curr, uint8_t, PIF_RAM_SIZE);
 
     PUTDATA(curr, int32_t, dev->cart.use_flashram);
-    curr += 4+8+4+4; // Here used to be flashram state
+    memset(curr, 0, 4+8+4+4); // Here used to be flashram state
+    curr += 4+8+4+4;
 
     PUTARRAY(dev->r4300.cp0.tlb.LUT_r, curr, uint32_t, 0x100000);
     PUTARRAY(dev->r4300.cp0.tlb.LUT_w, curr, uint32_t, 0x100000);
@@ -1848,6 +2334,7 @@ static int savestates_save_m64p(const struct device* dev, char *filepath)
 
     if (disk_id == NULL) {
         PUTDATA(curr, uint32_t, 0);
+        memset(curr, 0, (3+DD_ASIC_REGS_COUNT)*sizeof(uint32_t) + 0x100 + 0x40 + 2*sizeof(int64_t) + 2*sizeof(uint32_t));
         curr += (3+DD_ASIC_REGS_COUNT)*sizeof(uint32_t) + 0x100 + 0x40 + 2*sizeof(int64_t) + 2*sizeof(uint32_t);
     }
     else {
@@ -1910,12 +2397,65 @@ static int savestates_save_m64p(const struct device* dev, char *filepath)
     PUTDATA(curr, uint64_t, *r4300_cp0_latch((struct cp0*)&dev->r4300.cp0));
     PUTDATA(curr, uint64_t, *r4300_cp2_latch((struct cp2*)&dev->r4300.cp2));
 
+    /* unused part of the extra state */
+    memset(curr, 0, M64P_SAVESTATE_SIZE - (curr - data));
+}
+
+static int savestates_save_m64p(const struct device* dev, savestates_type type, char *filepath)
+{
+    struct savestate_work *save;
+
+    save = malloc(sizeof(*save));
+    if (!save) {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
+        return 0;
+    }
+
+    save->type = type;
+    save->filepath = strdup(filepath);
+
+    if(autoinc_save_slot)
+        savestates_inc_slot();
+
+    // Allocate memory for the save state data
+    save->size = M64P_SAVESTATE_SIZE;
+    save->data = malloc(save->size);
+    if (save->data == NULL)
+    {
+        free(save->filepath);
+        free(save);
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
+        return 0;
+    }
+
+    // Write the save state data to memory
+    savestates_save_m64p_data(dev, save->data);
+    save->threads = savestates_gzip_threads();
+
     init_work(&save->work, savestates_save_m64p_work);
     queue_work(&save->work);
 
     return 1;
 }
 
+static int savestates_save_m64p_memory(const struct device* dev, char *buffer, size_t size)
+{
+    if (size < M64P_SAVESTATE_SIZE)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State buffer is too small (%u bytes).", (unsigned int)size);
+        return 0;
+    }
+
+    savestates_save_m64p_data(dev, buffer);
+    return 1;
+}
+
+int savestates_save_m64p_buffer(void *buffer, size_t size)
+{
+    wait_rsp_task(&g_dev.sp);
+    return savestates_save_m64p_memory(&g_dev, (char *)buffer, size);
+}
+
 static int savestates_save_pj64(const struct device* dev,
                                 char *filepath, void *handle,
                                 int (*write_func)(void *, const void *, size_t))
@@ -2157,6 +2697,17 @@ int savestates_save(void)
     int ret = 0;
     const struct device* dev = &g_dev;
 
+    wait_rsp_task(&g_dev.sp);
+
+    if (type == savestates_type_m64p_memory)
+    {
+        ret = savestates_save_m64p_memory(dev, (char *)mem_buffer, mem_size);
+
+        StateChanged(M64CORE_STATE_SAVECOMPLETE, ret);
+        savestates_clear_job();
+        return ret;
+    }
+
     /* Can only save PJ64 savestates on VI / COMPARE interrupt.
        Otherwise try again in a little while. */
     if ((type == savestates_type_pj64_zip ||
@@ -2174,7 +2725,8 @@ int savestates_save(void)
     {
         switch (type)
         {
-            case savestates_type_m64p: ret = savestates_save_m64p(dev, filepath); break;
+            case savestates_type_m64p:
+            case savestates_type_m64p_chunked: ret = savestates_save_m64p(dev, type, filepath); break;
             case savestates_type_pj64_zip: ret = savestates_save_pj64_zip(dev, filepath); break;
             case savestates_type_pj64_unc: ret = savestates_save_pj64_unc(dev, filepath); break;
             default: ret = 0; break;
@@ -25,6 +25,8 @@
 #ifndef __SAVESTAVES_H__
 #define __SAVESTAVES_H__
 
+#include <stddef.h>
+
 typedef enum _savestates_job
 {
     savestates_job_nothing,
@@ -37,11 +39,19 @@ typedef enum _savestates_type
     savestates_type_unknown,
     savestates_type_m64p,
     savestates_type_pj64_zip,
-    savestates_type_pj64_unc
+    savestates_type_pj64_unc,
+    savestates_type_m64p_chunked,
+    savestates_type_m64p_memory
 } savestates_type;
 
 savestates_job savestates_get_job(void);
 void savestates_set_job(savestates_job j, savestates_type t, const char *fn);
+/* uncompressed m64p savestate in a caller provided buffer */
+void savestates_set_memory_job(savestates_job j, void *buffer, size_t size);
+size_t savestates_memory_size(void);
+/* immediate versions, only on the emulation thread between two instructions */
+int savestates_save_m64p_buffer(void *buffer, size_t size);
+int savestates_load_m64p_buffer(void *buffer, size_t size);
 void savestates_init(void);
 void savestates_deinit(void);
 
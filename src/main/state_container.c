@@ -0,0 +1,316 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - state_container.c                                       *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "state_container.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "parallel_gzip.h"
+
+static const unsigned char state_container_magic[STATE_CONTAINER_MAGIC_SIZE] =
+    { 'M', '6', '4', '+', 'C', 'H', 'N', 'K' };
+
+enum { STATE_CONTAINER_VERSION = 1 };
+enum { STATE_CONTAINER_HEADER_SIZE = 16 };
+enum { STATE_CONTAINER_ENTRY_SIZE = 24 };
+enum { STATE_CONTAINER_MAX_CHUNKS = 256 };
+
+/* chunk flags */
+enum { STATE_CHUNK_ZLIB = 0x1 };
+
+struct chunk_entry
+{
+    char tag[4];
+    uint32_t flags;
+    uint32_t size;
+    uint32_t stored_size;
+    uint32_t offset;
+    uint32_t crc;
+};
+
+static void put_le32(unsigned char* p, uint32_t v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static uint32_t get_le32(const unsigned char* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Read and check the header and directory of the container,
+ * returns the malloc'd directory or NULL */
+static struct chunk_entry* read_directory(FILE* f, size_t* count)
+{
+    unsigned char header[STATE_CONTAINER_HEADER_SIZE];
+    unsigned char* dir;
+    struct chunk_entry* entries;
+    size_t dir_size;
+    size_t i;
+
+    if (fseek(f, 0, SEEK_SET) != 0
+     || fread(header, 1, STATE_CONTAINER_HEADER_SIZE, f) != STATE_CONTAINER_HEADER_SIZE
+     || !state_container_is_magic(header))
+        return NULL;
+
+    if (get_le32(header + 8) > STATE_CONTAINER_VERSION)
+    {
+        DebugMessage(M64MSG_WARNING, "State container version %u isn't supported", get_le32(header + 8));
+        return NULL;
+    }
+
+    *count = get_le32(header + 12);
+    if (*count == 0 || *count > STATE_CONTAINER_MAX_CHUNKS)
+        return NULL;
+
+    dir_size = *count * STATE_CONTAINER_ENTRY_SIZE;
+    dir = malloc(dir_size);
+    entries = malloc(*count * sizeof(*entries));
+    if (dir == NULL || entries == NULL || fread(dir, 1, dir_size, f) != dir_size)
+    {
+        free(dir);
+        free(entries);
+        return NULL;
+    }
+
+    for (i = 0; i < *count; ++i)
+    {
+        const unsigned char* e = dir + i * STATE_CONTAINER_ENTRY_SIZE;
+        memcpy(entries[i].tag, e, 4);
+        entries[i].flags = get_le32(e + 4);
+        entries[i].size = get_le32(e + 8);
+        entries[i].stored_size = get_le32(e + 12);
+        entries[i].offset = get_le32(e + 16);
+        entries[i].crc = get_le32(e + 20);
+    }
+
+    free(dir);
+    return entries;
+}
+
+static const struct chunk_entry* find_entry(const struct chunk_entry* entries, size_t count, const char* tag)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+    {
+        if (memcmp(entries[i].tag, tag, 4) == 0)
+            return &entries[i];
+    }
+
+    return NULL;
+}
+
+int state_container_is_magic(const unsigned char* magic)
+{
+    return memcmp(magic, state_container_magic, STATE_CONTAINER_MAGIC_SIZE) == 0;
+}
+
+int state_container_write(FILE* f, const struct state_chunk* chunks, size_t count,
+                          int level, unsigned int threads)
+{
+    struct parallel_zlib_buffer* buffers;
+    unsigned char* header;
+    size_t header_size = STATE_CONTAINER_HEADER_SIZE + count * STATE_CONTAINER_ENTRY_SIZE;
+    size_t offset = header_size;
+    size_t i;
+    int ret = -1;
+
+    if (count == 0 || count > STATE_CONTAINER_MAX_CHUNKS)
+        return -1;
+
+    buffers = calloc(count, sizeof(*buffers));
+    header = malloc(header_size);
+    if (buffers == NULL || header == NULL)
+        goto cleanup;
+
+    for (i = 0; i < count; ++i)
+    {
+        buffers[i].in = chunks[i].data;
+        buffers[i].in_size = chunks[i].size;
+        buffers[i].out_size = compressBound((uLong)chunks[i].size);
+        buffers[i].out = malloc(buffers[i].out_size);
+        if (buffers[i].out == NULL)
+            goto cleanup;
+    }
+
+    /* independent chunks are compressed concurrently */
+    if (parallel_zlib_compress(buffers, count, level, threads) != 0)
+        goto cleanup;
+
+    memcpy(header, state_container_magic, STATE_CONTAINER_MAGIC_SIZE);
+    put_le32(header + 8, STATE_CONTAINER_VERSION);
+    put_le32(header + 12, (uint32_t)count);
+
+    for (i = 0; i < count; ++i)
+    {
+        unsigned char* e = header + STATE_CONTAINER_HEADER_SIZE + i * STATE_CONTAINER_ENTRY_SIZE;
+        int packed = buffers[i].out_size < chunks[i].size;
+
+        /* incompressible chunks are stored as is */
+        if (!packed)
+        {
+            buffers[i].out_size = chunks[i].size;
+            memcpy(buffers[i].out, chunks[i].data, chunks[i].size);
+        }
+
+        memcpy(e, chunks[i].tag, 4);
+        put_le32(e + 4, packed ? STATE_CHUNK_ZLIB : 0);
+        put_le32(e + 8, (uint32_t)chunks[i].size);
+        put_le32(e + 12, (uint32_t)buffers[i].out_size);
+        put_le32(e + 16, (uint32_t)offset);
+        put_le32(e + 20, (uint32_t)crc32(0, buffers[i].out, (uInt)buffers[i].out_size));
+        offset += buffers[i].out_size;
+    }
+
+    if (fwrite(header, 1, header_size, f) != header_size)
+        goto cleanup;
+
+    for (i = 0; i < count; ++i)
+    {
+        if (fwrite(buffers[i].out, 1, buffers[i].out_size, f) != buffers[i].out_size)
+            goto cleanup;
+    }
+
+    ret = 0;
+
+cleanup:
+    if (buffers != NULL)
+    {
+        for (i = 0; i < count; ++i)
+            free(buffers[i].out);
+    }
+    free(buffers);
+    free(header);
+    return ret;
+}
+
+int state_container_find(FILE* f, const char* tag, size_t* size)
+{
+    struct chunk_entry* entries;
+    const struct chunk_entry* e;
+    size_t count;
+
+    entries = read_directory(f, &count);
+    if (entries == NULL)
+        return -1;
+
+    e = find_entry(entries, count, tag);
+    if (e != NULL)
+        *size = e->size;
+
+    free(entries);
+    return e != NULL;
+}
+
+int state_container_read(FILE* f, const struct state_chunk* chunks, size_t count,
+                         unsigned int threads)
+{
+    struct chunk_entry* entries;
+    struct parallel_zlib_buffer* buffers = NULL;
+    unsigned char** stored = NULL;
+    size_t entry_count;
+    size_t packed = 0;
+    size_t i;
+    int ret = 0;
+
+    entries = read_directory(f, &entry_count);
+    if (entries == NULL)
+        return 0;
+
+    stored = calloc(count, sizeof(*stored));
+    buffers = calloc(count, sizeof(*buffers));
+    if (stored == NULL || buffers == NULL)
+        goto cleanup;
+
+    /* read and verify every chunk before writing to the buffers */
+    for (i = 0; i < count; ++i)
+    {
+        const struct chunk_entry* e = find_entry(entries, entry_count, chunks[i].tag);
+
+        if (e == NULL || e->size != chunks[i].size || (e->flags & ~STATE_CHUNK_ZLIB) != 0)
+        {
+            DebugMessage(M64MSG_WARNING, "State chunk %.4s is missing or has an unexpected layout", chunks[i].tag);
+            goto cleanup;
+        }
+
+        stored[i] = malloc(e->stored_size);
+        if (stored[i] == NULL
+         || fseek(f, (long)e->offset, SEEK_SET) != 0
+         || fread(stored[i], 1, e->stored_size, f) != e->stored_size)
+        {
+            DebugMessage(M64MSG_WARNING, "Could not read state chunk %.4s", chunks[i].tag);
+            goto cleanup;
+        }
+
+        if ((uint32_t)crc32(0, stored[i], e->stored_size) != e->crc)
+        {
+            DebugMessage(M64MSG_WARNING, "State chunk %.4s has a bad checksum", chunks[i].tag);
+            goto cleanup;
+        }
+
+        if (e->flags & STATE_CHUNK_ZLIB)
+        {
+            buffers[packed].in = stored[i];
+            buffers[packed].in_size = e->stored_size;
+            buffers[packed].out = chunks[i].data;
+            buffers[packed].out_size = chunks[i].size;
+            ++packed;
+        }
+        else if (e->stored_size != e->size)
+        {
+            DebugMessage(M64MSG_WARNING, "State chunk %.4s has an unexpected layout", chunks[i].tag);
+            goto cleanup;
+        }
+    }
+
+    ret = -1;
+
+    for (i = 0; i < count; ++i)
+    {
+        if (!(find_entry(entries, entry_count, chunks[i].tag)->flags & STATE_CHUNK_ZLIB))
+            memcpy(chunks[i].data, stored[i], chunks[i].size);
+    }
+
+    if (parallel_zlib_uncompress(buffers, packed, threads) == 0)
+        ret = 1;
+    else
+        DebugMessage(M64MSG_WARNING, "Could not decompress state chunks");
+
+cleanup:
+    if (stored != NULL)
+    {
+        for (i = 0; i < count; ++i)
+            free(stored[i]);
+    }
+    free(stored);
+    free(buffers);
+    free(entries);
+    return ret;
+}
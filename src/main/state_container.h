@@ -0,0 +1,69 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - state_container.h                                       *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_STATE_CONTAINER_H
+#define M64P_MAIN_STATE_CONTAINER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* Tagged chunk container for savestates (little endian):
+ *
+ *   "M64+CHNK", container version, chunk count,
+ *   directory of (tag, flags, size, stored size, offset, crc32) entries,
+ *   chunk data.
+ *
+ * Chunks are compressed individually (zlib) unless that does not pay, and
+ * the crc32 covers the stored bytes, so that a chunk can be verified and
+ * extracted without touching the others.
+ *
+ * threads == 0 uses one thread per CPU.
+ */
+
+enum { STATE_CONTAINER_MAGIC_SIZE = 8 };
+
+struct state_chunk
+{
+    const char* tag;    /* 4 characters */
+    void* data;
+    size_t size;
+};
+
+int state_container_is_magic(const unsigned char* magic);
+
+/* Write the chunks to f. Returns 0 on success, -1 on failure. */
+int state_container_write(FILE* f, const struct state_chunk* chunks, size_t count,
+                          int level, unsigned int threads);
+
+/* Look for a chunk in the container f. Returns 1 if found (with its
+ * uncompressed size in *size), 0 if not found, -1 if f is not a valid
+ * container. */
+int state_container_find(FILE* f, const char* tag, size_t* size);
+
+/* Extract chunks of the container f into their data buffers, whose sizes
+ * must match. Chunks of the container which were not asked for are
+ * ignored. Returns 1 on success, 0 if a chunk is missing, has another size
+ * or a bad checksum (nothing is written then), and -1 if a verified chunk
+ * failed to decompress (the buffers may be partially written). */
+int state_container_read(FILE* f, const struct state_chunk* chunks, size_t count,
+                         unsigned int threads);
+
+#endif
@@ -0,0 +1,202 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - trace.c                                                 *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "trace.h"
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "osal/timer.h"
+
+#if defined(_MSC_VER)
+  #define trace_thread_local __declspec(thread)
+#else
+  #define trace_thread_local __thread
+#endif
+
+enum { TRACE_MAX_THREADS = 32 };
+enum { TRACE_MIN_EVENTS = 1024, TRACE_MAX_EVENTS = 1 << 24 };
+
+struct trace_record
+{
+    uint64_t ns;
+    const char* name;
+    uint32_t cycle;
+    char phase;
+};
+
+struct trace_ring
+{
+    struct trace_record* records;
+    uint32_t mask;
+    /* free running, only written by the owning thread once the record is complete */
+    SDL_atomic_t head;
+    const char* thread_name;
+};
+
+struct trace_thread
+{
+    unsigned int generation;
+    struct trace_ring* ring;
+    const char* name;
+};
+
+int g_trace_enabled = 0;
+
+static struct trace_ring l_rings[TRACE_MAX_THREADS];
+static SDL_atomic_t l_ring_count;
+/* bumped on each start, so that threads drop rings of a previous trace */
+static unsigned int l_generation;
+static uint32_t l_ring_size;
+static uint64_t l_start_ns;
+static FILE* l_file;
+
+static trace_thread_local struct trace_thread l_thread;
+
+static struct trace_ring* claim_ring(void)
+{
+    int index = SDL_AtomicAdd(&l_ring_count, 1);
+    struct trace_ring* ring = NULL;
+
+    if (index < TRACE_MAX_THREADS) {
+        ring = &l_rings[index];
+        ring->mask = l_ring_size - 1;
+        ring->thread_name = l_thread.name;
+        ring->records = malloc(l_ring_size * sizeof(*ring->records));
+        if (ring->records == NULL)
+            ring = NULL;
+    }
+
+    l_thread.generation = l_generation;
+    l_thread.ring = ring;
+    return ring;
+}
+
+void trace_event(enum trace_phase phase, const char* name, uint64_t cycle)
+{
+    struct trace_ring* ring = l_thread.ring;
+    struct trace_record* record;
+    uint32_t head;
+
+    if (l_thread.generation != l_generation)
+        ring = claim_ring();
+    if (ring == NULL)
+        return;
+
+    head = (uint32_t)SDL_AtomicGet(&ring->head);
+    record = &ring->records[head & ring->mask];
+    record->ns = osal_monotonic_ns();
+    record->name = name;
+    record->cycle = (uint32_t)cycle;
+    record->phase = (char)phase;
+    SDL_AtomicSet(&ring->head, (int)(head + 1));
+}
+
+void trace_thread_name(const char* name)
+{
+    l_thread.name = name;
+}
+
+int trace_start(const char* path, size_t events_per_thread)
+{
+    if (g_trace_enabled)
+        trace_stop();
+
+    l_file = fopen(path, "w");
+    if (l_file == NULL) {
+        DebugMessage(M64MSG_ERROR, "Couldn't create trace file %s", path);
+        return -1;
+    }
+
+    l_ring_size = TRACE_MIN_EVENTS;
+    while (l_ring_size < events_per_thread && l_ring_size < TRACE_MAX_EVENTS)
+        l_ring_size <<= 1;
+
+    memset(l_rings, 0, sizeof(l_rings));
+    SDL_AtomicSet(&l_ring_count, 0);
+    ++l_generation;
+    l_start_ns = osal_monotonic_ns();
+    g_trace_enabled = 1;
+
+    DebugMessage(M64MSG_INFO, "Tracing to %s (%u events per thread)", path, l_ring_size);
+    return 0;
+}
+
+static void write_ring(struct trace_ring* ring, int tid, int* first)
+{
+    uint32_t head = (uint32_t)SDL_AtomicGet(&ring->head);
+    uint32_t count = (head > ring->mask) ? ring->mask + 1 : head;
+    uint32_t i;
+
+    if (ring->thread_name != NULL)
+        fprintf(l_file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                *first ? "" : ",", tid, ring->thread_name);
+    else
+        fprintf(l_file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                *first ? "" : ",", tid, tid);
+    *first = 0;
+
+    if (count < head)
+        DebugMessage(M64MSG_WARNING, "Trace: %u oldest events of thread %d were overwritten", head - count, tid);
+
+    for (i = head - count; i != head; ++i) {
+        const struct trace_record* record = &ring->records[i & ring->mask];
+        double ts = (double)(record->ns - l_start_ns) / 1000.0;
+
+        if (record->phase == TRACE_INSTANT)
+            fprintf(l_file, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"cycle\":%u}}",
+                    record->name, ts, tid, record->cycle);
+        else
+            fprintf(l_file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                    record->name, record->phase, ts, tid);
+    }
+}
+
+void trace_stop(void)
+{
+    int count, first = 1;
+    int i;
+
+    if (!g_trace_enabled)
+        return;
+    g_trace_enabled = 0;
+
+    count = SDL_AtomicGet(&l_ring_count);
+    if (count > TRACE_MAX_THREADS)
+        count = TRACE_MAX_THREADS;
+
+    fprintf(l_file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (i = 0; i < count; ++i) {
+        if (l_rings[i].records != NULL)
+            write_ring(&l_rings[i], i, &first);
+        free(l_rings[i].records);
+        l_rings[i].records = NULL;
+    }
+    fprintf(l_file, "\n]}\n");
+
+    if (fclose(l_file) != 0)
+        DebugMessage(M64MSG_ERROR, "Couldn't write trace file");
+    l_file = NULL;
+}
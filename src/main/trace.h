@@ -0,0 +1,82 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - trace.h                                                 *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_TRACE_H
+#define M64P_MAIN_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "osal/preproc.h"
+
+/* Opt-in timeline tracer writing Chrome trace-event JSON (readable by
+ * Perfetto and chrome://tracing).
+ *
+ * Each thread records into its own ring of fixed size, claimed on its first
+ * event, so recording needs neither locks nor allocations on the hot path.
+ * When a ring is full the oldest events are overwritten. The rings are
+ * written to the trace file and released when the trace is stopped.
+ *
+ * Names must point to static strings: only the pointer is recorded.
+ */
+
+enum trace_phase
+{
+    TRACE_BEGIN = 'B',
+    TRACE_END = 'E',
+    TRACE_INSTANT = 'i'
+};
+
+extern int g_trace_enabled;
+
+void trace_event(enum trace_phase phase, const char* name, uint64_t cycle);
+
+static osal_inline void trace_begin(const char* name)
+{
+    if (g_trace_enabled)
+        trace_event(TRACE_BEGIN, name, 0);
+}
+
+static osal_inline void trace_end(const char* name)
+{
+    if (g_trace_enabled)
+        trace_event(TRACE_END, name, 0);
+}
+
+/* guest event, cycle is the r4300 count register when it fired */
+static osal_inline void trace_instant(const char* name, uint64_t cycle)
+{
+    if (g_trace_enabled)
+        trace_event(TRACE_INSTANT, name, cycle);
+}
+
+/* Names the calling thread in the trace, to be called when a thread starts */
+void trace_thread_name(const char* name);
+
+/* Starts recording, up to events_per_thread events per thread.
+ * Returns 0 on success, -1 if the trace file cannot be created. */
+int trace_start(const char* path, size_t events_per_thread);
+
+/* Stops recording and writes the trace file. All traced threads must be
+ * idle. */
+void trace_stop(void);
+
+#endif
@@ -30,6 +30,7 @@
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
 #include "main/list.h"
+#include "main/trace.h"
 
 #define WORKQUEUE_THREADS 1
 
@@ -38,6 +39,8 @@ struct workqueue_mgmt_globals {
     struct list_head thread_queue;
     struct list_head thread_list;
     SDL_mutex *lock;
+    SDL_cond *idle;
+    unsigned int busy;
 };
 
 struct workqueue_thread {
@@ -65,6 +68,7 @@ static struct work_struct *workqueue_get_work(struct workqueue_thread *thread)
             found = 1;
             work = list_first_entry(&workqueue_mgmt.work_queue, struct work_struct, list);
             list_del_init(&work->list);
+            workqueue_mgmt.busy++;
         } else {
             list_add(&thread->list, &workqueue_mgmt.thread_queue);
 	        SDL_CondWait(thread->work_avail, workqueue_mgmt.lock);
@@ -83,6 +87,8 @@ static int workqueue_thread_handler(void *data)
     struct workqueue_thread *thread = data;
     struct work_struct *work;
 
+    trace_thread_name("workqueue");
+
     for (;;) {
         work = workqueue_get_work(thread);
         if (work->func == workqueue_dismiss) {
@@ -90,34 +96,29 @@ static int workqueue_thread_handler(void *data)
             break;
         }
 
+        trace_begin("work");
         work->func(work);
+        trace_end("work");
+
+        SDL_LockMutex(workqueue_mgmt.lock);
+        if (--workqueue_mgmt.busy == 0 && list_empty(&workqueue_mgmt.work_queue))
+            SDL_CondBroadcast(workqueue_mgmt.idle);
+        SDL_UnlockMutex(workqueue_mgmt.lock);
     }
 
     return 0;
 }
 
-int workqueue_init(void)
+/* must be called with workqueue_mgmt.lock held */
+static int workqueue_start_threads(void)
 {
     size_t i;
     struct workqueue_thread *thread;
 
-    memset(&workqueue_mgmt, 0, sizeof(workqueue_mgmt));
-    INIT_LIST_HEAD(&workqueue_mgmt.work_queue);
-    INIT_LIST_HEAD(&workqueue_mgmt.thread_queue);
-    INIT_LIST_HEAD(&workqueue_mgmt.thread_list);
-
-    workqueue_mgmt.lock = SDL_CreateMutex();
-    if (!workqueue_mgmt.lock) {
-        DebugMessage(M64MSG_ERROR, "Could not create workqueue management");
-        return -1;
-    }
-
-    SDL_LockMutex(workqueue_mgmt.lock);
     for (i = 0; i < WORKQUEUE_THREADS; i++) {
         thread = malloc(sizeof(*thread));
         if (!thread) {
             DebugMessage(M64MSG_ERROR, "Could not create workqueue thread management data");
-            SDL_UnlockMutex(workqueue_mgmt.lock);
             return -1;
         }
 
@@ -127,7 +128,6 @@ int workqueue_init(void)
         thread->work_avail = SDL_CreateCond();
         if (!thread->work_avail) {
             DebugMessage(M64MSG_ERROR, "Could not create workqueue thread work_avail condition");
-            SDL_UnlockMutex(workqueue_mgmt.lock);
             return -1;
         }
 
@@ -138,15 +138,56 @@ int workqueue_init(void)
 #endif
         if (!thread->thread) {
             DebugMessage(M64MSG_ERROR, "Could not create workqueue thread handler");
-            SDL_UnlockMutex(workqueue_mgmt.lock);
             return -1;
         }
     }
-    SDL_UnlockMutex(workqueue_mgmt.lock);
 
     return 0;
 }
 
+int workqueue_init(void)
+{
+    int ret;
+
+    memset(&workqueue_mgmt, 0, sizeof(workqueue_mgmt));
+    INIT_LIST_HEAD(&workqueue_mgmt.work_queue);
+    INIT_LIST_HEAD(&workqueue_mgmt.thread_queue);
+    INIT_LIST_HEAD(&workqueue_mgmt.thread_list);
+
+    workqueue_mgmt.lock = SDL_CreateMutex();
+    workqueue_mgmt.idle = SDL_CreateCond();
+    if (!workqueue_mgmt.lock || !workqueue_mgmt.idle) {
+        DebugMessage(M64MSG_ERROR, "Could not create workqueue management");
+        return -1;
+    }
+
+    SDL_LockMutex(workqueue_mgmt.lock);
+    ret = workqueue_start_threads();
+    SDL_UnlockMutex(workqueue_mgmt.lock);
+
+    return ret;
+}
+
+void workqueue_suspend(void)
+{
+    SDL_LockMutex(workqueue_mgmt.lock);
+    while (workqueue_mgmt.busy != 0 || !list_empty(&workqueue_mgmt.work_queue))
+        SDL_CondWait(workqueue_mgmt.idle, workqueue_mgmt.lock);
+}
+
+void workqueue_resume(int forked_child)
+{
+    if (forked_child) {
+        /* the worker threads were not forked: forget them and start new ones */
+        INIT_LIST_HEAD(&workqueue_mgmt.thread_queue);
+        INIT_LIST_HEAD(&workqueue_mgmt.thread_list);
+        if (workqueue_start_threads() != 0)
+            DebugMessage(M64MSG_ERROR, "Could not restart workqueue after fork");
+    }
+
+    SDL_UnlockMutex(workqueue_mgmt.lock);
+}
+
 void workqueue_shutdown(void)
 {
     size_t i;
@@ -170,6 +211,7 @@ void workqueue_shutdown(void)
     if (!list_empty(&workqueue_mgmt.work_queue))
         DebugMessage(M64MSG_WARNING, "Stopped workqueue with work still pending");
 
+    SDL_DestroyCond(workqueue_mgmt.idle);
     SDL_DestroyMutex(workqueue_mgmt.lock);
 }
 
@@ -45,6 +45,12 @@ int workqueue_init(void);
 void workqueue_shutdown(void);
 int queue_work(struct work_struct *work);
 
+/* Wait for queued work to complete and keep the workqueue idle until
+ * workqueue_resume, so that the process can be forked safely. In a forked
+ * child, workqueue_resume starts new worker threads. */
+void workqueue_suspend(void);
+void workqueue_resume(int forked_child);
+
 #else
 
 static osal_inline int workqueue_init(void)
@@ -62,6 +68,14 @@ static osal_inline int queue_work(struct work_struct *work)
     return 0;
 }
 
+static osal_inline void workqueue_suspend(void)
+{
+}
+
+static osal_inline void workqueue_resume(int forked_child)
+{
+}
+
 #endif
 
 #endif
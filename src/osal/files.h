@@ -26,6 +26,7 @@
 #if !defined (OSAL_FILES_H)
 #define OSAL_FILES_H
 
+#include <stdint.h>
 #include <zlib.h>
 
 /* some file-related preprocessor definitions */
@@ -67,5 +68,46 @@ extern const char * osal_get_user_cachepath(void);
 extern FILE * osal_file_open (const char *filename, const char *mode);
 extern gzFile osal_gzopen(const char *filename, const char *mode);
 
+/* Map a whole file in memory with private copy-on-write pages, so that the
+ * caller may modify the mapping without touching the file.
+ * Returns NULL on failure. Release with osal_file_unmap.
+ */
+extern void * osal_file_map(const char *filename, size_t *size);
+extern void osal_file_unmap(void *data, size_t size);
+
+/* Map a whole file in memory with shared pages, so that changes to the
+ * mapping end up in the file. Returns NULL on failure.
+ * Release with osal_file_unmap.
+ */
+extern void * osal_file_map_shared(const char *filename, size_t *size);
+
+/* Write back size bytes at offset of a shared mapping to the file.
+ * Returns zero on success, nonzero on failure.
+ */
+extern int osal_file_sync(void *data, size_t offset, size_t size);
+
+/* Replace a shared mapping by a private copy at the same address, so that
+ * further changes stay in this process. Returns zero on success, nonzero
+ * on failure (or if not supported).
+ */
+extern int osal_file_detach(void *data, size_t size);
+
+/* Map the first size bytes of a file with private copy-on-write pages at
+ * addr, which must be page aligned, in place of the memory there.
+ * Returns zero on success, nonzero on failure (or if not supported).
+ */
+extern int osal_file_map_at(const char *filename, void *addr, size_t size);
+
+/* Replace a mapping made by osal_file_map_at by zeroed memory.
+ * Returns zero on success, nonzero on failure.
+ */
+extern int osal_file_unmap_at(void *addr, size_t size);
+
+/* Get the size, last modification time and file system identifier (inode or
+ * file index) of a file, so that callers can tell when it has been replaced.
+ * Returns zero on success, nonzero on failure.
+ */
+extern int osal_file_identity(const char *filename, uint64_t *size, int64_t *mtime, uint64_t *fileid);
+
 #endif /* OSAL_FILES_H */
 
@@ -23,10 +23,13 @@
  * functions
  */
 
+#include <fcntl.h>
 #include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -241,3 +244,125 @@ gzFile osal_gzopen(const char *filename, const char *mode)
 {
     return gzopen(filename, mode);
 }
+
+void * osal_file_map(const char *filename, size_t *size)
+{
+    struct stat st;
+    void *data;
+    int fd = open(filename, O_RDONLY);
+
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+
+    *size = (size_t)st.st_size;
+    return data;
+}
+
+void osal_file_unmap(void *data, size_t size)
+{
+    munmap(data, size);
+}
+
+void * osal_file_map_shared(const char *filename, size_t *size)
+{
+    struct stat st;
+    void *data;
+    int fd = open(filename, O_RDWR);
+
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+
+    *size = (size_t)st.st_size;
+    return data;
+}
+
+int osal_file_sync(void *data, size_t offset, size_t size)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = offset - offset % page;
+
+    return msync((char *)data + start, offset + size - start, MS_SYNC);
+}
+
+int osal_file_detach(void *data, size_t size)
+{
+    void *copy = malloc(size);
+
+    if (copy == NULL)
+        return -1;
+
+    memcpy(copy, data, size);
+    if (mmap(data, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+    {
+        free(copy);
+        return -1;
+    }
+
+    memcpy(data, copy, size);
+    free(copy);
+    return 0;
+}
+
+int osal_file_map_at(const char *filename, void *addr, size_t size)
+{
+    struct stat st;
+    void *data;
+    int fd;
+
+    if ((uintptr_t)addr % (uintptr_t)sysconf(_SC_PAGESIZE) != 0)
+        return -1;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < size)
+    {
+        close(fd);
+        return -1;
+    }
+
+    data = mmap(addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    close(fd);
+    return (data == MAP_FAILED) ? -1 : 0;
+}
+
+int osal_file_unmap_at(void *addr, size_t size)
+{
+    return (mmap(addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) ? -1 : 0;
+}
+
+int osal_file_identity(const char *filename, uint64_t *size, int64_t *mtime, uint64_t *fileid)
+{
+    struct stat st;
+
+    if (stat(filename, &st) != 0)
+        return -1;
+
+    *size = (uint64_t)st.st_size;
+    *mtime = (int64_t)st.st_mtime;
+    *fileid = ((uint64_t)st.st_dev << 32) ^ (uint64_t)st.st_ino;
+    return 0;
+}
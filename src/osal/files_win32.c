@@ -220,3 +220,123 @@ gzFile osal_gzopen(const char *filename, const char *mode)
     MultiByteToWideChar(CP_UTF8, 0, filename, -1, wstr_filename, PATH_MAX);
     return gzopen_w(wstr_filename, mode);
 }
+
+void * osal_file_map(const char *filename, size_t *size)
+{
+    wchar_t wstr_filename[PATH_MAX];
+    HANDLE file, mapping;
+    LARGE_INTEGER file_size;
+    void *data = NULL;
+
+    MultiByteToWideChar(CP_UTF8, 0, filename, -1, wstr_filename, PATH_MAX);
+    file = CreateFileW(wstr_filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    /* the view keeps the mapping and the file alive */
+    mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (mapping != NULL)
+    {
+        data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+
+    if (data != NULL)
+        *size = (size_t)file_size.QuadPart;
+    return data;
+}
+
+void osal_file_unmap(void *data, size_t size)
+{
+    (void)size;
+    UnmapViewOfFile(data);
+}
+
+void * osal_file_map_shared(const char *filename, size_t *size)
+{
+    wchar_t wstr_filename[PATH_MAX];
+    HANDLE file, mapping;
+    LARGE_INTEGER file_size;
+    void *data = NULL;
+
+    MultiByteToWideChar(CP_UTF8, 0, filename, -1, wstr_filename, PATH_MAX);
+    file = CreateFileW(wstr_filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    /* the view keeps the mapping and the file alive */
+    mapping = CreateFileMappingW(file, NULL, PAGE_READWRITE, 0, 0, NULL);
+    if (mapping != NULL)
+    {
+        data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+
+    if (data != NULL)
+        *size = (size_t)file_size.QuadPart;
+    return data;
+}
+
+int osal_file_sync(void *data, size_t offset, size_t size)
+{
+    return FlushViewOfFile((char *)data + offset, size) ? 0 : -1;
+}
+
+int osal_file_detach(void *data, size_t size)
+{
+    (void)data;
+    (void)size;
+    return -1;
+}
+
+int osal_file_map_at(const char *filename, void *addr, size_t size)
+{
+    (void)filename;
+    (void)addr;
+    (void)size;
+    return -1;
+}
+
+int osal_file_unmap_at(void *addr, size_t size)
+{
+    (void)addr;
+    (void)size;
+    return -1;
+}
+
+int osal_file_identity(const char *filename, uint64_t *size, int64_t *mtime, uint64_t *fileid)
+{
+    wchar_t wstr_filename[PATH_MAX];
+    BY_HANDLE_FILE_INFORMATION info;
+    HANDLE file;
+    BOOL ok;
+
+    MultiByteToWideChar(CP_UTF8, 0, filename, -1, wstr_filename, PATH_MAX);
+    file = CreateFileW(wstr_filename, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return -1;
+
+    ok = GetFileInformationByHandle(file, &info);
+    CloseHandle(file);
+    if (!ok)
+        return -1;
+
+    *size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    *mtime = (int64_t)(((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime);
+    *fileid = ((uint64_t)info.nFileIndexHigh << 32) ^ info.nFileIndexLow ^ ((uint64_t)info.dwVolumeSerialNumber << 16);
+    return 0;
+}
@@ -0,0 +1,47 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - osal/timer.h                                            *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* This file contains the declarations for OS-dependent high resolution
+ * timing functions
+ */
+
+#if !defined (OSAL_TIMER_H)
+#define OSAL_TIMER_H
+
+#include <stdint.h>
+
+/* How early a sleep should end so that the caller can spin up to an exact
+ * deadline without being late because of scheduler latency */
+#if defined(WIN32)
+  #define OSAL_TIMER_SLEEP_SLACK_NS 1000000
+#else
+  #define OSAL_TIMER_SLEEP_SLACK_NS 200000
+#endif
+
+/* Returns a monotonic time in nanoseconds, with an unspecified origin */
+extern uint64_t osal_monotonic_ns(void);
+
+/* Sleep until the monotonic time deadline_ns.
+ * May return slightly before or after the deadline.
+ */
+extern void osal_sleep_until_ns(uint64_t deadline_ns);
+
+#endif /* OSAL_TIMER_H */
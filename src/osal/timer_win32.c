@@ -0,0 +1,74 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - osal/timer_win32.c                                      *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* This file contains the definitions for the windows-specific high
+ * resolution timing functions
+ */
+
+#include <windows.h>
+#include <stdint.h>
+
+#include "timer.h"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+uint64_t osal_monotonic_ns(void)
+{
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000
+         + (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000 / (uint64_t)frequency.QuadPart;
+}
+
+void osal_sleep_until_ns(uint64_t deadline_ns)
+{
+    /* high resolution waitable timers are only available since Windows 10 1803 */
+    static HANDLE timer = NULL;
+    static int timer_checked = 0;
+    uint64_t now = osal_monotonic_ns();
+    LARGE_INTEGER due;
+
+    if (deadline_ns <= now)
+        return;
+
+    if (!timer_checked) {
+        timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        timer_checked = 1;
+    }
+
+    if (timer != NULL) {
+        /* negative values are relative, in 100ns units */
+        due.QuadPart = -(LONGLONG)((deadline_ns - now) / 100);
+        if (SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE)) {
+            WaitForSingleObject(timer, INFINITE);
+            return;
+        }
+    }
+
+    Sleep((DWORD)((deadline_ns - now) / 1000000));
+}
@@ -24,10 +24,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#define M64P_CORE_PROTOTYPES 1
 #include "api/callbacks.h"
 #include "api/m64p_common.h"
+#include "api/m64p_config.h"
 #include "api/m64p_plugin.h"
 #include "api/m64p_types.h"
+#include "backends/plugins_compat/plugins_compat.h"
 #include "device/memory/memory.h"
 #include "device/rcp/ai/ai_controller.h"
 #include "device/rcp/mi/mi_controller.h"
@@ -355,6 +358,20 @@ static m64p_error plugin_start_audio(void)
     audio_info.AI_BITRATE_REG = &(g_dev.ai.regs[AI_BITRATE_REG]);
     audio_info.CheckInterrupts = EmptyFunc;
 
+    /* when fed from the audio ring, the plugin only sees the ring storage
+     * and a private copy of the AI registers */
+    g_audio_plugin_ring_enabled = ConfigGetParamBool(g_CoreConfig, "AudioRingBuffer");
+    if (g_audio_plugin_ring_enabled)
+    {
+        memset(g_audio_plugin_ring_regs, 0, AI_REGS_COUNT * sizeof(g_audio_plugin_ring_regs[0]));
+        audio_info.RDRAM = g_audio_plugin_ring_buffer;
+        audio_info.AI_DRAM_ADDR_REG = &g_audio_plugin_ring_regs[AI_DRAM_ADDR_REG];
+        audio_info.AI_LEN_REG = &g_audio_plugin_ring_regs[AI_LEN_REG];
+        audio_info.AI_CONTROL_REG = &g_audio_plugin_ring_regs[AI_CONTROL_REG];
+        audio_info.AI_DACRATE_REG = &g_audio_plugin_ring_regs[AI_DACRATE_REG];
+        audio_info.AI_BITRATE_REG = &g_audio_plugin_ring_regs[AI_BITRATE_REG];
+    }
+
     /* call the audio plugin */
     if (!audio.initiateAudio(audio_info))
         return M64ERR_PLUGIN_FAIL;
@@ -495,7 +512,7 @@ static m64p_error plugin_start_rsp(void)
     rsp_info.RDRAM = (unsigned char *)mem_base_u32(g_mem_base, MM_RDRAM_DRAM);
     rsp_info.DMEM = (unsigned char *)mem_base_u32(g_mem_base, MM_RSP_MEM);
     rsp_info.IMEM = (unsigned char *)mem_base_u32(g_mem_base, MM_RSP_MEM + 0x1000);
-    rsp_info.MI_INTR_REG = &g_dev.mi.regs[MI_INTR_REG];
+    rsp_info.MI_INTR_REG = &g_dev.sp.mi_intr_reg;
     rsp_info.SP_MEM_ADDR_REG = &g_dev.sp.regs[SP_MEM_ADDR_REG];
     rsp_info.SP_DRAM_ADDR_REG = &g_dev.sp.regs[SP_DRAM_ADDR_REG];
     rsp_info.SP_RD_LEN_REG = &g_dev.sp.regs[SP_RD_LEN_REG];
@@ -570,6 +587,18 @@ m64p_error plugin_start(m64p_plugin_type type)
     return M64ERR_INTERNAL;
 }
 
+int plugin_is_attached(m64p_plugin_type type)
+{
+    switch (type)
+    {
+        case M64PLUGIN_GFX:   return l_GfxAttached;
+        case M64PLUGIN_AUDIO: return l_AudioAttached;
+        case M64PLUGIN_INPUT: return l_InputAttached;
+        case M64PLUGIN_RSP:   return l_RspAttached;
+        default:              return 0;
+    }
+}
+
 m64p_error plugin_check(void)
 {
     if (!l_GfxAttached)
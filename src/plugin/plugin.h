@@ -30,6 +30,8 @@
 extern m64p_error plugin_connect(m64p_plugin_type, m64p_dynlib_handle plugin_handle);
 extern m64p_error plugin_start(m64p_plugin_type);
 extern m64p_error plugin_check(void);
+/* returns 0 when the dummy plugin is used */
+extern int plugin_is_attached(m64p_plugin_type type);
 
 enum { NUM_CONTROLLER = 4 };
 extern CONTROL Controls[NUM_CONTROLLER];
@@ -0,0 +1,331 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - headless_runner.c                                       *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Minimal front-end which runs a ROM for a fixed number of VIs, without video,
+ * audio or input (the core falls back to its dummy plugins), as fast as
+ * possible, and prints timing statistics as JSON on stdout.
+ *
+ * Build with "make headless" in projects/unix, then e.g.
+ *   ./mupen64plus-headless --emumode 2 --frames 1200 --rsp ./mupen64plus-rsp-hle.so rom.z64
+ *
+ * With --movie, the inputs of a movie recorded by the core are replayed and
+ * the run lasts as long as the movie, so that several builds or emulators can
+ * be compared on exactly the same workload. With --sections, the timing
+ * counters of the core are enabled and reported per subsystem, with
+ * --trace the run is recorded as a Chrome trace-event timeline, with
+ * --profile the hottest r4300 code is sampled into a text report (Linux),
+ * with --count the instruction counters of a DBG_COUNT=1 core are
+ * exported as JSON or CSV (by file extension), and with --memtrace the
+ * memory accesses are recorded for tools/memtrace_summary.c.
+ */
+
+#include <dlfcn.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#define M64P_CORE_PROTOTYPES 1
+#include "api/m64p_types.h"
+#include "api/m64p_common.h"
+#include "api/m64p_config.h"
+#include "api/m64p_frontend.h"
+#include "main/version.h"
+
+static int l_Verbose = 0;
+
+static void runner_debug(void *context, int level, const char *message)
+{
+    if (l_Verbose || level <= M64MSG_WARNING)
+        fprintf(stderr, "%s: %s\n", (const char*) context, message);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+        "Usage: %s [options] <rom>\n"
+        "  --emumode <0|1|2>  R4300 emulator: pure interpreter, cached interpreter or dynarec (default: 2)\n"
+        "  --frames <n>       number of VIs to emulate (default: 600, or the whole movie)\n"
+        "  --movie <file>     replay the inputs of a movie\n"
+        "  --record <file>    record a movie of the run (the controllers are idle)\n"
+        "  --rsp <lib>        RSP plugin to attach (default: none, RSP tasks are dropped)\n"
+        "  --configdir <dir>  configuration directory\n"
+        "  --datadir <dir>    shared data directory (mupen64plus.ini)\n"
+        "  --sections         enable the core timing counters and report every section\n"
+        "  --trace <file>     record a Chrome trace-event timeline of the run\n"
+        "  --profile <file>   sample the r4300 code at 1000 Hz and write the profile\n"
+        "  --count <file>     export the instruction counters (.json or .csv, needs a DBG_COUNT=1 core)\n"
+        "  --memtrace <file>  record the memory accesses of the run (slow)\n"
+        "  --verbose          print all core messages on stderr\n", argv0);
+}
+
+static void* attach_rsp(const char *path)
+{
+    ptr_PluginStartup startup;
+    void *core, *lib;
+
+    lib = dlopen(path, RTLD_NOW);
+    if (lib == NULL)
+    {
+        fprintf(stderr, "Can't load RSP plugin %s: %s\n", path, dlerror());
+        return NULL;
+    }
+
+    /* the core is linked in: plugins look up its Config* functions in the global scope */
+    core = dlopen(NULL, RTLD_NOW);
+    startup = (ptr_PluginStartup) dlsym(lib, "PluginStartup");
+    if (startup == NULL
+     || startup(core, "RSP", runner_debug) != M64ERR_SUCCESS
+     || CoreAttachPlugin(M64PLUGIN_RSP, lib) != M64ERR_SUCCESS)
+    {
+        fprintf(stderr, "Can't attach RSP plugin %s\n", path);
+        dlclose(lib);
+        return NULL;
+    }
+
+    return lib;
+}
+
+static void detach_rsp(void *lib)
+{
+    ptr_PluginShutdown shutdown;
+
+    CoreDetachPlugin(M64PLUGIN_RSP);
+    shutdown = (ptr_PluginShutdown) dlsym(lib, "PluginShutdown");
+    if (shutdown != NULL)
+        shutdown();
+    dlclose(lib);
+}
+
+static void print_json_string(const char *s)
+{
+    putchar('"');
+    for (; *s != '\0'; ++s)
+    {
+        if (*s == '"' || *s == '\\')
+            printf("\\%c", *s);
+        else if ((unsigned char) *s < 0x20)
+            printf("\\u%04x", (unsigned char) *s);
+        else
+            putchar(*s);
+    }
+    putchar('"');
+}
+
+static void print_sections(const m64p_timing_stats *sections, int count)
+{
+    int i;
+
+    printf("  \"sections\": [\n");
+    for (i = 0; i < count && sections[i].name[0] != '\0'; ++i)
+    {
+        printf("%s    { \"name\": \"%s\", \"parent\": %d, \"calls\": %llu, \"inclusive_ns\": %llu, \"exclusive_ns\": %llu }",
+               i > 0 ? ",\n" : "", sections[i].name, (int) sections[i].parent,
+               (unsigned long long) sections[i].calls,
+               (unsigned long long) sections[i].inclusive_ns,
+               (unsigned long long) sections[i].exclusive_ns);
+    }
+    printf("\n  ],\n");
+}
+
+static void print_stats(const char *rom, int frames, const m64p_run_stats *stats, int movie_state,
+                        const m64p_timing_stats *sections, int section_count)
+{
+    static const char* const emumodes[] = { "pure_interpreter", "cached_interpreter", "dynarec" };
+    static const char* const movie_states[] = { "none", "recording", "playing", "recorded", "matched", "desync" };
+    struct rusage usage;
+    double seconds = (double) stats->run_ns / 1e9;
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("{\n  \"rom\": ");
+    print_json_string(rom);
+    printf(",\n  \"emumode\": \"%s\",\n", emumodes[stats->emumode < 3 ? stats->emumode : 2]);
+    printf("  \"frames_requested\": %d,\n", frames);
+    printf("  \"movie\": \"%s\",\n", movie_states[movie_state >= 0 && movie_state <= M64MOVIE_DESYNC ? movie_state : 0]);
+    printf("  \"vis\": %llu,\n", (unsigned long long) stats->vis);
+    printf("  \"wall_ns\": %llu,\n", (unsigned long long) stats->run_ns);
+    printf("  \"vis_per_sec\": %.2f,\n", seconds > 0.0 ? (double) stats->vis / seconds : 0.0);
+    printf("  \"compiled_blocks\": %llu,\n", (unsigned long long) stats->compiled_blocks);
+    if (stats->timed)
+    {
+        printf("  \"sections_ns\": { \"gfx\": %llu, \"audio\": %llu, \"compiler\": %llu, \"idle\": %llu },\n",
+               (unsigned long long) stats->gfx_ns, (unsigned long long) stats->audio_ns,
+               (unsigned long long) stats->compiler_ns, (unsigned long long) stats->idle_ns);
+    }
+    else
+    {
+        printf("  \"sections_ns\": null,\n");
+    }
+    if (sections != NULL)
+        print_sections(sections, section_count);
+    /* ru_maxrss is in kilobytes on Linux and the BSDs, in bytes on macOS */
+#if defined(__APPLE__)
+    printf("  \"peak_rss_kb\": %ld\n}\n", (long) (usage.ru_maxrss / 1024));
+#else
+    printf("  \"peak_rss_kb\": %ld\n}\n", (long) usage.ru_maxrss);
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    const char *configdir = NULL, *datadir = NULL, *rsp = NULL, *rom = NULL;
+    const char *movie = NULL, *record = NULL, *trace = NULL, *profile = NULL;
+    const char *count = NULL, *memtrace = NULL;
+    int emumode = 2, frames = -1, i;
+    void *rsp_lib = NULL;
+    m64p_handle core_section;
+    m64p_run_stats stats;
+    m64p_timing_stats sections[64];
+    int timing = 0;
+    m64p_error rval;
+    int value, rate;
+
+    for (i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--emumode") == 0 && i + 1 < argc)
+            emumode = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--movie") == 0 && i + 1 < argc)
+            movie = argv[++i];
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            record = argv[++i];
+        else if (strcmp(argv[i], "--rsp") == 0 && i + 1 < argc)
+            rsp = argv[++i];
+        else if (strcmp(argv[i], "--configdir") == 0 && i + 1 < argc)
+            configdir = argv[++i];
+        else if (strcmp(argv[i], "--datadir") == 0 && i + 1 < argc)
+            datadir = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            trace = argv[++i];
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+            profile = argv[++i];
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            count = argv[++i];
+        else if (strcmp(argv[i], "--memtrace") == 0 && i + 1 < argc)
+            memtrace = argv[++i];
+        else if (strcmp(argv[i], "--sections") == 0)
+            timing = 1;
+        else if (strcmp(argv[i], "--verbose") == 0)
+            l_Verbose = 1;
+        else if (argv[i][0] != '-' && rom == NULL)
+            rom = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (frames < 0)
+        frames = (movie != NULL) ? 0 : 600;
+
+    if (rom == NULL || emumode < 0 || emumode > 2 || (frames == 0 && movie == NULL) || (movie != NULL && record != NULL))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (CoreStartup(FRONTEND_API_VERSION, configdir, datadir, "Core", runner_debug, NULL, NULL) != M64ERR_SUCCESS)
+    {
+        fprintf(stderr, "Core startup failed\n");
+        return 1;
+    }
+
+    /* not saved to the configuration file */
+    value = 0;
+    rate = (profile != NULL) ? 1000 : 0;
+    if (ConfigOpenSection("Core", &core_section) != M64ERR_SUCCESS
+     || ConfigSetParameter(core_section, "R4300Emulator", M64TYPE_INT, &emumode) != M64ERR_SUCCESS
+     || ConfigSetParameter(core_section, "OnScreenDisplay", M64TYPE_BOOL, &value) != M64ERR_SUCCESS
+     || ConfigSetParameter(core_section, "TraceFile", M64TYPE_STRING, (trace != NULL) ? trace : "") != M64ERR_SUCCESS
+     || ConfigSetParameter(core_section, "ProfilerRate", M64TYPE_INT, &rate) != M64ERR_SUCCESS
+     || ConfigSetParameter(core_section, "ProfilerFile", M64TYPE_STRING, (profile != NULL) ? profile : "") != M64ERR_SUCCESS
+     || ConfigSetParameter(core_section, "MemTraceFile", M64TYPE_STRING, (memtrace != NULL) ? memtrace : "") != M64ERR_SUCCESS)
+    {
+        fprintf(stderr, "Can't configure the core\n");
+        CoreShutdown();
+        return 1;
+    }
+
+    if (rsp != NULL && (rsp_lib = attach_rsp(rsp)) == NULL)
+    {
+        CoreShutdown();
+        return 1;
+    }
+
+    rval = CoreDoCommand(M64CMD_ROM_OPEN_FILE, 0, (void*) rom);
+    if (rval != M64ERR_SUCCESS)
+    {
+        fprintf(stderr, "Can't open ROM %s (error %d)\n", rom, (int) rval);
+        goto shutdown;
+    }
+
+    if (movie != NULL)
+        rval = CoreDoCommand(M64CMD_MOVIE_PLAY, 0, (void*) movie);
+    else if (record != NULL)
+        rval = CoreDoCommand(M64CMD_MOVIE_RECORD, 0, (void*) record);
+    if (rval != M64ERR_SUCCESS)
+    {
+        fprintf(stderr, "Can't open movie %s (error %d)\n", (movie != NULL) ? movie : record, (int) rval);
+        CoreDoCommand(M64CMD_ROM_CLOSE, 0, NULL);
+        goto shutdown;
+    }
+
+    CoreDoCommand(M64CMD_CORE_STATE_SET, M64CORE_SPEED_LIMITER, &value);
+    value = frames;
+    CoreDoCommand(M64CMD_CORE_STATE_SET, M64CORE_VI_LIMIT, &value);
+    CoreDoCommand(M64CMD_CORE_STATE_SET, M64CORE_TIMING_COUNTERS, &timing);
+
+    rval = CoreDoCommand(M64CMD_EXECUTE, 0, NULL);
+    if (rval == M64ERR_SUCCESS)
+        rval = CoreDoCommand(M64CMD_GET_RUN_STATS, sizeof(stats), &stats);
+    if (rval == M64ERR_SUCCESS && timing)
+        rval = CoreDoCommand(M64CMD_GET_TIMING_STATS, sizeof(sections), sections);
+    if (rval == M64ERR_SUCCESS)
+    {
+        CoreDoCommand(M64CMD_CORE_STATE_QUERY, M64CORE_MOVIE_STATE, &value);
+        print_stats(rom, frames, &stats, value, timing ? sections : NULL, (int) (sizeof(sections) / sizeof(sections[0])));
+        /* a desynced replay did not run the expected workload */
+        if (value == M64MOVIE_DESYNC)
+            rval = M64ERR_SYSTEM_FAIL;
+    }
+    if (rval == M64ERR_SUCCESS && count != NULL)
+    {
+        size_t length = strlen(count);
+        int format = (length >= 4 && strcmp(count + length - 4, ".csv") == 0) ? M64EXPORT_CSV : M64EXPORT_JSON;
+        rval = CoreDoCommand(M64CMD_EXPORT_INSTR_COUNTERS, format, (void*) count);
+        if (rval != M64ERR_SUCCESS)
+            fprintf(stderr, "Can't export the instruction counters (error %d)\n", (int) rval);
+    }
+    else
+        fprintf(stderr, "Emulation failed (error %d)\n", (int) rval);
+
+    CoreDoCommand(M64CMD_ROM_CLOSE, 0, NULL);
+
+shutdown:
+    if (rsp_lib != NULL)
+        detach_rsp(rsp_lib);
+    CoreShutdown();
+    return rval == M64ERR_SUCCESS ? 0 : 1;
+}
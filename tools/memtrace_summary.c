@@ -0,0 +1,387 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - memtrace_summary.c                                      *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Summarizes a memory trace recorded by the core (MemTraceFile setting):
+ * share of the accesses per region, hottest 4KB pages of the physical
+ * address space, accesses per MMIO register with the instructions issuing
+ * them, and DMA transfers per engine.
+ *
+ * Build from the root of the source tree with
+ *   gcc -O2 -Isrc -o memtrace_summary tools/memtrace_summary.c -lz
+ * and run on the host which recorded the trace (records are in host byte order)
+ *   ./memtrace_summary [-n <count>] memtrace.gz
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "main/memtrace.h"
+
+enum { PAGE_SHIFT = 12, PAGES_COUNT = 0x20000000 >> PAGE_SHIFT };
+/* open addressing table of the MMIO registers, keyed by physical address */
+enum { REGISTERS_CAPACITY = 1 << 16 };
+enum { DEFAULT_TOP = 20 };
+
+static const char* const l_region_names[MEMTRACE_REGIONS_COUNT] =
+{
+    "unmapped", "RDRAM", "RDRAM regs", "RSP mem", "RSP regs", "DPC regs",
+    "DPS regs", "MI regs", "VI regs", "AI regs", "PI regs", "RI regs",
+    "SI regs", "64DD", "cart save", "cart ROM", "PIF"
+};
+
+static const char* const l_dma_names[MEMTRACE_DMA_COUNT] = { "PI", "SI", "SP", "AI" };
+
+struct counts
+{
+    uint64_t reads;
+    uint64_t writes;
+};
+
+struct page
+{
+    struct counts counts;
+    uint8_t region;
+};
+
+struct mmio_register
+{
+    uint32_t address;   /* 0 for unused entries, register addresses are never 0 */
+    uint32_t last_pc;
+    struct counts counts;
+};
+
+struct summary
+{
+    uint64_t records;
+    uint32_t threads;
+    struct counts regions[MEMTRACE_REGIONS_COUNT];
+    uint64_t region_bytes[MEMTRACE_REGIONS_COUNT];
+    struct page* pages;
+    struct mmio_register* registers;
+    size_t registers_used;
+    uint64_t dma_count[MEMTRACE_DMA_COUNT];
+    uint64_t dma_bytes[MEMTRACE_DMA_COUNT];
+};
+
+static int is_mmio(uint8_t region)
+{
+    return region == MEMTRACE_UNMAPPED
+        || (region >= MEMTRACE_RDRAM_REGS && region != MEMTRACE_RSP_MEM
+            && region != MEMTRACE_CART_ROM);
+}
+
+static struct mmio_register* get_register(struct summary* summary, uint32_t address)
+{
+    uint32_t key = address | 1; /* keeps address 0 apart from unused entries */
+    size_t i = (size_t)(key * UINT32_C(2654435761)) & (REGISTERS_CAPACITY - 1);
+
+    while (summary->registers[i].address != 0 && summary->registers[i].address != key)
+        i = (i + 1) & (REGISTERS_CAPACITY - 1);
+
+    if (summary->registers[i].address == 0) {
+        /* keep room to terminate the probing */
+        if (summary->registers_used + 1 >= REGISTERS_CAPACITY)
+            return NULL;
+        summary->registers[i].address = key;
+        ++summary->registers_used;
+    }
+
+    return &summary->registers[i];
+}
+
+static void add_record(struct summary* summary, const struct memtrace_record* record)
+{
+    uint8_t region = (record->region < MEMTRACE_REGIONS_COUNT) ? record->region : MEMTRACE_UNMAPPED;
+
+    ++summary->records;
+
+    if (record->kind == MEMTRACE_DMA) {
+        if (record->size < MEMTRACE_DMA_COUNT) {
+            ++summary->dma_count[record->size];
+            summary->dma_bytes[record->size] += record->value;
+        }
+        return;
+    }
+
+    struct page* page = &summary->pages[(record->paddr & 0x1fffffff) >> PAGE_SHIFT];
+    struct mmio_register* reg = is_mmio(region) ? get_register(summary, record->paddr & ~UINT32_C(3)) : NULL;
+
+    summary->region_bytes[region] += record->size;
+    page->region = region;
+
+    if (record->kind == MEMTRACE_WRITE) {
+        ++summary->regions[region].writes;
+        ++page->counts.writes;
+        if (reg != NULL)
+            ++reg->counts.writes;
+    }
+    else {
+        ++summary->regions[region].reads;
+        ++page->counts.reads;
+        if (reg != NULL)
+            ++reg->counts.reads;
+    }
+
+    if (reg != NULL)
+        reg->last_pc = record->pc;
+}
+
+static int read_exact(gzFile f, void* data, size_t size)
+{
+    return gzread(f, data, (unsigned int)size) == (int)size;
+}
+
+static int read_trace(const char* path, struct summary* summary)
+{
+    struct memtrace_header header;
+    struct memtrace_chunk chunk;
+    struct memtrace_record records[4096];
+    gzFile f = gzopen(path, "rb");
+
+    if (f == NULL) {
+        fprintf(stderr, "Couldn't open %s\n", path);
+        return -1;
+    }
+
+    if (!read_exact(f, &header, sizeof(header))
+     || memcmp(header.magic, MEMTRACE_MAGIC, sizeof(MEMTRACE_MAGIC)) != 0) {
+        fprintf(stderr, "%s is not a memory trace\n", path);
+        gzclose(f);
+        return -1;
+    }
+
+    if (header.version != MEMTRACE_VERSION || header.record_size != sizeof(struct memtrace_record)) {
+        fprintf(stderr, "Unsupported memory trace version %u (record size %u), or recorded with a different byte order\n",
+                header.version, header.record_size);
+        gzclose(f);
+        return -1;
+    }
+
+    while (read_exact(f, &chunk, sizeof(chunk))) {
+        uint32_t left = chunk.count;
+
+        if (chunk.thread + 1 > summary->threads)
+            summary->threads = chunk.thread + 1;
+
+        while (left > 0) {
+            uint32_t count = (left < 4096) ? left : 4096;
+            uint32_t i;
+
+            if (!read_exact(f, records, count * sizeof(records[0]))) {
+                fprintf(stderr, "Warning: %s is truncated\n", path);
+                gzclose(f);
+                return 0;
+            }
+
+            for (i = 0; i < count; ++i)
+                add_record(summary, &records[i]);
+            left -= count;
+        }
+    }
+
+    gzclose(f);
+    return 0;
+}
+
+static double percent(uint64_t part, uint64_t total)
+{
+    return (total != 0) ? 100.0 * (double)part / (double)total : 0.0;
+}
+
+static int compare_pages(const void* a, const void* b)
+{
+    const struct page* pa = *(const struct page* const*)a;
+    const struct page* pb = *(const struct page* const*)b;
+    uint64_t ta = pa->counts.reads + pa->counts.writes;
+    uint64_t tb = pb->counts.reads + pb->counts.writes;
+
+    return (ta < tb) - (ta > tb);
+}
+
+static int compare_registers(const void* a, const void* b)
+{
+    const struct mmio_register* ra = (const struct mmio_register*)a;
+    const struct mmio_register* rb = (const struct mmio_register*)b;
+    uint64_t ta = ra->counts.reads + ra->counts.writes;
+    uint64_t tb = rb->counts.reads + rb->counts.writes;
+
+    return (ta < tb) - (ta > tb);
+}
+
+static void print_regions(const struct summary* summary, uint64_t accesses)
+{
+    size_t i;
+
+    printf("\nAccesses per region:\n");
+    printf("  %-12s %14s %14s %14s %8s\n", "region", "reads", "writes", "bytes", "share");
+    for (i = 0; i < MEMTRACE_REGIONS_COUNT; ++i) {
+        uint64_t count = summary->regions[i].reads + summary->regions[i].writes;
+        if (count == 0)
+            continue;
+        printf("  %-12s %14llu %14llu %14llu %7.2f%%\n", l_region_names[i],
+               (unsigned long long)summary->regions[i].reads,
+               (unsigned long long)summary->regions[i].writes,
+               (unsigned long long)summary->region_bytes[i],
+               percent(count, accesses));
+    }
+}
+
+static void print_pages(const struct summary* summary, uint64_t accesses, size_t top)
+{
+    const struct page** pages = malloc(PAGES_COUNT * sizeof(*pages));
+    size_t count = 0, i;
+
+    if (pages == NULL)
+        return;
+
+    for (i = 0; i < PAGES_COUNT; ++i) {
+        if (summary->pages[i].counts.reads + summary->pages[i].counts.writes != 0)
+            pages[count++] = &summary->pages[i];
+    }
+    qsort(pages, count, sizeof(*pages), compare_pages);
+
+    printf("\nHottest 4KB pages (%zu pages touched):\n", count);
+    printf("  %-10s %-12s %14s %14s %8s\n", "page", "region", "reads", "writes", "share");
+    for (i = 0; i < count && i < top; ++i) {
+        uint32_t address = (uint32_t)(pages[i] - summary->pages) << PAGE_SHIFT;
+        printf("  0x%08x %-12s %14llu %14llu %7.2f%%\n", address, l_region_names[pages[i]->region],
+               (unsigned long long)pages[i]->counts.reads, (unsigned long long)pages[i]->counts.writes,
+               percent(pages[i]->counts.reads + pages[i]->counts.writes, accesses));
+    }
+
+    free(pages);
+}
+
+static void print_registers(struct summary* summary, size_t top)
+{
+    struct mmio_register* registers = summary->registers;
+    struct counts devices[MEMTRACE_REGIONS_COUNT];
+    uint64_t total = 0;
+    size_t count = 0, i;
+
+    /* compact the used entries at the start of the table */
+    for (i = 0; i < REGISTERS_CAPACITY; ++i) {
+        if (registers[i].address != 0)
+            registers[count++] = registers[i];
+    }
+    qsort(registers, count, sizeof(*registers), compare_registers);
+
+    memset(devices, 0, sizeof(devices));
+    for (i = 0; i < MEMTRACE_REGIONS_COUNT; ++i) {
+        if (!is_mmio((uint8_t)i))
+            continue;
+        devices[i] = summary->regions[i];
+        total += devices[i].reads + devices[i].writes;
+    }
+
+    printf("\nMMIO accesses per device:\n");
+    printf("  %-12s %14s %14s %8s\n", "device", "reads", "writes", "share");
+    for (i = 0; i < MEMTRACE_REGIONS_COUNT; ++i) {
+        if (devices[i].reads + devices[i].writes == 0)
+            continue;
+        printf("  %-12s %14llu %14llu %7.2f%%\n", l_region_names[i],
+               (unsigned long long)devices[i].reads, (unsigned long long)devices[i].writes,
+               percent(devices[i].reads + devices[i].writes, total));
+    }
+
+    printf("\nHottest MMIO registers (%zu registers touched):\n", count);
+    printf("  %-10s %14s %14s %8s  %s\n", "address", "reads", "writes", "share", "last pc");
+    for (i = 0; i < count && i < top; ++i) {
+        printf("  0x%08x %14llu %14llu %7.2f%%  0x%08x\n", registers[i].address & ~UINT32_C(1),
+               (unsigned long long)registers[i].counts.reads, (unsigned long long)registers[i].counts.writes,
+               percent(registers[i].counts.reads + registers[i].counts.writes, total), registers[i].last_pc);
+    }
+}
+
+static void print_dma(const struct summary* summary)
+{
+    size_t i;
+
+    printf("\nDMA transfers:\n");
+    printf("  %-6s %14s %14s\n", "engine", "transfers", "bytes");
+    for (i = 0; i < MEMTRACE_DMA_COUNT; ++i) {
+        printf("  %-6s %14llu %14llu\n", l_dma_names[i],
+               (unsigned long long)summary->dma_count[i], (unsigned long long)summary->dma_bytes[i]);
+    }
+}
+
+static void print_usage(const char* progname)
+{
+    printf("Usage: %s [-n <count>] <memtrace file>\n\n", progname);
+    printf("    -n <count>    number of pages and registers listed (default %d)\n", DEFAULT_TOP);
+}
+
+int main(int argc, char* argv[])
+{
+    struct summary summary;
+    const char* path = NULL;
+    size_t top = DEFAULT_TOP;
+    uint64_t accesses = 0;
+    size_t i;
+    int arg;
+
+    for (arg = 1; arg < argc; ++arg) {
+        if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            top = (size_t)strtoul(argv[++arg], NULL, 10);
+        }
+        else if (argv[arg][0] == '-' || path != NULL) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        else {
+            path = argv[arg];
+        }
+    }
+
+    if (path == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    memset(&summary, 0, sizeof(summary));
+    summary.pages = calloc(PAGES_COUNT, sizeof(*summary.pages));
+    summary.registers = calloc(REGISTERS_CAPACITY, sizeof(*summary.registers));
+    if (summary.pages == NULL || summary.registers == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    if (read_trace(path, &summary) != 0)
+        return 1;
+
+    for (i = 0; i < MEMTRACE_REGIONS_COUNT; ++i)
+        accesses += summary.regions[i].reads + summary.regions[i].writes;
+
+    printf("%s: %llu records from %u thread(s), %llu loads and stores\n", path,
+           (unsigned long long)summary.records, summary.threads, (unsigned long long)accesses);
+
+    print_regions(&summary, accesses);
+    print_pages(&summary, accesses, top);
+    print_registers(&summary, top);
+    print_dma(&summary);
+
+    free(summary.registers);
+    free(summary.pages);
+    return 0;
+}